@@ -0,0 +1,715 @@
+#include "AutoFit.h"
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <type_traits>
+
+using namespace EqConstants;
+
+namespace
+{
+    constexpr double twoPi = juce::MathConstants<double>::twoPi;
+    constexpr double dbPerLogPower = 10.0 / 2.302585092994046; // 10 / ln(10), power ratio (natural log) -> dB
+    constexpr double gainRegularisation = 1.0e-4; // Pulls unused bands towards 0 dB
+    constexpr double filterMinBenefit = 0.01; // dB^2 of mean squared error an HPF/LPF has to save to be kept
+
+    // Evaluation grid shared (read-only) by every optimiser thread
+    struct FitGrid
+    {
+        std::vector<double> phi, phiE, tanHalfW; // Per point, precomputed once
+        std::vector<double> targetDb;
+        std::vector<double> weight; // Sums to 1, so the cost is a mean squared error in dB^2
+        std::vector<double> freqHz;
+        double sampleRate = 48000.0;
+
+        size_t size() const { return targetDb.size(); }
+    };
+
+    // Where each fitted value lives in the parameter vector
+    struct ParamLayout
+    {
+        int hpf = -1; // ln(freq)
+        int lpf = -1; // ln(freq)
+        int bandBase = 0; // ln(freq), gainDb, ln(Q) per band
+        int numBands = 0;
+        int hpfOrder = 2, hpfStages = 1;
+        int lpfOrder = 2, lpfStages = 1;
+        int size = 0;
+
+        std::vector<double> lower, upper;
+    };
+
+    double interpolateTarget(const EqAutoFit::Target& t, double hz)
+    {
+        if (hz <= t.freqHz.front()) return t.db.front();
+        if (hz >= t.freqHz.back()) return t.db.back();
+
+        const auto it = std::upper_bound(t.freqHz.begin(), t.freqHz.end(), hz);
+        const size_t hi = (size_t)std::distance(t.freqHz.begin(), it);
+        const size_t lo = hi - 1;
+        const double x = (std::log(hz) - std::log(t.freqHz[lo])) / (std::log(t.freqHz[hi]) - std::log(t.freqHz[lo]));
+        return t.db[lo] + x * (t.db[hi] - t.db[lo]);
+    }
+
+    FitGrid buildGrid(const EqAutoFit::Target& target, const EqAutoFit::Options& opt)
+    {
+        FitGrid g;
+        g.sampleRate = opt.sampleRate;
+
+        const double fLo = std::max(target.freqHz.front(), (double)minEqFreq);
+        const double fHi = std::min({ target.freqHz.back(), (double)maxEqFreq, 0.49 * opt.sampleRate });
+        const int n = juce::jmax(16, opt.gridPoints);
+
+        for (int i = 0; i < n; ++i)
+        {
+            const double hz = fLo * std::pow(fHi / fLo, (double)i / (double)(n - 1));
+            const double w = twoPi * hz / opt.sampleRate;
+            g.freqHz.push_back(hz);
+            const double sinHalfW = std::sin(0.5 * w);
+            g.phi.push_back(sinHalfW * sinHalfW);
+            g.phiE.push_back(16.0 * g.phi.back() * (1.0 - g.phi.back()));
+            g.tanHalfW.push_back(std::tan(0.5 * w));
+            g.targetDb.push_back(interpolateTarget(target, hz));
+            g.weight.push_back(1.0 / (double)n);
+        }
+
+        return g;
+    }
+
+    ParamLayout buildLayout(const EqAutoFit::Options& opt)
+    {
+        ParamLayout l;
+        int next = 0;
+        const double fMax = std::min((double)maxEqFreq, 0.49 * opt.sampleRate);
+
+        auto addRange = [&l](double lo, double hi) { l.lower.push_back(lo); l.upper.push_back(hi); };
+
+        if (opt.fitHpf)
+        {
+            l.hpf = next++;
+            l.hpfOrder = opt.hpfSlopeIndex == 0 ? 1 : 2;
+            l.hpfStages = JuceEQAudioProcessor::numStagesForSlopeIndex(opt.hpfSlopeIndex);
+            addRange(std::log((double)minEqFreq), std::log(fMax));
+        }
+
+        if (opt.fitLpf)
+        {
+            l.lpf = next++;
+            l.lpfOrder = opt.lpfSlopeIndex == 0 ? 1 : 2;
+            l.lpfStages = JuceEQAudioProcessor::numStagesForSlopeIndex(opt.lpfSlopeIndex);
+            addRange(std::log((double)minEqFreq), std::log(fMax));
+        }
+
+        l.bandBase = next;
+        l.numBands = juce::jlimit(0, maxEqBands, opt.numBands);
+        for (int b = 0; b < l.numBands; ++b)
+        {
+            addRange(std::log((double)minEqFreq), std::log(fMax));
+            addRange((double)minEqGainDb, (double)maxEqGainDb);
+            addRange(std::log((double)eqMinQ), std::log((double)eqMaxQ));
+        }
+
+        l.size = (int)l.lower.size();
+        return l;
+    }
+
+    /* Evaluates the model response in dB at every grid point and, when jac is given,
+     * its derivative with respect to every parameter (stored parameter-major, jac[k * n + i]).
+     *
+     * Same maths as JuceEQAudioProcessor::getFrequencyResponse, reorganised so each inner loop
+     * runs over grid points with no data-dependent branches (auto-vectorises). Each section has a
+     * value-only loop and a value-and-Jacobian one, picked once per section rather than per point:
+     *  - Peaks use the unnormalised RBJ coefficients, |B|^2 / |A|^2, written in terms of phi = sin^2(w/2)
+     *    so low frequencies don't lose precision to cancellation:
+     *    |B|^2 = (S - 4 phi)^2 + 16 (alpha A)^2 phi (1 - phi), with S = 4 sin^2(w0/2), and 1/A for |A|^2
+     *  - HPF/LPF use the bilinear Butterworth closed form 1 / (1 + (Wc/W)^m) with W = tan(w/2)
+     */
+    void evaluateModel(const FitGrid& g, const ParamLayout& l, const std::vector<double>& p,
+        std::vector<double>& power, std::vector<double>& modelDb, std::vector<double>* jac)
+    {
+        const size_t n = g.size();
+        power.assign(n, 1.0);
+        if (jac != nullptr)
+            jac->assign((size_t)l.size * n, 0.0);
+
+        auto jacRow = [&](int k) { return jac->data() + (size_t)k * n; };
+
+        // Shelving section shared by HPF (highPass = true) and LPF
+        auto addPass = [&](int k, int order, int stages, bool highPass)
+            {
+                const double fc = std::exp(p[(size_t)k]);
+                const double x = juce::MathConstants<double>::pi * fc / g.sampleRate;
+                const double wc = std::tan(x);
+                const double dLogWc = x * (1.0 + wc * wc) / wc; // d ln(Wc) / d ln(fc)
+                const int m = 2 * order;
+                const double sign = highPass ? -1.0 : 1.0;
+                const double scale = sign * dbPerLogPower * (double)(stages * m) * dLogWc;
+                double* d = jac != nullptr ? jacRow(k) : nullptr;
+
+                auto run = [&](auto withJacobian)
+                    {
+                        for (size_t i = 0; i < n; ++i)
+                        {
+                            const double r = highPass ? wc / g.tanHalfW[i] : g.tanHalfW[i] / wc;
+                            const double r2 = r * r;
+                            const double rm = order == 1 ? r2 : r2 * r2;
+                            const double stage = 1.0 / (1.0 + rm);
+
+                            double h = stage;
+                            for (int s = 1; s < stages; ++s)
+                                h *= stage;
+
+                            power[i] *= h;
+                            if constexpr (decltype(withJacobian)::value)
+                                d[i] = scale * rm * stage;
+                        }
+                    };
+
+                if (d != nullptr)
+                    run(std::true_type{});
+                else
+                    run(std::false_type{});
+            };
+
+        if (l.hpf >= 0) addPass(l.hpf, l.hpfOrder, l.hpfStages, true);
+        if (l.lpf >= 0) addPass(l.lpf, l.lpfOrder, l.lpfStages, false);
+
+        for (int b = 0; b < l.numBands; ++b)
+        {
+            const int k = l.bandBase + b * 3;
+            const double w0 = twoPi * std::exp(p[(size_t)k]) / g.sampleRate;
+            const double gainDb = p[(size_t)k + 1];
+            const double q = std::exp(p[(size_t)k + 2]);
+
+            const double s = std::sin(w0), c = std::cos(w0);
+            const double alpha = s / (2.0 * q);
+            const double A = std::pow(10.0, gainDb / 40.0);
+            const double dA = A * 2.302585092994046 / 40.0;
+            const double sinHalf = std::sin(0.5 * w0);
+            const double S = 4.0 * sinHalf * sinHalf; // b0 + b1 + b2 == a0 + a1 + a2
+            const double kb = alpha * alpha * A * A;
+            const double ka = alpha * alpha / (A * A);
+
+            // Derivatives of S, kb and ka, per parameter (ln f, gain dB, ln Q)
+            const double dS = 2.0 * s * w0;
+            const double dAlphaF = c * w0 / (2.0 * q);
+            const double dKb[3] = { 2.0 * alpha * dAlphaF * A * A, 2.0 * alpha * alpha * A * dA, -2.0 * kb };
+            const double dKa[3] = { 2.0 * alpha * dAlphaF / (A * A), -2.0 * alpha * alpha * dA / (A * A * A), -2.0 * ka };
+
+            double* dF = jac != nullptr ? jacRow(k) : nullptr;
+            double* dG = jac != nullptr ? jacRow(k + 1) : nullptr;
+            double* dQ = jac != nullptr ? jacRow(k + 2) : nullptr;
+
+            auto run = [&](auto withJacobian)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        const double D = S - 4.0 * g.phi[i];
+                        const double E = g.phiE[i];
+                        const double pb = D * D + kb * E;
+                        const double pa = D * D + ka * E;
+                        const double invPa = 1.0 / pa;
+                        power[i] *= pb * invPa;
+
+                        if constexpr (decltype(withJacobian)::value)
+                        {
+                            const double invPb = 1.0 / pb;
+                            const double dD2 = 2.0 * D * dS;
+                            dF[i] = dbPerLogPower * ((dD2 + dKb[0] * E) * invPb - (dD2 + dKa[0] * E) * invPa);
+                            dG[i] = dbPerLogPower * (dKb[1] * E * invPb - dKa[1] * E * invPa);
+                            dQ[i] = dbPerLogPower * (dKb[2] * E * invPb - dKa[2] * E * invPa);
+                        }
+                    }
+                };
+
+            if (dF != nullptr)
+                run(std::true_type{});
+            else
+                run(std::false_type{});
+        }
+
+        modelDb.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            modelDb[i] = dbPerLogPower * std::log(std::max(1.0e-30, power[i]));
+    }
+
+    double costFor(const FitGrid& g, const ParamLayout& l, const std::vector<double>& p, const std::vector<double>& modelDb)
+    {
+        double cost = 0.0;
+        for (size_t i = 0; i < g.size(); ++i)
+        {
+            const double r = modelDb[i] - g.targetDb[i];
+            cost += g.weight[i] * r * r;
+        }
+
+        for (int b = 0; b < l.numBands; ++b)
+        {
+            const double gainDb = p[(size_t)(l.bandBase + b * 3 + 1)];
+            cost += gainRegularisation * gainDb * gainDb;
+        }
+
+        return cost;
+    }
+
+    // Solves (symmetric positive definite) A x = y in place, returns false if A isn't positive definite
+    bool choleskySolve(std::vector<double>& A, std::vector<double>& y, int n)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            double d = A[(size_t)(j * n + j)];
+            for (int k = 0; k < j; ++k)
+                d -= A[(size_t)(j * n + k)] * A[(size_t)(j * n + k)];
+            if (d <= 0.0)
+                return false;
+            d = std::sqrt(d);
+            A[(size_t)(j * n + j)] = d;
+
+            for (int i = j + 1; i < n; ++i)
+            {
+                double v = A[(size_t)(i * n + j)];
+                for (int k = 0; k < j; ++k)
+                    v -= A[(size_t)(i * n + k)] * A[(size_t)(j * n + k)];
+                A[(size_t)(i * n + j)] = v / d;
+            }
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            double v = y[(size_t)i];
+            for (int k = 0; k < i; ++k)
+                v -= A[(size_t)(i * n + k)] * y[(size_t)k];
+            y[(size_t)i] = v / A[(size_t)(i * n + i)];
+        }
+
+        for (int i = n - 1; i >= 0; --i)
+        {
+            double v = y[(size_t)i];
+            for (int k = i + 1; k < n; ++k)
+                v -= A[(size_t)(k * n + i)] * y[(size_t)k];
+            y[(size_t)i] = v / A[(size_t)(i * n + i)];
+        }
+
+        return true;
+    }
+
+    // Starting point for one optimiser run. Start 0 is deterministic, the rest are jittered.
+    std::vector<double> initialGuess(const FitGrid& g, const ParamLayout& l, int startIndex)
+    {
+        juce::Random rng(0x5eed + startIndex);
+        std::vector<double> p((size_t)l.size, 0.0);
+        const size_t n = g.size();
+
+        // Filters start where the target first falls 3 dB below its median level
+        std::vector<double> sorted = g.targetDb;
+        std::nth_element(sorted.begin(), sorted.begin() + (std::ptrdiff_t)(n / 2), sorted.end());
+        const double median = sorted[n / 2];
+
+        if (l.hpf >= 0)
+        {
+            size_t i = 0;
+            while (i + 1 < n && g.targetDb[i] < median - 3.0) ++i;
+            p[(size_t)l.hpf] = std::log(g.freqHz[i]) + (startIndex == 0 ? 0.0 : rng.nextDouble() * 0.5 - 0.25);
+        }
+
+        if (l.lpf >= 0)
+        {
+            size_t i = n - 1;
+            while (i > 0 && g.targetDb[i] < median - 3.0) --i;
+            p[(size_t)l.lpf] = std::log(g.freqHz[i]) + (startIndex == 0 ? 0.0 : rng.nextDouble() * 0.5 - 0.25);
+        }
+
+        // Bands go to the largest remaining residuals, keeping 1/3 octave apart
+        std::vector<double> residual(n);
+        for (size_t i = 0; i < n; ++i)
+            residual[i] = g.targetDb[i] - median;
+
+        std::vector<double> placed;
+        const double minSpacing = std::log(2.0) / 3.0;
+        for (int b = 0; b < l.numBands; ++b)
+        {
+            size_t best = (size_t)rng.nextInt((int)n);
+            if (startIndex == 0 || b % 2 == 0)
+            {
+                double bestAbs = -1.0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const double lf = std::log(g.freqHz[i]);
+                    const bool clear = std::none_of(placed.begin(), placed.end(),
+                        [lf, minSpacing](double o) { return std::abs(o - lf) < minSpacing; });
+                    if (clear && std::abs(residual[i]) > bestAbs)
+                    {
+                        bestAbs = std::abs(residual[i]);
+                        best = i;
+                    }
+                }
+            }
+
+            const double lf = std::log(g.freqHz[best]);
+            placed.push_back(lf);
+
+            const int k = l.bandBase + b * 3;
+            p[(size_t)k] = lf;
+            p[(size_t)k + 1] = juce::jlimit((double)minEqGainDb, (double)maxEqGainDb, residual[best]);
+            p[(size_t)k + 2] = startIndex == 0 ? 0.0 : std::log(0.5 + 3.5 * rng.nextDouble());
+        }
+
+        for (int k = 0; k < l.size; ++k)
+            p[(size_t)k] = juce::jlimit(l.lower[(size_t)k], l.upper[(size_t)k], p[(size_t)k]);
+
+        return p;
+    }
+
+    struct RunResult
+    {
+        std::vector<double> params;
+        double cost = std::numeric_limits<double>::max();
+        int iterations = 0;
+    };
+
+    // Levenberg-Marquardt with box constraints (steps are clamped to the parameter ranges)
+    RunResult runOptimiser(const FitGrid& g, const ParamLayout& l, std::vector<double> p, int maxIterations)
+    {
+        const int m = l.size;
+        const size_t n = g.size();
+
+        std::vector<double> power, model, jac, trialPower, trialModel;
+        std::vector<double> JtJ((size_t)(m * m)), Jtr((size_t)m), A, step, trial((size_t)m);
+
+        evaluateModel(g, l, p, power, model, &jac);
+        double cost = costFor(g, l, p, model);
+        double lambda = 1.0e-3;
+
+        RunResult out;
+        for (out.iterations = 0; out.iterations < maxIterations; ++out.iterations)
+        {
+            // Normal equations from the analytic Jacobian
+            std::fill(JtJ.begin(), JtJ.end(), 0.0);
+            std::fill(Jtr.begin(), Jtr.end(), 0.0);
+            for (int a = 0; a < m; ++a)
+            {
+                const double* ja = jac.data() + (size_t)a * n;
+                double sr = 0.0;
+                for (size_t i = 0; i < n; ++i)
+                    sr += g.weight[i] * ja[i] * (model[i] - g.targetDb[i]);
+                Jtr[(size_t)a] = sr;
+
+                for (int b = 0; b <= a; ++b)
+                {
+                    const double* jb = jac.data() + (size_t)b * n;
+                    double s = 0.0;
+                    for (size_t i = 0; i < n; ++i)
+                        s += g.weight[i] * ja[i] * jb[i];
+                    JtJ[(size_t)(a * m + b)] = JtJ[(size_t)(b * m + a)] = s;
+                }
+            }
+
+            for (int b = 0; b < l.numBands; ++b)
+            {
+                const int k = l.bandBase + b * 3 + 1;
+                JtJ[(size_t)(k * m + k)] += gainRegularisation;
+                Jtr[(size_t)k] += gainRegularisation * p[(size_t)k];
+            }
+
+            bool improved = false;
+            while (lambda < 1.0e10)
+            {
+                A = JtJ;
+                for (int k = 0; k < m; ++k)
+                    A[(size_t)(k * m + k)] += lambda * (JtJ[(size_t)(k * m + k)] + 1.0e-9);
+
+                step.resize((size_t)m);
+                for (int k = 0; k < m; ++k)
+                    step[(size_t)k] = -Jtr[(size_t)k];
+
+                if (choleskySolve(A, step, m))
+                {
+                    for (int k = 0; k < m; ++k)
+                        trial[(size_t)k] = juce::jlimit(l.lower[(size_t)k], l.upper[(size_t)k], p[(size_t)k] + step[(size_t)k]);
+
+                    evaluateModel(g, l, trial, trialPower, trialModel, nullptr);
+                    const double trialCost = costFor(g, l, trial, trialModel);
+
+                    if (trialCost < cost)
+                    {
+                        const double gainInCost = cost - trialCost;
+                        p = trial;
+                        cost = trialCost;
+                        lambda = std::max(1.0e-9, lambda * 0.3);
+                        improved = gainInCost > 1.0e-6 * cost;
+                        break;
+                    }
+                }
+
+                lambda *= 10.0;
+            }
+
+            if (!improved)
+                break;
+
+            evaluateModel(g, l, p, power, model, &jac);
+        }
+
+        out.params = std::move(p);
+        out.cost = cost;
+        return out;
+    }
+}
+
+EqAutoFit::Target EqAutoFit::loadTargetCurve(const juce::File& textFile)
+{
+    Target t;
+    juce::StringArray lines;
+    lines.addLines(textFile.loadFileAsString());
+
+    std::vector<std::pair<double, double>> points;
+    for (auto line : lines)
+    {
+        line = line.upToFirstOccurrenceOf("#", false, false).trim();
+        if (line.isEmpty())
+            continue;
+
+        auto tokens = juce::StringArray::fromTokens(line.replaceCharacters(",;\t", "   "), " ", {});
+        tokens.removeEmptyStrings();
+        if (tokens.size() < 2 || !tokens[0].containsAnyOf("0123456789"))
+            continue;
+
+        const double hz = tokens[0].getDoubleValue();
+        if (hz > 0.0)
+            points.emplace_back(hz, tokens[1].getDoubleValue());
+    }
+
+    std::sort(points.begin(), points.end());
+    for (auto [hz, db] : points)
+    {
+        t.freqHz.push_back(hz);
+        t.db.push_back(db);
+    }
+
+    return t;
+}
+
+EqAutoFit::Target EqAutoFit::loadReferenceSpectrum(const juce::File& audioFile)
+{
+    Target t;
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(audioFile));
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+        return t;
+
+    constexpr int fftOrder = 13;
+    constexpr int fftSize = 1 << fftOrder;
+    constexpr int hop = fftSize / 2;
+    const int numCh = (int)reader->numChannels;
+    const double fs = reader->sampleRate;
+
+    juce::dsp::FFT fft(fftOrder);
+    juce::dsp::WindowingFunction<float> window((size_t)fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+    juce::AudioBuffer<float> frame(numCh, fftSize);
+    std::vector<float> fftData((size_t)fftSize * 2);
+    std::vector<double> powerSum((size_t)fftSize / 2 + 1, 0.0);
+
+    // Average power over overlapping Hann frames and all channels
+    for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += hop)
+    {
+        frame.clear();
+        reader->read(&frame, 0, fftSize, pos, true, true);
+
+        for (int ch = 0; ch < numCh; ++ch)
+        {
+            std::fill(fftData.begin(), fftData.end(), 0.0f);
+            std::copy(frame.getReadPointer(ch), frame.getReadPointer(ch) + fftSize, fftData.begin());
+            window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+            fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+            for (size_t k = 0; k < powerSum.size(); ++k)
+                powerSum[k] += (double)fftData[k] * (double)fftData[k];
+        }
+
+        if (pos + fftSize >= reader->lengthInSamples)
+            break;
+    }
+
+    // 1/6 octave smoothing onto a log grid
+    const double binHz = fs / (double)fftSize;
+    const double fHi = std::min((double)maxEqFreq, 0.49 * fs);
+    constexpr int numPoints = 512;
+    const double halfWidth = std::pow(2.0, 1.0 / 12.0);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const double hz = (double)minEqFreq * std::pow(fHi / (double)minEqFreq, (double)i / (double)(numPoints - 1));
+        const int kLo = juce::jlimit(1, (int)powerSum.size() - 1, (int)std::floor(hz / halfWidth / binHz));
+        const int kHi = juce::jlimit(kLo, (int)powerSum.size() - 1, (int)std::ceil(hz * halfWidth / binHz));
+
+        double sum = 0.0;
+        for (int k = kLo; k <= kHi; ++k)
+            sum += powerSum[(size_t)k];
+
+        t.freqHz.push_back(hz);
+        t.db.push_back(10.0 * std::log10(std::max(1.0e-30, sum / (double)(kHi - kLo + 1))));
+    }
+
+    // Only the shape matters - the I/O gains handle overall level
+    double mean = 0.0;
+    for (auto d : t.db) mean += d;
+    mean /= (double)t.db.size();
+    for (auto& d : t.db) d -= mean;
+
+    return t;
+}
+
+EqAutoFit::Target EqAutoFit::loadTarget(const juce::File& file)
+{
+    if (file.hasFileExtension("csv;txt"))
+        return loadTargetCurve(file);
+
+    return loadReferenceSpectrum(file);
+}
+
+EqAutoFit::Result EqAutoFit::fit(const Target& target, const Options& options)
+{
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+    Result result;
+    result.hpfSlopeIndex = options.hpfSlopeIndex;
+    result.lpfSlopeIndex = options.lpfSlopeIndex;
+
+    if (!target.isValid())
+        return result;
+
+    const auto grid = buildGrid(target, options);
+    const auto layout = buildLayout(options);
+
+    // Independent starting points are spread over worker threads; the best fit wins
+    const int numCpus = juce::jmax(1, juce::SystemStats::getNumCpus());
+    const int numStarts = options.numStarts > 0 ? options.numStarts : numCpus;
+    std::vector<RunResult> runs((size_t)numStarts);
+    std::atomic<int> nextStart{ 0 };
+
+    auto worker = [&]()
+        {
+            for (int s = nextStart++; s < numStarts; s = nextStart++)
+                runs[(size_t)s] = runOptimiser(grid, layout, initialGuess(grid, layout, s), options.maxIterations);
+        };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < juce::jmin(numStarts, numCpus); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
+
+    auto best = *std::min_element(runs.begin(), runs.end(),
+        [](const RunResult& a, const RunResult& b) { return a.cost < b.cost; });
+
+    // A filter pushed to the edge of the range still droops the ends of the band, so each one is only kept if the
+    // fit is measurably worse without it. Dropping one leaves its slot in the parameter vector unused (its Jacobian
+    // row is zero), and the bands get another pass to take up what it was doing.
+    auto finalLayout = layout;
+    auto costWithout = [&](int ParamLayout::* filter)
+        {
+            auto without = finalLayout;
+            without.*filter = -1;
+            std::vector<double> power, model;
+            evaluateModel(grid, without, best.params, power, model, nullptr);
+            return costFor(grid, without, best.params, model);
+        };
+
+    bool dropped = false;
+    for (auto filter : { &ParamLayout::hpf, &ParamLayout::lpf })
+    {
+        if (finalLayout.*filter >= 0 && costWithout(filter) <= best.cost + filterMinBenefit)
+        {
+            finalLayout.*filter = -1;
+            dropped = true;
+        }
+    }
+
+    if (dropped)
+    {
+        auto refined = runOptimiser(grid, finalLayout, best.params, options.maxIterations);
+        refined.iterations += best.iterations;
+        best = std::move(refined);
+    }
+
+    if (finalLayout.hpf >= 0)
+    {
+        result.hpfEnabled = true;
+        result.hpfFreqHz = (float)std::exp(best.params[(size_t)finalLayout.hpf]);
+    }
+
+    if (finalLayout.lpf >= 0)
+    {
+        result.lpfEnabled = true;
+        result.lpfFreqHz = (float)std::exp(best.params[(size_t)finalLayout.lpf]);
+    }
+
+    for (int b = 0; b < layout.numBands; ++b)
+    {
+        const size_t k = (size_t)(layout.bandBase + b * 3);
+        auto& band = result.bands[(size_t)b];
+        band.freqHz = (float)std::exp(best.params[k]);
+        band.gainDb = (float)best.params[k + 1];
+        band.q = (float)std::exp(best.params[k + 2]);
+        band.enabled = std::abs(band.gainDb) >= 0.1f; // Leftover bands would only cost CPU
+    }
+
+    std::vector<double> power, model;
+    evaluateModel(grid, finalLayout, best.params, power, model, nullptr);
+    double sq = 0.0;
+    for (size_t i = 0; i < grid.size(); ++i)
+        sq += grid.weight[i] * (model[i] - grid.targetDb[i]) * (model[i] - grid.targetDb[i]);
+
+    result.rmsErrorDb = std::sqrt(sq);
+    result.iterations = best.iterations;
+    result.elapsedMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+    return result;
+}
+
+void EqAutoFit::applyToParameters(const Result& result, juce::AudioProcessorValueTreeState& apvts)
+{
+    auto set = [&apvts](const juce::String& id, float value)
+        {
+            if (auto* p = apvts.getParameter(id))
+            {
+                p->beginChangeGesture();
+                p->setValueNotifyingHost(p->convertTo0to1(value));
+                p->endChangeGesture();
+            }
+        };
+
+    set("eqMode", 0.0f); // The fit is parametric bands
+    set("hpfEnabled", result.hpfEnabled ? 1.0f : 0.0f);
+    set("lpfEnabled", result.lpfEnabled ? 1.0f : 0.0f);
+
+    if (result.hpfEnabled)
+    {
+        set("hpfFreq", result.hpfFreqHz);
+        set("hpfSlope", (float)result.hpfSlopeIndex);
+    }
+
+    if (result.lpfEnabled)
+    {
+        set("lpfFreq", result.lpfFreqHz);
+        set("lpfSlope", (float)result.lpfSlopeIndex);
+    }
+
+    for (int b = 0; b < maxEqBands; ++b)
+    {
+        const auto& band = result.bands[(size_t)b];
+        const int i = b + 1;
+        set(eqBandParamType(i, "enabled"), band.enabled ? 1.0f : 0.0f);
+
+        if (band.enabled)
+        {
+            set(eqBandParamType(i, "freq"), band.freqHz);
+            set(eqBandParamType(i, "gain"), band.gainDb);
+            set(eqBandParamType(i, "q"), band.q);
+        }
+    }
+}
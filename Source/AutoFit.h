@@ -0,0 +1,80 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include <vector>
+#include "PluginProcessor.h"
+
+/**
+ * Fits the HPF, LPF and peaking band parameters to a target magnitude curve.
+ * The target is either a list of (Hz, dB) points or the long-term average spectrum of a reference file.
+ * Uses Levenberg-Marquardt with analytic gradients, and runs several starting points in parallel.
+ * Has no editor dependencies so the headless JuceEQFit tool can use it too.
+ */
+class EqAutoFit
+{
+public:
+    // Target curve in dB, sorted by ascending frequency
+    struct Target
+    {
+        std::vector<double> freqHz;
+        std::vector<double> db;
+
+        bool isValid() const { return freqHz.size() >= 2 && freqHz.size() == db.size(); }
+    };
+
+    struct Options
+    {
+        double sampleRate = 48000.0;
+        int numBands = EqConstants::maxEqBands; // Peaking bands the optimiser may use
+        int gridPoints = 1024; // Log-spaced evaluation points
+        int numStarts = 0; // Parallel starting points, 0 -> one per hardware thread
+        int maxIterations = 200;
+
+        // Lets the fit use the HPF/LPF - each is only enabled in the result if the fit is worse without it
+        bool fitHpf = true;
+        bool fitLpf = true;
+        int hpfSlopeIndex = 1; // Same indices as the "hpfSlope"/"lpfSlope" choices (0 -> 6 dB ... 3 -> 48 dB)
+        int lpfSlopeIndex = 1;
+    };
+
+    struct BandResult
+    {
+        bool enabled = false;
+        float freqHz = 1000.0f;
+        float gainDb = 0.0f;
+        float q = 1.0f;
+    };
+
+    struct Result
+    {
+        bool hpfEnabled = false;
+        float hpfFreqHz = EqConstants::minEqFreq;
+        int hpfSlopeIndex = 1;
+
+        bool lpfEnabled = false;
+        float lpfFreqHz = EqConstants::maxEqFreq;
+        int lpfSlopeIndex = 1;
+
+        std::array<BandResult, EqConstants::maxEqBands> bands{};
+
+        double rmsErrorDb = 0.0;
+        int iterations = 0;
+        double elapsedMs = 0.0;
+    };
+
+    // Reads "freq, dB" pairs (comma or whitespace separated, '#' starts a comment)
+    static Target loadTargetCurve(const juce::File& textFile);
+
+    // Long-term average spectrum of an audio file, 1/6 octave smoothed and normalised to 0 dB mean
+    static Target loadReferenceSpectrum(const juce::File& audioFile);
+
+    // Picks loadTargetCurve or loadReferenceSpectrum from the file extension
+    static Target loadTarget(const juce::File& file);
+
+    // Runs the optimiser. Blocks the calling thread, so call it off the message thread.
+    static Result fit(const Target& target, const Options& options);
+
+    // Writes a result into the plugin parameters (message thread)
+    static void applyToParameters(const Result& result, juce::AudioProcessorValueTreeState& apvts);
+};
@@ -178,7 +178,7 @@ void BandRow::resized()
 }
 
 // ---------- BandControlsComponent ----------
-BandControlsComponent::BandControlsComponent(JuceEQAudioProcessor& proc) : processor(proc)
+BandControlsComponent::BandControlsComponent(JuceEQAudioProcessor& proc) : processor(proc), graphicEq(proc)
 {
     // HPF
     addAndMakeVisible(hpfEnable);
@@ -277,6 +277,35 @@ BandControlsComponent::BandControlsComponent(JuceEQAudioProcessor& proc) : proce
     lpfFreqAttach = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processor.apvts, "lpfFreq", *lpfFreq.knob);
     lpfSlopeAttach = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(processor.apvts, "lpfSlope", lpfSlope);
 
+    // Limiter
+    addAndMakeVisible(limiterEnable);
+    addAndMakeVisible(limiterTruePeak);
+    addAndMakeVisible(limiterCeiling);
+    addAndMakeVisible(limiterLookahead);
+    addAndMakeVisible(limiterRelease);
+
+    auto showValue = [](KnobWithLabel& k, int decimals, const juce::String& unit)
+        {
+            k.knob->onValueChange = [&k, decimals, unit]()
+                {
+                    if (k.valueLabel) k.valueLabel->setText(juce::String(k.knob->getValue(), decimals) + unit, juce::dontSendNotification);
+                };
+        };
+    showValue(limiterCeiling, 1, " dB");
+    showValue(limiterLookahead, 1, " ms");
+    showValue(limiterRelease, 0, " ms");
+
+    limiterEnableAttach = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(processor.apvts, "limiterEnabled", limiterEnable);
+    limiterTruePeakAttach = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(processor.apvts, "limiterTruePeak", limiterTruePeak);
+    limiterCeilingAttach = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processor.apvts, "limiterCeiling", *limiterCeiling.knob);
+    limiterLookaheadAttach = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processor.apvts, "limiterLookahead", *limiterLookahead.knob);
+    limiterReleaseAttach = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(processor.apvts, "limiterRelease", *limiterRelease.knob);
+
+    // Attachments set the range and value, so fill in the labels afterwards
+    limiterCeiling.knob->onValueChange();
+    limiterLookahead.knob->onValueChange();
+    limiterRelease.knob->onValueChange();
+
     // Bands container and rows
     bandsContainer = std::make_unique<juce::Component>();
     addAndMakeVisible(*bandsContainer);
@@ -288,6 +317,27 @@ BandControlsComponent::BandControlsComponent(JuceEQAudioProcessor& proc) : proce
         bandsContainer->addAndMakeVisible(*row);
         bands.push_back(std::move(row));
     }
+
+    // EQ mode
+    eqModeLabel.setText("EQ", juce::dontSendNotification);
+    eqModeLabel.setJustificationType(juce::Justification::centredLeft);
+    addAndMakeVisible(eqModeLabel);
+
+    eqMode.addItem("Parametric", 1);
+    eqMode.addItem("Graphic", 2);
+    addAndMakeVisible(eqMode);
+    addChildComponent(graphicEq);
+
+    eqModeAttach = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(processor.apvts, "eqMode", eqMode);
+    eqMode.onChange = [this]() { updateModeVisibility(); };
+    updateModeVisibility();
+}
+
+void BandControlsComponent::updateModeVisibility()
+{
+    const bool graphic = eqMode.getSelectedItemIndex() == 1;
+    bandsContainer->setVisible(!graphic);
+    graphicEq.setVisible(graphic);
 }
 
 int BandControlsComponent::preferredHeight()
@@ -295,7 +345,9 @@ int BandControlsComponent::preferredHeight()
     const int lpfHpfRow = 100; // HPF and LPF on a single row
     const int rowH = 110;
     const int bandRows = (maxEqBands + 1) / 2; // Two band EQ controls per row
-    return lpfHpfRow + bandRows * rowH + 16;
+    const int limiterRow = 100;
+    const int modeRow = 36;
+    return lpfHpfRow + modeRow + bandRows * rowH + limiterRow + 24;
 }
 
 void BandControlsComponent::resized()
@@ -340,6 +392,32 @@ void BandControlsComponent::resized()
 
     bounds.removeFromTop(8);
 
+    // Limiter row along the bottom
+    {
+        auto limiterRow = bounds.removeFromBottom(100);
+        bounds.removeFromBottom(8);
+
+        auto left = limiterRow.removeFromLeft(110);
+        limiterEnable.setBounds(left.removeFromTop(24));
+        limiterTruePeak.setBounds(left.removeFromTop(24));
+
+        const int knobW = 110;
+        limiterCeiling.setBounds(limiterRow.removeFromLeft(knobW));
+        limiterLookahead.setBounds(limiterRow.removeFromLeft(knobW));
+        limiterRelease.setBounds(limiterRow.removeFromLeft(knobW));
+    }
+
+    // EQ mode row
+    {
+        auto modeRow = bounds.removeFromTop(28);
+        eqModeLabel.setBounds(modeRow.removeFromLeft(40));
+        eqMode.setBounds(modeRow.removeFromLeft(130).withSizeKeepingCentre(130, 24));
+        bounds.removeFromTop(8);
+    }
+
+    // The graphic EQ takes the whole band area
+    graphicEq.setBounds(bounds);
+
     // Two bands per row
     if (bandsContainer)
     {
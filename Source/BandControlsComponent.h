@@ -3,6 +3,7 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "PluginProcessor.h"
 #include "LookAndFeel.h"
+#include "GraphicEqComponent.h"
 
 // Rotary knob with caption and value label 
 struct KnobWithLabel : public juce::Component
@@ -48,7 +49,8 @@ public:
     void resized() override;
 
 private:
-    
+    void updateModeVisibility(); // Parametric bands or the graphic EQ, as the mode combo says
+
     static juce::String hzInt(double v) 
     { 
         return juce::String(juce::roundToInt(v)) + " Hz"; 
@@ -76,7 +78,25 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lpfFreqAttach;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> lpfSlopeAttach;
 
+    // Output limiter
+    juce::ToggleButton limiterEnable{ "Limiter" };
+    juce::ToggleButton limiterTruePeak{ "True peak" };
+    KnobWithLabel limiterCeiling{ "Ceiling", false };
+    KnobWithLabel limiterLookahead{ "Lookahead", false };
+    KnobWithLabel limiterRelease{ "Release", false };
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> limiterEnableAttach, limiterTruePeakAttach;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> limiterCeilingAttach, limiterLookaheadAttach, limiterReleaseAttach;
+
+    // EQ mode, above the bands
+    juce::Label eqModeLabel;
+    juce::ComboBox eqMode;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> eqModeAttach;
+
     // Bands container
     std::unique_ptr<juce::Component> bandsContainer;
     std::vector<std::unique_ptr<BandRow>> bands;
+
+    // Graphic mode, in the bands' place
+    GraphicEqComponent graphicEq;
 };
\ No newline at end of file
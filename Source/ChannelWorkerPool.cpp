@@ -0,0 +1,326 @@
+#include "ChannelWorkerPool.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+namespace
+{
+    // Polite busy-wait hint - never a syscall, the audio thread spins on this too
+    inline void cpuRelax()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+        __asm__ __volatile__("yield");
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+
+    inline double ticksToUs(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+    }
+
+    // Job cursor: generation in the top 32 bits, the run's task count in the next 16 and the next task index in
+    // the low 16
+    constexpr juce::uint64 indexMask = 0xffff;
+    constexpr int countShift = 16;
+    constexpr int generationShift = 32;
+}
+
+//==============================================================================
+// One pool's current run. Everything but the cursor is written before the cursor is released, and only read after
+// a task has been claimed from it.
+struct alignas(64) ChannelWorkerPool::Job
+{
+    std::atomic<bool> inUse{ false };
+    std::atomic<juce::uint64> cursor{ 0 };
+    std::atomic<TaskFunction> function{ nullptr };
+    std::atomic<void*> context{ nullptr };
+    std::atomic<int> tasksDone{ 0 };
+    std::atomic<juce::int64> taskTicks{ 0 }; // Summed task time over all threads, this run
+
+    // Claims the next task of the current run - false once they're all taken. A thread that read the cursor during
+    // an earlier run can't take an index of this one: its compare-exchange fails on the generation and it re-reads.
+    bool claim(int& task)
+    {
+        auto c = cursor.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            const auto next = c & indexMask;
+            if (next >= ((c >> countShift) & indexMask))
+                return false;
+
+            if (cursor.compare_exchange_weak(c, c + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                task = (int)next;
+                return true;
+            }
+        }
+    }
+
+    // Runs tasks until none are left to claim - true if it ran any
+    bool drain()
+    {
+        bool ranAny = false;
+
+        for (int t = 0; claim(t);)
+        {
+            // The run can't finish (and the fields can't change) until this task is counted done
+            const auto start = juce::Time::getHighResolutionTicks();
+            function.load(std::memory_order_relaxed)(context.load(std::memory_order_relaxed), t);
+            taskTicks.fetch_add(juce::Time::getHighResolutionTicks() - start, std::memory_order_relaxed);
+            tasksDone.fetch_add(1, std::memory_order_acq_rel);
+            ranAny = true;
+        }
+
+        return ranAny;
+    }
+};
+
+//==============================================================================
+// The process's worker threads and job slots. Threads exist only while at least one pool is started; they aren't
+// pinned, so the OS spreads them (and the hosts' own threads) over the cores.
+class ChannelWorkerPool::Workers
+{
+public:
+    static constexpr int maxJobs = 128;
+
+    static Workers& getInstance()
+    {
+        static Workers workers;
+        return workers;
+    }
+
+    ~Workers()
+    {
+        stopThreads();
+    }
+
+    Job* acquire(int numWorkers)
+    {
+        const juce::ScopedLock sl(lock);
+
+        Job* claimed = nullptr;
+        for (int i = 0; i < maxJobs && claimed == nullptr; ++i)
+        {
+            if (!jobs[i].inUse.load(std::memory_order_relaxed))
+            {
+                jobs[i].inUse.store(true, std::memory_order_relaxed);
+                claimed = &jobs[i];
+                numJobsInUse.store(juce::jmax(numJobsInUse.load(std::memory_order_relaxed), i + 1), std::memory_order_release);
+                ++numPools;
+            }
+        }
+
+        if (claimed == nullptr)
+            return nullptr;
+
+        const int target = juce::jmin(numWorkers, juce::SystemStats::getNumCpus() - 1);
+        while ((int)threads.size() < target)
+        {
+            threads.push_back(std::make_unique<Worker>(*this, (int)threads.size()));
+            // Realtime scheduling can be refused (e.g. no rtprio on Linux) - fall back to the highest normal priority
+            if (!threads.back()->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(9)))
+                threads.back()->startThread(juce::Thread::Priority::highest);
+        }
+
+        numThreads.store((int)threads.size(), std::memory_order_relaxed);
+        return claimed;
+    }
+
+    // The pool's last run has finished (its owner isn't running one), so the slot can go straight back
+    void release(Job* job)
+    {
+        const juce::ScopedLock sl(lock);
+        job->inUse.store(false, std::memory_order_relaxed);
+
+        if (--numPools == 0)
+        {
+            stopThreads();
+            numJobsInUse.store(0, std::memory_order_release);
+        }
+    }
+
+    int getNumThreads() const { return numThreads.load(std::memory_order_relaxed); }
+
+    // Audio thread, after a job's cursor is released. The wake call only happens when a worker has gone to sleep,
+    // i.e. on the first run after an idle spell.
+    void publish()
+    {
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) > 0)
+            epoch.notify_all();
+    }
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(Workers& w, int index)
+            : juce::Thread("JuceEQ channel worker " + juce::String(index)), owner(w)
+        {
+        }
+
+        void run() override
+        {
+            const auto idleTicks = juce::Time::secondsToHighResolutionTicks(idleSpinMs * 0.001);
+            auto seen = owner.epoch.load(std::memory_order_acquire);
+            auto lastWork = juce::Time::getHighResolutionTicks();
+
+            while (!threadShouldExit())
+            {
+                if (owner.drainAll())
+                {
+                    lastWork = juce::Time::getHighResolutionTicks();
+                    continue;
+                }
+
+                // A run published since the scan started gets another scan
+                const auto e = owner.epoch.load(std::memory_order_acquire);
+                if (e != seen)
+                {
+                    seen = e;
+                    continue;
+                }
+
+                if (juce::Time::getHighResolutionTicks() - lastWork < idleTicks)
+                {
+                    cpuRelax();
+                    continue;
+                }
+
+                // Transport stopped - block until a run (or stopThreads) moves the epoch on. Counting ourselves
+                // as a sleeper before wait() re-checks the epoch means publish() either sees us or we see it.
+                owner.sleepers.fetch_add(1, std::memory_order_seq_cst);
+                owner.epoch.wait(seen, std::memory_order_acquire);
+                owner.sleepers.fetch_sub(1, std::memory_order_relaxed);
+                lastWork = juce::Time::getHighResolutionTicks();
+            }
+        }
+
+    private:
+        Workers& owner;
+    };
+
+    Workers() = default;
+
+    bool drainAll()
+    {
+        bool ranAny = false;
+        const int n = numJobsInUse.load(std::memory_order_acquire);
+
+        for (int i = 0; i < n; ++i)
+            ranAny = jobs[i].drain() || ranAny;
+
+        return ranAny;
+    }
+
+    // Under lock
+    void stopThreads()
+    {
+        for (auto& t : threads)
+            t->signalThreadShouldExit();
+
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        epoch.notify_all();
+
+        for (auto& t : threads)
+            t->stopThread(1000);
+
+        threads.clear();
+        numThreads.store(0, std::memory_order_relaxed);
+    }
+
+    static constexpr double idleSpinMs = 20.0;
+
+    juce::CriticalSection lock;
+    std::vector<std::unique_ptr<Worker>> threads;
+    int numPools = 0;
+
+    Job jobs[maxJobs];
+    std::atomic<int> numJobsInUse{ 0 }; // Slots [0, numJobsInUse) may have work - the workers only scan those
+    std::atomic<int> numThreads{ 0 };
+    std::atomic<juce::uint32> epoch{ 0 }; // Moves on every run, and when the threads are told to exit
+    std::atomic<int> sleepers{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(Workers)
+};
+
+//==============================================================================
+void ChannelWorkerPool::start(int numWorkers)
+{
+    stop();
+
+    if (numWorkers > 0)
+        job = Workers::getInstance().acquire(numWorkers);
+}
+
+void ChannelWorkerPool::stop()
+{
+    if (job != nullptr)
+    {
+        Workers::getInstance().release(job);
+        job = nullptr;
+    }
+}
+
+int ChannelWorkerPool::getNumWorkers() const
+{
+    return job != nullptr ? Workers::getInstance().getNumThreads() : 0;
+}
+
+void ChannelWorkerPool::run(int numTasks, TaskFunction function, void* context)
+{
+    if (job == nullptr || numTasks <= 1 || numTasks > (int)indexMask)
+    {
+        for (int t = 0; t < numTasks; ++t)
+            function(context, t);
+        return;
+    }
+
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    // Publish the job under the next generation, then wake the workers
+    job->function.store(function, std::memory_order_relaxed);
+    job->context.store(context, std::memory_order_relaxed);
+    job->taskTicks.store(0, std::memory_order_relaxed);
+    job->tasksDone.store(0, std::memory_order_relaxed);
+
+    const auto generation = (job->cursor.load(std::memory_order_relaxed) >> generationShift) + 1;
+    job->cursor.store((generation << generationShift) | ((juce::uint64)numTasks << countShift), std::memory_order_release);
+    Workers::getInstance().publish();
+
+    job->drain(); // The audio thread takes tasks too
+
+    while (job->tasksDone.load(std::memory_order_acquire) < numTasks)
+        cpuRelax();
+
+    // Overhead = wall time beyond a perfect split of the work over everyone who could take part
+    const double wallUs = ticksToUs(juce::Time::getHighResolutionTicks() - start);
+    const int participants = juce::jmin(numTasks, getNumWorkers() + 1);
+    const double idealUs = ticksToUs(job->taskTicks.load(std::memory_order_relaxed)) / (double)participants;
+
+    constexpr double smoothing = 0.05;
+    lastWallUs.store(wallUs, std::memory_order_relaxed);
+    averageWallUs.store(averageWallUs.load(std::memory_order_relaxed) * (1.0 - smoothing) + wallUs * smoothing, std::memory_order_relaxed);
+    averageOverheadUs.store(averageOverheadUs.load(std::memory_order_relaxed) * (1.0 - smoothing)
+        + juce::jmax(0.0, wallUs - idealUs) * smoothing, std::memory_order_relaxed);
+    runCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+ChannelWorkerPool::Stats ChannelWorkerPool::getStats() const
+{
+    Stats s;
+    s.lastWallUs = lastWallUs.load(std::memory_order_relaxed);
+    s.averageWallUs = averageWallUs.load(std::memory_order_relaxed);
+    s.averageSyncOverheadUs = averageOverheadUs.load(std::memory_order_relaxed);
+    s.runs = runCount.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+/**
+ * Splits one audio block's channels over worker threads shared by every instance in the process.
+ * Each started pool owns a job slot; run() is called from the audio thread: it publishes a task count and a plain
+ * function pointer in the slot, helps with the tasks itself, and spins until they're all done. The shared workers
+ * take tasks from any slot with work in it, so a session of many wide instances still has at most one worker per
+ * spare core. No locks or allocations per run, and no system calls while the workers are awake.
+ * Idle workers spin for a short while after each run, then block until the next one (the run that wakes them
+ * makes one futex-style wake call).
+ */
+class ChannelWorkerPool
+{
+public:
+    using TaskFunction = void (*)(void* context, int taskIndex);
+
+    struct Stats
+    {
+        double lastWallUs = 0.0; // Publish to last task finished, last run
+        double averageWallUs = 0.0;
+        double averageSyncOverheadUs = 0.0; // Wall time minus the ideal split of the task time
+        juce::int64 runs = 0;
+    };
+
+    ChannelWorkerPool() = default;
+    ~ChannelWorkerPool() { stop(); }
+
+    // Not real-time safe - call from prepareToPlay / releaseResources. start() claims a job slot and makes sure
+    // the shared workers number at least numWorkers (never more than the spare cores); the last pool to stop
+    // stops them. Without a free slot the pool runs its tasks on the calling thread.
+    void start(int numWorkers);
+    void stop();
+
+    int getNumWorkers() const; // Shared workers that can help this pool - 0 when it isn't started
+
+    void run(int numTasks, TaskFunction function, void* context);
+
+    Stats getStats() const;
+
+private:
+    struct Job;
+    class Workers; // Process-wide threads and job slots
+
+    Job* job = nullptr;
+
+    // Published measurements
+    std::atomic<double> lastWallUs{ 0.0 };
+    std::atomic<double> averageWallUs{ 0.0 };
+    std::atomic<double> averageOverheadUs{ 0.0 };
+    std::atomic<juce::int64> runCount{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelWorkerPool)
+};
@@ -0,0 +1,159 @@
+#include "CpuGovernor.h"
+#include <cmath>
+
+namespace
+{
+    juce::SpinLock policyLock;
+
+    CpuGovernor::Policy& sessionPolicy()
+    {
+        static CpuGovernor::Policy policy = CpuGovernor::parsePolicy(juce::SystemStats::getEnvironmentVariable("JUCEEQ_GOVERNOR", {}));
+        return policy;
+    }
+}
+
+CpuGovernor::Policy CpuGovernor::getSessionPolicy()
+{
+    const juce::SpinLock::ScopedLockType sl(policyLock);
+    return sessionPolicy();
+}
+
+void CpuGovernor::setSessionPolicy(const Policy& policy)
+{
+    const juce::SpinLock::ScopedLockType sl(policyLock);
+    sessionPolicy() = policy;
+}
+
+CpuGovernor::Policy CpuGovernor::parsePolicy(const juce::String& text)
+{
+    Policy policy;
+    const auto trimmed = text.trim();
+    if (trimmed.isEmpty() || trimmed == "off")
+        return policy;
+
+    policy.enabled = true;
+
+    for (const auto& item : juce::StringArray::fromTokens(trimmed, ",", {}))
+    {
+        const auto key = item.upToFirstOccurrenceOf("=", false, false).trim();
+        const auto value = item.fromFirstOccurrenceOf("=", false, false).trim().getDoubleValue();
+
+        if (key == "down") policy.stepDownLoad = value;
+        else if (key == "up") policy.stepUpLoad = value;
+        else if (key == "hold") policy.stepDownSeconds = value;
+        else if (key == "recover") policy.stepUpSeconds = value;
+        else if (key == "lowest") policy.lowestTier = juce::jlimit((int)full, numTiers - 1, (int)value);
+    }
+
+    policy.stepUpLoad = juce::jmin(policy.stepUpLoad, policy.stepDownLoad);
+    return policy;
+}
+
+const char* CpuGovernor::getTierName(int tier)
+{
+    switch (tier)
+    {
+        case noOversampling: return "No oversampling";
+        case coarseUpdates: return "Coarse updates";
+        case full:
+        default: return "Full";
+    }
+}
+
+void CpuGovernor::prepare(double newSampleRate)
+{
+    policy = getSessionPolicy();
+    sampleRate = newSampleRate;
+    tier = full;
+    load = 0.0;
+    pressureSeconds = headroomSeconds = 0.0;
+    stepUpSeconds = policy.stepUpSeconds;
+    secondsSinceStepUp = maxStepUpSeconds;
+
+    reportedTier.store(tier, std::memory_order_relaxed);
+    reportedLoad.store(0.0f, std::memory_order_relaxed);
+}
+
+void CpuGovernor::setTier(int newTier)
+{
+    tier = juce::jlimit((int)full, numTiers - 1, newTier);
+    reportedTier.store(tier, std::memory_order_relaxed);
+}
+
+int CpuGovernor::tierBelow(int tier, int effectiveTiers)
+{
+    for (int t = tier + 1; t < numTiers; ++t)
+        if ((effectiveTiers & (1 << t)) != 0)
+            return t;
+
+    return numTiers;
+}
+
+int CpuGovernor::tierAbove(int tier, int effectiveTiers)
+{
+    for (int t = tier - 1; t > full; --t)
+        if ((effectiveTiers & (1 << t)) != 0)
+            return t;
+
+    return full;
+}
+
+// Smoothed load against the thresholds, held for a while before each step. A step down that comes sooner after a
+// step up than the recovery time doubles the recovery time (up to a minute, until the next prepare), so a
+// borderline load doesn't cycle between two tiers. Steps skip the tiers that wouldn't shed anything - stepping down
+// to one of them would leave the load where it was, and the governor would go on to the next or stay there for
+// nothing.
+void CpuGovernor::end(juce::int64 startTicks, int numSamples, int effectiveTiers)
+{
+    if (!policy.enabled || numSamples <= 0)
+        return;
+
+    const double blockSeconds = numSamples / sampleRate;
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    load += (1.0 - std::exp(-blockSeconds / smoothingSeconds)) * (elapsed / blockSeconds - load);
+    secondsSinceStepUp += blockSeconds;
+
+    // A tier that no longer sheds anything (the settings moved on) only costs quality, so it's left at once - this
+    // can't raise the load, so it isn't a step up that the recovery time counts against
+    if (tier > full && (effectiveTiers & (1 << tier)) == 0)
+    {
+        tier = tierAbove(tier, effectiveTiers);
+        pressureSeconds = headroomSeconds = 0.0;
+    }
+
+    const int nextTierDown = tierBelow(tier, effectiveTiers);
+
+    if (load > policy.stepDownLoad && nextTierDown <= policy.lowestTier)
+    {
+        headroomSeconds = 0.0;
+        pressureSeconds += blockSeconds;
+
+        if (pressureSeconds >= policy.stepDownSeconds)
+        {
+            if (secondsSinceStepUp < stepUpSeconds)
+                stepUpSeconds = juce::jmin(maxStepUpSeconds, stepUpSeconds * 2.0);
+
+            tier = nextTierDown;
+            pressureSeconds = 0.0;
+        }
+    }
+    else if (load < policy.stepUpLoad && tier > full)
+    {
+        pressureSeconds = 0.0;
+        headroomSeconds += blockSeconds;
+
+        if (headroomSeconds >= stepUpSeconds)
+        {
+            tier = tierAbove(tier, effectiveTiers);
+            headroomSeconds = 0.0;
+            secondsSinceStepUp = 0.0;
+        }
+    }
+    else
+    {
+        pressureSeconds = headroomSeconds = 0.0;
+    }
+
+    reportedTier.store(tier, std::memory_order_relaxed);
+    reportedLoad.store((float)load, std::memory_order_relaxed);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+/**
+ * Watches how long each processBlock takes against its deadline (the block's duration) and, when the load stays
+ * high, steps the instance down through quality tiers - and back up once there's headroom again - so a rig near
+ * capacity loses a little quality rather than dropping audio. The tiers are cumulative; none of them changes the
+ * latency or resets a filter:
+ *  - noOversampling: the limiter's true-peak detector reads sample peaks instead of interpolating 4x
+ *  - coarseUpdates: parameters are picked up, and filters redesigned, every 20 ms rather than every block
+ * A tier only sheds work at some settings (EqChain::getEffectiveTiers()), so the governor steps past the ones that
+ * wouldn't, and leaves one straight away once it stops shedding anything - at the defaults it stays at full quality,
+ * as no tier would lower the load.
+ * The policy (thresholds, hold times, lowest tier) is process-wide, so every instance in a session follows the same
+ * rules. It's off unless JUCEEQ_GOVERNOR is set or setSessionPolicy() turns it on, and instances pick it up at
+ * their next prepare. begin()/end() cost two tick reads per block; nothing locks or allocates.
+ */
+class CpuGovernor
+{
+public:
+    enum Tier
+    {
+        full = 0,
+        noOversampling,
+        coarseUpdates,
+        numTiers
+    };
+
+    struct Policy
+    {
+        bool enabled = false;
+        double stepDownLoad = 0.5; // processBlock time as a fraction of the block's duration
+        double stepUpLoad = 0.25;
+        double stepDownSeconds = 0.5; // How long (in audio time) the load has to stay past a threshold
+        double stepUpSeconds = 5.0;
+        int lowestTier = numTiers - 1;
+    };
+
+    // JUCEEQ_GOVERNOR=on, or a list like "down=0.6,up=0.3,hold=0.25,recover=10,lowest=1" (also turns it on)
+    static Policy getSessionPolicy();
+    static void setSessionPolicy(const Policy& policy);
+    static Policy parsePolicy(const juce::String& text);
+
+    static const char* getTierName(int tier);
+
+    void prepare(double sampleRate); // Takes the session policy, back to full quality
+
+    // Around each block on the audio thread - begin() returns the start time for end(). effectiveTiers are the
+    // tiers that would shed work for the block's settings, as bits (1 << tier).
+    juce::int64 begin() const { return policy.enabled ? juce::Time::getHighResolutionTicks() : 0; }
+    void end(juce::int64 startTicks, int numSamples, int effectiveTiers);
+
+    int getTier() const { return tier; } // Audio thread
+
+    // Sets the tier outright - for replaying a captured session with the policy off, between blocks on the thread
+    // that processes them. A policy that's on moves it again from the next block.
+    void setTier(int newTier);
+    int getReportedTier() const { return reportedTier.load(std::memory_order_relaxed); } // Any thread
+    float getLoad() const { return reportedLoad.load(std::memory_order_relaxed); } // Smoothed, any thread
+    bool isEnabled() const { return policy.enabled; }
+
+private:
+    static constexpr double smoothingSeconds = 0.1;
+    static constexpr double maxStepUpSeconds = 60.0;
+
+    // The nearest effective tier below this one (numTiers if none) or above it (full if none)
+    static int tierBelow(int tier, int effectiveTiers);
+    static int tierAbove(int tier, int effectiveTiers);
+
+    Policy policy;
+    double sampleRate = 44100.0;
+    int tier = full;
+
+    double load = 0.0;
+    double pressureSeconds = 0.0, headroomSeconds = 0.0;
+    double stepUpSeconds = 5.0; // Doubles each time a step up has to be undone straight away
+    double secondsSinceStepUp = 0.0;
+
+    std::atomic<int> reportedTier{ full };
+    std::atomic<float> reportedLoad{ 0.0f };
+};
@@ -0,0 +1,52 @@
+#include "DelayLine.h"
+
+void DelayLine::allocate(DspArena& arena, int newNumChannels, int newMaxLength)
+{
+    numChannels = newNumChannels;
+    maxLength = juce::jmax(1, newMaxLength);
+    ring = arena.take<float>((size_t)numChannels * (size_t)maxLength);
+    length = 0;
+    pos = 0;
+}
+
+void DelayLine::setLength(int newLength)
+{
+    length = juce::jlimit(0, maxLength, newLength);
+    pos = 0;
+    std::fill(ring.begin(), ring.end(), 0.0f);
+}
+
+// Swaps each incoming sample with the one written 'length' samples ago, in runs between ring wraps
+void DelayLine::process(float* const* channels, int numChannels, int numSamples)
+{
+    if (length == 0)
+        return;
+
+    numChannels = juce::jmin(numChannels, this->numChannels);
+    int done = 0;
+    int p = pos;
+
+    while (done < numSamples)
+    {
+        const int run = juce::jmin(numSamples - done, length - p);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* io = channels[ch] + done;
+            float* r = ring.data() + (size_t)ch * (size_t)maxLength + p;
+            for (int i = 0; i < run; ++i)
+            {
+                const float delayed = r[i];
+                r[i] = io[i];
+                io[i] = delayed;
+            }
+        }
+
+        done += run;
+        p += run;
+        if (p == length)
+            p = 0;
+    }
+
+    pos = p;
+}
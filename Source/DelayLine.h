@@ -0,0 +1,23 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <span>
+#include "DspArena.h"
+
+/**
+ * Fixed-size circular delay, one line per channel (channel ch at ring[ch * maxLength]), carved from the owner's
+ * DspArena. Used wherever part of the chain has latency and something else (the dry signal, the other band)
+ * has to stay lined up with it.
+ */
+struct DelayLine
+{
+    std::span<float> ring;
+    int numChannels = 0;
+    int maxLength = 1;
+    int length = 0;
+    int pos = 0;
+
+    void allocate(DspArena& arena, int numChannels, int maxLength);
+    void setLength(int newLength); // Clears the line
+    void process(float* const* channels, int numChannels, int numSamples); // In place
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+/**
+ * One cache-line aligned allocation holding all of an instance's audio-thread state (filter states, crossfade
+ * and limiter buffers), so hundreds of instances don't each scatter dozens of small heap blocks.
+ * The layout is written once as a function that take()s every piece; build() runs it twice - first only to
+ * measure, then against the allocated block - so the sizes can't drift apart. Memory is zeroed and only grows.
+ * Only trivially destructible types live here; nothing is destructed when the block is reused.
+ * build() returns false if the block can't be allocated - the arena is then empty and every span the layout took
+ * is empty too (they're only the measuring pass's), so the owner must treat itself as unprepared.
+ */
+class DspArena
+{
+public:
+    static constexpr size_t alignment = 64;
+
+    template <typename LayoutFn>
+    bool build(LayoutFn&& layout)
+    {
+        measuring = true;
+        used = 0;
+        layout(*this);
+
+        if (used > capacity)
+        {
+            storage.free();
+            storage.malloc(used + alignment);
+            capacity = 0;
+
+            if (storage == nullptr)
+            {
+                base = nullptr;
+                measuring = false;
+                used = 0;
+                return false; // The measuring pass left every span empty
+            }
+
+            capacity = used;
+        }
+
+        const auto address = reinterpret_cast<std::uintptr_t>(storage.get());
+        base = storage.get() + ((alignment - address % alignment) % alignment);
+
+        if (base != nullptr)
+            std::memset(base, 0, capacity);
+
+        measuring = false;
+        used = 0;
+        layout(*this);
+        return true;
+    }
+
+    // Empty span while measuring; value-initialised objects once live
+    template <typename T>
+    std::span<T> take(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "DspArena never runs destructors");
+        static_assert(alignof(T) <= alignment);
+
+        const size_t offset = used;
+        used += (count * sizeof(T) + alignment - 1) / alignment * alignment;
+
+        if (measuring || count == 0)
+            return {};
+
+        jassert(used <= capacity);
+        auto* items = reinterpret_cast<T*>(base + offset);
+        std::uninitialized_value_construct_n(items, count);
+        return { items, count };
+    }
+
+    bool isMeasuring() const { return measuring; }
+    size_t getBytes() const { return capacity; }
+
+private:
+    juce::HeapBlock<char> storage;
+    char* base = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    bool measuring = false;
+};
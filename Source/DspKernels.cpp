@@ -0,0 +1,116 @@
+#include "DspKernels.h"
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+namespace DspKernels
+{
+    // One per DspKernels<Isa>.cpp - null where that file was built without its instruction set
+    const Table* getGenericTable();
+    const Table* getAvx2Table();
+    const Table* getAvx512Table();
+}
+
+namespace
+{
+    std::atomic<const DspKernels::Table*> activeTable{ nullptr };
+
+    const DspKernels::Table* getTable(DspKernels::Isa isa)
+    {
+        switch (isa)
+        {
+            case DspKernels::Isa::avx2: return DspKernels::getAvx2Table();
+            case DspKernels::Isa::avx512: return DspKernels::getAvx512Table();
+            case DspKernels::Isa::generic:
+            default: return DspKernels::getGenericTable();
+        }
+    }
+
+    bool parseIsa(const juce::String& name, DspKernels::Isa& isa)
+    {
+        const std::pair<const char*, DspKernels::Isa> names[] = {
+            { "generic", DspKernels::Isa::generic },
+            { "avx2", DspKernels::Isa::avx2 },
+            { "avx512", DspKernels::Isa::avx512 }
+        };
+
+        for (const auto& [n, candidate] : names)
+        {
+            if (name.trim().equalsIgnoreCase(n))
+            {
+                isa = candidate;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // JUCEEQ_ISA if it names something this machine runs, otherwise the widest variant it supports
+    const DspKernels::Table* chooseTable()
+    {
+        const auto forced = juce::SystemStats::getEnvironmentVariable("JUCEEQ_ISA", {});
+        DspKernels::Isa isa;
+
+        if (forced.isNotEmpty())
+        {
+            if (parseIsa(forced, isa) && DspKernels::isSupported(isa))
+                return getTable(isa);
+
+            DBG("JUCEEQ_ISA=" + forced + " isn't available here - using the default kernels");
+        }
+
+        for (auto candidate : { DspKernels::Isa::avx512, DspKernels::Isa::avx2 })
+            if (DspKernels::isSupported(candidate))
+                return getTable(candidate);
+
+        return getTable(DspKernels::Isa::generic);
+    }
+}
+
+namespace DspKernels
+{
+    const Table& get()
+    {
+        if (auto* table = activeTable.load(std::memory_order_acquire))
+            return *table;
+
+        // Racing first calls make the same choice, so whichever store lands is fine
+        auto* table = chooseTable();
+        activeTable.store(table, std::memory_order_release);
+        return *table;
+    }
+
+    bool isSupported(Isa isa)
+    {
+        if (getTable(isa) == nullptr)
+            return false;
+
+        switch (isa)
+        {
+            case Isa::avx2:
+                return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+
+            case Isa::avx512:
+                return juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+
+            case Isa::generic:
+            default:
+                return true;
+        }
+    }
+
+    bool select(Isa isa)
+    {
+        if (!isSupported(isa))
+            return false;
+
+        activeTable.store(getTable(isa), std::memory_order_release);
+        return true;
+    }
+
+    bool select(const char* name)
+    {
+        Isa isa;
+        return parseIsa(juce::String::fromUTF8(name), isa) && select(isa);
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+/**
+ * The hot loops of the audio path - filter sections, the graphic EQ bank, lane-packed strip sections, gain ramps, crossfades, peak metering
+ * and response evaluation - compiled once per instruction set and picked at runtime from the CPU's features, so
+ * one portable binary still gets FMA and wide vectors on machines that have them:
+ *  - generic: the build's baseline (SSE2 on x86-64, NEON on arm64)
+ *  - avx2: AVX2 + FMA
+ *  - avx512: AVX-512F + FMA, 512-bit vectors
+ * Each variant is its own translation unit (DspKernels<Isa>.cpp, flags set per file in CMakeLists.txt) that
+ * includes DspKernelsImpl.h. The best supported variant is used unless JUCEEQ_ISA=generic|avx2|avx512 says
+ * otherwise; tools can also force one with select().
+ * Nothing here includes JUCE: the variant files must stay clear of headers with inline code, since the linker may
+ * keep an AVX-compiled copy of an inline function for the whole program.
+ */
+namespace DspKernels
+{
+    enum class Isa { generic, avx2, avx512 };
+
+    struct DirectFormCoefficients
+    {
+        float b0, b1, b2, a1, a2;
+    };
+
+    struct SvfCoefficients
+    {
+        float g, gk, h, m0, m1, m2;
+    };
+
+    // A series of peaking sections run as a pipeline, one per lane: each step, lane j filters the sample lane j - 1
+    // filtered the step before, so every band works at once and the output is exactly the serial cascade's.
+    // numLanes is a multiple of 8; spare lanes pass through (b0 = 1, the rest 0).
+    struct GraphicBankCoefficients
+    {
+        static constexpr int maxLanes = 32;
+
+        int numLanes = 0;
+        alignas(64) float b0[maxLanes]{};
+        alignas(64) float b1[maxLanes]{};
+        alignas(64) float b2[maxLanes]{};
+        alignas(64) float a1[maxLanes]{};
+        alignas(64) float a2[maxLanes]{};
+    };
+
+    struct GraphicBankState
+    {
+        alignas(64) float z1[GraphicBankCoefficients::maxLanes]{};
+        alignas(64) float z2[GraphicBankCoefficients::maxLanes]{};
+    };
+
+    // The same SVF section run in every lane of a batch, each lane with its own coefficients, so independent mono
+    // channels (StripBank's strips) filter side by side. Data is interleaved: [sample][lane].
+    // First-order sections use the same recurrence with g = 0 (the low integrator stays at 0), gk = 1, h = the
+    // one-pole gain and m1 = its m2; a lane with m0 = 1 and the rest 0 passes through with its state untouched.
+    struct LaneSectionCoefficients
+    {
+        static constexpr int numLanes = 16;
+
+        alignas(64) float g[numLanes]{};
+        alignas(64) float gk[numLanes]{};
+        alignas(64) float h[numLanes]{};
+        alignas(64) float m0[numLanes]{};
+        alignas(64) float m1[numLanes]{};
+        alignas(64) float m2[numLanes]{};
+    };
+
+    struct LaneSectionState
+    {
+        alignas(64) float ic1[LaneSectionCoefficients::numLanes]{};
+        alignas(64) float ic2[LaneSectionCoefficients::numLanes]{};
+    };
+
+    // Any of the sections above on one channel, blockLength samples at a time. With the section as
+    // s[n+1] = A s[n] + B x[n], y[n] = C s[n] + D x[n] in its own state (TDF-II s1/s2, SVF ic1/ic2, one-pole z and an
+    // unused second state), a block is
+    //   y = fromState * s + T * x      T lower-triangular Toeplitz, T[k][j] = impulse[blockLength + k - j]
+    //   s += blockDelta * s + toState * x
+    // so every multiply runs across the block instead of along the recurrence. Matrices that would sit next to the
+    // identity are held as their difference from it (blockDelta = A^L - I, stepDelta = A - I), as the SVF's are for
+    // low f/fs. Leftover samples run one at a time with stepDelta, input (B), output (C) and direct (D).
+    struct StateSpaceCoefficients
+    {
+        static constexpr int blockLength = 16;
+
+        alignas(64) float impulse[2 * blockLength]{}; // blockLength zeros, then D, CB, CAB, CA^2B...
+        alignas(64) float fromState[2][blockLength]{}; // [i][k] = (C A^k)[i]
+        alignas(64) float toState[2][blockLength]{}; // [i][j] = (A^(L-1-j) B)[i]
+        float blockDelta[2][2]{};
+        float stepDelta[2][2]{};
+        float input[2]{}, output[2]{};
+        float direct = 1.0f;
+    };
+
+    struct Table
+    {
+        Isa isa;
+        const char* name;
+
+        // One filter section over one channel, in place. state is the section's two floats (see FilterSection).
+        void (*directForm)(const DirectFormCoefficients&, float* state, float* data, int numSamples);
+        void (*svf)(const SvfCoefficients&, float* state, float* data, int numSamples);
+        void (*onePole)(const SvfCoefficients&, float* state, float* data, int numSamples);
+        void (*stateSpace)(const StateSpaceCoefficients&, float* state, float* data, int numSamples); // Same state as the above
+        void (*graphicBank)(const GraphicBankCoefficients&, GraphicBankState&, float* data, int numSamples);
+        void (*laneSection)(const LaneSectionCoefficients&, LaneSectionState&, float* data, int numSamples);
+
+        void (*multiply)(float* data, float gain, int numSamples);
+        void (*multiplyByRamp)(float* data, const float* ramp, int numSamples);
+        void (*crossfade)(float* wet, const float* dry, const float* ramp, int numSamples); // wet = dry + (wet - dry) * ramp
+        float (*peak)(const float* data, int numSamples); // Largest |x|
+
+        // magnitudes[i] = product over the sections of |H(e^jw)| ^ counts[s] at freqs[i], for TDF-II
+        // coefficients { b0, b1, b2, a1, a2 }
+        void (*responseMagnitudes)(const double (*coeffs)[5], const int* counts, int numSections,
+                                   const double* freqs, double* magnitudes, int numFreqs, double sampleRate);
+    };
+
+    // The selected variant. The first call picks it (reading JUCEEQ_ISA), so make that off the audio thread.
+    const Table& get();
+
+    bool isSupported(Isa isa); // Built in, and the CPU (and OS) can run it
+
+    // Forces a variant for tests and benchmarks - false (and nothing changes) if it isn't supported or the
+    // name isn't one of generic, avx2, avx512
+    bool select(Isa isa);
+    bool select(const char* name);
+}
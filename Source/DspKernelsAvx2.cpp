@@ -0,0 +1,22 @@
+// AVX2 + FMA variant - built with -mavx2 -mfma (/arch:AVX2) on x86, only called once the CPU reports both.
+// Elsewhere (or without the flags) it compiles to nothing and the variant isn't offered.
+#include "DspKernels.h"
+
+#if defined(__AVX2__)
+ #define JUCEEQ_KERNEL_ISA DspKernels::Isa::avx2
+ #define JUCEEQ_KERNEL_NAME "avx2"
+ #define JUCEEQ_KERNEL_LANES 8
+ #include "DspKernelsImpl.h"
+#endif
+
+namespace DspKernels
+{
+    const Table* getAvx2Table()
+    {
+       #if defined(__AVX2__)
+        return &kernelTable;
+       #else
+        return nullptr;
+       #endif
+    }
+}
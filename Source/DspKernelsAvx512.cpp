@@ -0,0 +1,22 @@
+// AVX-512F + FMA variant with 512-bit vectors - built with -mavx512f -mfma (/arch:AVX512) on x86, only called
+// once the CPU reports them. Elsewhere (or without the flags) it compiles to nothing and the variant isn't offered.
+#include "DspKernels.h"
+
+#if defined(__AVX512F__)
+ #define JUCEEQ_KERNEL_ISA DspKernels::Isa::avx512
+ #define JUCEEQ_KERNEL_NAME "avx512"
+ #define JUCEEQ_KERNEL_LANES 16
+ #include "DspKernelsImpl.h"
+#endif
+
+namespace DspKernels
+{
+    const Table* getAvx512Table()
+    {
+       #if defined(__AVX512F__)
+        return &kernelTable;
+       #else
+        return nullptr;
+       #endif
+    }
+}
@@ -0,0 +1,13 @@
+// Baseline variant - the build's default flags, so it runs anywhere the rest of the plugin does
+#define JUCEEQ_KERNEL_ISA DspKernels::Isa::generic
+#define JUCEEQ_KERNEL_NAME "generic"
+#define JUCEEQ_KERNEL_LANES 4
+#include "DspKernelsImpl.h"
+
+namespace DspKernels
+{
+    const Table* getGenericTable()
+    {
+        return &kernelTable;
+    }
+}
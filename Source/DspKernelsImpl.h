@@ -0,0 +1,379 @@
+// The kernel bodies, included once by each DspKernels<Isa>.cpp after it defines
+//  JUCEEQ_KERNEL_ISA   the DspKernels::Isa it's built for
+//  JUCEEQ_KERNEL_NAME  its name, as JUCEEQ_ISA takes it
+//  JUCEEQ_KERNEL_LANES floats per vector register, for the reductions the compiler won't vectorise on its own
+// The rest of the code is plain loops written so the compiler vectorises them with that file's flags (and
+// contracts the multiply-adds into FMAs where it has them). Everything is in an anonymous namespace, so each
+// variant's copies stay separate. No includes with inline code (see DspKernels.h).
+
+#include "DspKernels.h"
+#include <cmath>
+
+namespace
+{
+    constexpr int lanes = JUCEEQ_KERNEL_LANES;
+    constexpr float denormalThreshold = 1.0e-15f;
+
+    inline float absolute(float x)
+    {
+        return x < 0.0f ? -x : x;
+    }
+
+    // Flush denormals out of the decaying state
+    inline float flushed(float x)
+    {
+        return absolute(x) < denormalThreshold ? 0.0f : x;
+    }
+
+    void directForm(const DspKernels::DirectFormCoefficients& c, float* state, float* data, int numSamples)
+    {
+        // Coefficients in locals - data could alias c as far as the compiler knows, which forces reloads every sample
+        const float b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+        float z1 = state[0], z2 = state[1];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = data[i];
+            const float y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            data[i] = y;
+        }
+
+        state[0] = flushed(z1);
+        state[1] = flushed(z2);
+    }
+
+    // band = ic1 / (1 + g * gk) + h * v3, written as ic1 + h * (v3 - gk * ic1) so no coefficient sits next to 1.0
+    void svf(const DspKernels::SvfCoefficients& c, float* state, float* data, int numSamples)
+    {
+        const float g = c.g, gk = c.gk, h = c.h, m0 = c.m0, m1 = c.m1, m2 = c.m2;
+        float ic1 = state[0], ic2 = state[1];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = data[i];
+            const float v3 = x - ic2;
+            const float band = ic1 + h * (v3 - gk * ic1);
+            const float low = ic2 + g * band;
+            ic1 = 2.0f * band - ic1;
+            ic2 = 2.0f * low - ic2;
+            data[i] = m0 * x + m1 * band + m2 * low;
+        }
+
+        state[0] = flushed(ic1);
+        state[1] = flushed(ic2);
+    }
+
+    void onePole(const DspKernels::SvfCoefficients& c, float* state, float* data, int numSamples)
+    {
+        const float g = c.g, m0 = c.m0, m2 = c.m2;
+        float z = state[0];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = data[i];
+            const float v = (x - z) * g;
+            const float low = v + z;
+            z = low + v;
+            data[i] = m0 * x + m2 * low;
+        }
+
+        state[0] = flushed(z);
+    }
+
+    // Each block's output is the state's contribution plus one column of the Toeplitz matrix per input sample, all
+    // blockLength wide; the state's update from the inputs is a dot product, summed pairwise so it's a few vector adds
+    // rather than a serial chain. Nothing carries between blocks but the state, so the per-sample kernels can take over.
+    void stateSpace(const DspKernels::StateSpaceCoefficients& c, float* state, float* __restrict data, int numSamples)
+    {
+        constexpr int n = DspKernels::StateSpaceCoefficients::blockLength;
+        alignas(64) float impulse[2 * n], from0[n], from1[n], to0[n], to1[n];
+
+        for (int k = 0; k < 2 * n; ++k)
+            impulse[k] = c.impulse[k];
+
+        for (int k = 0; k < n; ++k)
+        {
+            from0[k] = c.fromState[0][k];
+            from1[k] = c.fromState[1][k];
+            to0[k] = c.toState[0][k];
+            to1[k] = c.toState[1][k];
+        }
+
+        const float bd00 = c.blockDelta[0][0], bd01 = c.blockDelta[0][1], bd10 = c.blockDelta[1][0], bd11 = c.blockDelta[1][1];
+        const float sd00 = c.stepDelta[0][0], sd01 = c.stepDelta[0][1], sd10 = c.stepDelta[1][0], sd11 = c.stepDelta[1][1];
+        const float b0 = c.input[0], b1 = c.input[1], c0 = c.output[0], c1 = c.output[1], d = c.direct;
+        float s0 = state[0], s1 = state[1];
+        int i = 0;
+
+        for (; i + n <= numSamples; i += n)
+        {
+            alignas(64) float x[n], y[n], p0[n], p1[n];
+
+            for (int k = 0; k < n; ++k)
+            {
+                x[k] = data[i + k];
+                y[k] = from0[k] * s0 + from1[k] * s1;
+                p0[k] = to0[k] * x[k];
+                p1[k] = to1[k] * x[k];
+            }
+
+            // Column j is h[k - j], zero above the diagonal
+            for (int j = 0; j < n; ++j)
+            {
+                const float xj = x[j];
+                const float* column = impulse + n - j;
+
+                for (int k = 0; k < n; ++k)
+                    y[k] += column[k] * xj;
+            }
+
+            for (int width = n / 2; width > 0; width /= 2)
+            {
+                for (int k = 0; k < width; ++k)
+                {
+                    p0[k] += p0[k + width];
+                    p1[k] += p1[k + width];
+                }
+            }
+
+            const float next0 = s0 + (bd00 * s0 + bd01 * s1 + p0[0]);
+            const float next1 = s1 + (bd10 * s0 + bd11 * s1 + p1[0]);
+            s0 = next0;
+            s1 = next1;
+
+            for (int k = 0; k < n; ++k)
+                data[i + k] = y[k];
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            const float x = data[i];
+            data[i] = c0 * s0 + c1 * s1 + d * x;
+
+            const float next0 = s0 + (sd00 * s0 + sd01 * s1 + b0 * x);
+            const float next1 = s1 + (sd10 * s0 + sd11 * s1 + b1 * x);
+            s0 = next0;
+            s1 = next1;
+        }
+
+        state[0] = flushed(s0);
+        state[1] = flushed(s1);
+    }
+
+    // One pipeline step over every lane - lanes outside [firstActive, lastActive] (filling or draining) keep their state
+    template <bool partial>
+    inline void graphicBankStep(const DspKernels::GraphicBankCoefficients& c, float* __restrict z1, float* __restrict z2,
+                                const float* __restrict in, float* __restrict out, int firstActive, int lastActive)
+    {
+        for (int j = 0; j < c.numLanes; ++j)
+        {
+            const float x = in[j];
+            const float y = c.b0[j] * x + z1[j];
+            const float next1 = c.b1[j] * x - c.a1[j] * y + z2[j];
+            const float next2 = c.b2[j] * x - c.a2[j] * y;
+            out[j] = y;
+
+            if constexpr (partial)
+            {
+                const bool active = j >= firstActive && j <= lastActive;
+                z1[j] = active ? next1 : z1[j];
+                z2[j] = active ? next2 : z2[j];
+            }
+            else
+            {
+                z1[j] = next1;
+                z2[j] = next2;
+            }
+        }
+    }
+
+    // Step t feeds sample t into lane 0 and takes sample t - (numLanes - 1) out of the last lane, so a block runs
+    // numLanes - 1 extra steps to fill and drain the pipeline - nothing is left in flight between blocks, and
+    // there's no latency. Idle lanes compute on whatever is in their slot, but only ever feed other idle lanes.
+    void graphicBank(const DspKernels::GraphicBankCoefficients& c, DspKernels::GraphicBankState& s, float* data, int numSamples)
+    {
+        constexpr int maxLanes = DspKernels::GraphicBankCoefficients::maxLanes;
+        const int numLanes = c.numLanes;
+        alignas(64) float in[maxLanes] = {};
+        alignas(64) float out[maxLanes] = {};
+
+        const int numSteps = numSamples + numLanes - 1;
+        for (int t = 0; t < numSteps; ++t)
+        {
+            in[0] = t < numSamples ? data[t] : 0.0f;
+
+            if (t >= numLanes - 1 && t < numSamples)
+                graphicBankStep<false>(c, s.z1, s.z2, in, out, 0, numLanes - 1);
+            else
+                graphicBankStep<true>(c, s.z1, s.z2, in, out, t - numSamples + 1, t);
+
+            if (t >= numLanes - 1)
+                data[t - (numLanes - 1)] = out[numLanes - 1];
+
+            // Each lane's output moves on to the next lane
+            for (int j = 1; j < numLanes; ++j)
+                in[j] = out[j - 1];
+        }
+
+        for (int j = 0; j < numLanes; ++j)
+        {
+            s.z1[j] = flushed(s.z1[j]);
+            s.z2[j] = flushed(s.z2[j]);
+        }
+    }
+
+    // svf() across the lanes - the lanes are independent, so each sample is one vector step and the recurrence only
+    // runs along the samples. Coefficients and states are copied to locals so data can't alias them.
+    void laneSection(const DspKernels::LaneSectionCoefficients& c, DspKernels::LaneSectionState& s, float* __restrict data, int numSamples)
+    {
+        constexpr int n = DspKernels::LaneSectionCoefficients::numLanes;
+        alignas(64) float g[n], gk[n], h[n], m0[n], m1[n], m2[n], ic1[n], ic2[n];
+
+        for (int j = 0; j < n; ++j)
+        {
+            g[j] = c.g[j];
+            gk[j] = c.gk[j];
+            h[j] = c.h[j];
+            m0[j] = c.m0[j];
+            m1[j] = c.m1[j];
+            m2[j] = c.m2[j];
+            ic1[j] = s.ic1[j];
+            ic2[j] = s.ic2[j];
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float* __restrict x = data + i * n;
+
+            for (int j = 0; j < n; ++j)
+            {
+                const float v3 = x[j] - ic2[j];
+                const float band = ic1[j] + h[j] * (v3 - gk[j] * ic1[j]);
+                const float low = ic2[j] + g[j] * band;
+                ic1[j] = 2.0f * band - ic1[j];
+                ic2[j] = 2.0f * low - ic2[j];
+                x[j] = m0[j] * x[j] + m1[j] * band + m2[j] * low;
+            }
+        }
+
+        for (int j = 0; j < n; ++j)
+        {
+            s.ic1[j] = flushed(ic1[j]);
+            s.ic2[j] = flushed(ic2[j]);
+        }
+    }
+
+    void multiply(float* __restrict data, float gain, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= gain;
+    }
+
+    void multiplyByRamp(float* __restrict data, const float* __restrict ramp, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= ramp[i];
+    }
+
+    void crossfade(float* __restrict wet, const float* __restrict dry, const float* __restrict ramp, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            wet[i] = dry[i] + (wet[i] - dry[i]) * ramp[i];
+    }
+
+    // One running maximum per lane, so the inner loop maps onto a single vector max
+    float peak(const float* data, int numSamples)
+    {
+        float laneMax[lanes] = {};
+        int i = 0;
+
+        for (; i + lanes <= numSamples; i += lanes)
+        {
+            for (int j = 0; j < lanes; ++j)
+            {
+                const float a = absolute(data[i + j]);
+                laneMax[j] = a > laneMax[j] ? a : laneMax[j];
+            }
+        }
+
+        float result = 0.0f;
+        for (; i < numSamples; ++i)
+            result = absolute(data[i]) > result ? absolute(data[i]) : result;
+
+        for (int j = 0; j < lanes; ++j)
+            result = laneMax[j] > result ? laneMax[j] : result;
+
+        return result;
+    }
+
+    // The trig depends only on the frequency, so it's done once per point for all the sections (cos 2w and sin 2w
+    // from the double-angle identities). The per-section loops are then plain arithmetic across the points, and
+    // only the product of the squared magnitudes needs a square root.
+    void responseMagnitudes(const double (*coeffs)[5], const int* counts, int numSections,
+                            const double* freqs, double* magnitudes, int numFreqs, double sampleRate)
+    {
+        constexpr int chunk = 64;
+        double cos1[chunk], sin1[chunk], cos2[chunk], sin2[chunk], squared[chunk], power[chunk];
+        const double toRadians = 2.0 * 3.14159265358979323846 / sampleRate;
+
+        for (int start = 0; start < numFreqs; start += chunk)
+        {
+            const int n = numFreqs - start < chunk ? numFreqs - start : chunk;
+
+            for (int i = 0; i < n; ++i)
+            {
+                const double w = toRadians * freqs[start + i];
+                cos1[i] = std::cos(w);
+                sin1[i] = std::sin(w);
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                cos2[i] = 2.0 * cos1[i] * cos1[i] - 1.0;
+                sin2[i] = 2.0 * sin1[i] * cos1[i];
+                power[i] = 1.0;
+            }
+
+            for (int s = 0; s < numSections; ++s)
+            {
+                const double* c = coeffs[s];
+
+                for (int i = 0; i < n; ++i)
+                {
+                    // Numerator and denominator at z = e^jw
+                    const double numRe = c[0] + c[1] * cos1[i] + c[2] * cos2[i];
+                    const double numIm = c[1] * sin1[i] + c[2] * sin2[i];
+                    const double denRe = 1.0 + c[3] * cos1[i] + c[4] * cos2[i];
+                    const double denIm = c[3] * sin1[i] + c[4] * sin2[i];
+                    squared[i] = (numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm);
+                }
+
+                // Cascaded stages share one design
+                for (int k = 0; k < counts[s]; ++k)
+                    for (int i = 0; i < n; ++i)
+                        power[i] *= squared[i];
+            }
+
+            for (int i = 0; i < n; ++i)
+                magnitudes[start + i] = std::sqrt(power[i]);
+        }
+    }
+
+    const DspKernels::Table kernelTable{
+        JUCEEQ_KERNEL_ISA,
+        JUCEEQ_KERNEL_NAME,
+        directForm,
+        svf,
+        onePole,
+        stateSpace,
+        graphicBank,
+        laneSection,
+        multiply,
+        multiplyByRamp,
+        crossfade,
+        peak,
+        responseMagnitudes
+    };
+}
@@ -0,0 +1,872 @@
+#include "EqChain.h"
+#include "Trace.h"
+
+using namespace EqConstants;
+
+bool EqChain::willUseBlockFilters(int numChannels, int maxBlockSize) const
+{
+    // automatic goes by this machine's benchmark at the block size, so callers that record it (the session capture)
+    // record this outcome rather than the request
+    return requestedEngine == Engine::floatingPoint
+        && (requestedBlockFilters == BlockFilters::on
+            || (requestedBlockFilters == BlockFilters::automatic && juce::jlimit(1, maxChannels, numChannels) <= 2
+                && FilterSection::isBlockProcessingFaster(juce::jmax(1, maxBlockSize))));
+}
+
+bool EqChain::prepare(double sampleRate, int maxBlockSize, int numChannels, bool bypassed)
+{
+    const int numCh = juce::jlimit(1, maxChannels, numChannels);
+    preparedBlockSize = juce::jmax(1, maxBlockSize);
+    engine = requestedEngine;
+
+    // Settled before the rebuild below, which gives every section its block form when this is on
+    blockFilters = willUseBlockFilters(numCh, preparedBlockSize);
+
+    currentSampleRate = sampleRate;
+    graphicDesign = GraphicEq(sampleRate);
+
+    // Prevents zipping noises when moving I/O faders
+    inputGain.reset(sampleRate, gainRampSeconds);
+    outputGain.reset(sampleRate, gainRampSeconds);
+
+    coarseUpdateSamples = juce::jmax(1, (int)std::round(coarseUpdateSeconds * sampleRate));
+    redesignHoldSamples = juce::jmax(1, (int)std::round(redesignHoldSeconds * sampleRate));
+    samplesSinceSnapshot = 0;
+
+    // All audio-thread state lives in one block: per-channel filter states (every filter treated as mono),
+    // both dry copies for the bypass and flat-curve crossfades, the fade ramp and the limiter's buffers
+    limiter.prepare(sampleRate, preparedBlockSize, numCh);
+    const size_t numFixedChannels = engine == Engine::fixedPoint ? (size_t)numCh : 0;
+    multirate.prepare(sampleRate, preparedBlockSize, requestedMultirate && engine == Engine::floatingPoint ? numCh : 0);
+    const size_t numLowBandChannels = multirate.isActive() ? (size_t)numCh : 0;
+    lowBand = {};
+
+    std::span<float> dryData;
+    prepared = dspArena.build([&](DspArena& arena)
+        {
+            channelFilters = arena.take<ChannelFilters>((size_t)numCh);
+            dryData = arena.take<float>((size_t)(2 * numCh) * (size_t)preparedBlockSize);
+            fadeRamp = arena.take<float>((size_t)preparedBlockSize);
+            limiter.allocate(arena);
+            fixedFilters = arena.take<FixedChannelFilters>(numFixedChannels);
+            fixedScratch = arena.take<juce::int32>(numFixedChannels * (size_t)preparedBlockSize);
+            multirate.allocate(arena);
+            lowBandFilters = arena.take<LowBandFilters>(numLowBandChannels);
+        });
+
+    // Nothing to run the chain on - process() leaves the audio alone until a prepare succeeds
+    if (!prepared)
+    {
+        workerPool.stop();
+        latencySamples.store(0);
+        tailSeconds.store(0.0);
+        return false;
+    }
+
+    float* dryChannels[2 * maxChannels];
+    for (int ch = 0; ch < 2 * numCh; ++ch)
+        dryChannels[ch] = dryData.data() + (size_t)ch * (size_t)preparedBlockSize;
+    dryBuffer.setDataToReferTo(dryChannels, 2 * numCh, preparedBlockSize);
+
+    bypassMix.reset(sampleRate, crossfadeSeconds);
+    filterMix.reset(sampleRate, crossfadeSeconds);
+    bypassMix.setCurrentAndTargetValue(bypassed ? 0.0f : 1.0f);
+    filterMix.setCurrentAndTargetValue(1.0f);
+    filtersEngaged = true;
+
+    limiterWasEnabled = false;
+    silentSamples = 0;
+    outputDecayed = false;
+    sleeping = false;
+
+    // Worker pool for wide channel layouts - threads only exist when they'll be used
+    const int numChannelGroups = ((int)channelFilters.size() + workerPoolOptions.channelsPerTask - 1) / workerPoolOptions.channelsPerTask;
+    const int numWorkers = juce::jmin(workerPoolOptions.maxWorkers, numChannelGroups - 1, juce::SystemStats::getNumCpus() - 1);
+
+    if (workerPoolOptions.enabled && (int)channelFilters.size() >= workerPoolOptions.channelThreshold && numWorkers > 0)
+    {
+        if (workerPool.getNumWorkers() < numWorkers)
+            workerPool.start(numWorkers);
+    }
+    else
+    {
+        workerPool.stop();
+    }
+
+    // Force first-time coeff build
+    dirty.hpf.store(true);
+    dirty.lpf.store(true);
+    for (auto& d : dirty.peak) d.store(true);
+    dirty.graphic.store(true);
+
+    lastSnap = {}; // reset baseline
+    applySettings();
+    updateDirtyFilters();
+    updateLimiter();
+    samplesSinceRedesign = std::numeric_limits<int>::max(); // The first design isn't automation
+
+    return true;
+}
+
+void EqChain::stop()
+{
+    workerPool.stop();
+}
+
+void EqChain::jumpGainsToSettings()
+{
+    inputGain.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(pendingSettings.inGainDb));
+    outputGain.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(pendingSettings.outGainDb));
+}
+
+void EqChain::reset()
+{
+    if (!prepared)
+        return;
+
+    resetFilterState();
+    limiter.reset();
+    multirate.reset();
+
+    silentSamples = 0;
+    outputDecayed = false;
+    sleeping = false;
+}
+
+// The arena is sized for the prepared block, so callers that exceed it get the block in prepared-size pieces. The
+// pieces are plain pointers into the caller's channels - a juce::AudioBuffer referring to them would allocate its
+// channel list past 32 channels.
+void EqChain::process(float* const* channels, int numChannels, int numSamples, bool bypassed)
+{
+    if (!prepared || numSamples <= 0)
+        return;
+
+    if (numSamples <= preparedBlockSize)
+    {
+        processChain(channels, numChannels, numSamples, bypassed);
+        return;
+    }
+
+    const int numCh = juce::jmin(numChannels, maxChannels);
+    float* piece[maxChannels];
+
+    for (int start = 0; start < numSamples; start += preparedBlockSize)
+    {
+        const int n = juce::jmin(preparedBlockSize, numSamples - start);
+        for (int ch = 0; ch < numCh; ++ch)
+            piece[ch] = channels[ch] + start;
+
+        processChain(piece, numCh, n, bypassed);
+    }
+}
+
+bool EqChain::isChainFlat(const Settings& settings)
+{
+    if (settings.hpfEnabled || settings.lpfEnabled)
+        return false;
+
+    if (settings.graphicMode)
+        return isGraphicFlat(settings);
+
+    for (const auto& band : settings.bands)
+        if (band.enabled && band.gainDb != 0.0f)
+            return false;
+
+    return true;
+}
+
+bool EqChain::isGraphicFlat(const Settings& settings)
+{
+    for (float gainDb : settings.graphicGainsDb)
+        if (gainDb != 0.0f)
+            return false;
+
+    return true;
+}
+
+void EqChain::processChain(float* const* channels, int numChannels, int numSamples, bool bypassed)
+{
+    juce::ScopedNoDenormals noDenormals; // For effeciency - rounds down very small floats to 0 to reduce processing load
+    EQ_TRACE_THREAD_NAME("Audio");
+    EQ_TRACE_SCOPE("processBlock");
+
+    // Rebuild only what's different from the last settings (keeps coeffs current while bypassed) - every block,
+    // or at the control rate when the governor has stepped down that far
+    samplesSinceSnapshot += numSamples;
+    if (qualityTier < CpuGovernor::coarseUpdates || samplesSinceSnapshot >= coarseUpdateSamples)
+    {
+        applySettings();
+        updateDirtyFilters();
+        samplesSinceSnapshot = 0;
+    }
+
+    samplesSinceRedesign = (int)juce::jmin((juce::int64)samplesSinceRedesign + numSamples, (juce::int64)std::numeric_limits<int>::max());
+
+    const int numCh = juce::jmin(numChannels, dryBuffer.getNumChannels() / 2); // As prepared
+
+    bypassMix.setTargetValue(bypassed ? 0.0f : 1.0f);
+
+    updateLimiter();
+    const bool limiterDelayed = curSnap.limiterEnabled && limiter.getLatencySamples() > 0;
+    const bool dryDelayed = limiterDelayed || multirate.isActive();
+
+    // Zero-cost bypass - once faded out, the buffer passes straight through (only delayed to match the reported latency)
+    if (bypassed && !bypassMix.isSmoothing() && bypassMix.getCurrentValue() == 0.0f)
+    {
+        if (limiterDelayed)
+            limiter.delayDry(channels, numCh, numSamples);
+        if (multirate.isActive())
+            multirate.delayDry(channels, numCh, numSamples);
+
+        // Nothing of the filters is heard, so a flat-curve fade has nothing to smooth - it finishes here
+        filterMix.setCurrentAndTargetValue(filterMix.getTargetValue());
+        filtersEngaged = false;
+        return;
+    }
+
+    // Sleep mode - once the input has been silent for longer than the tail and the output has decayed,
+    // there's nothing left to compute. The state is flushed so waking up starts clean.
+    // The input is measured before the input gain, so the threshold is scaled down by it (the larger of where its
+    // ramp is and where it's going) - a large in-gain can't lift a "silent" input into audible output
+    const float inGain = juce::jmax(inputGain.getCurrentValue(), juce::Decibels::decibelsToGain(curSnap.inGainDb));
+    const float inputThreshold = inGain > 0.0f ? silenceThreshold / inGain : std::numeric_limits<float>::max();
+    const bool inputSilent = isSilent(channels, numCh, numSamples, inputThreshold);
+    silentSamples = inputSilent ? (int)juce::jmin((juce::int64)silentSamples + numSamples, (juce::int64)std::numeric_limits<int>::max()) : 0;
+
+    if (inputSilent && outputDecayed && silentSamples > tailSamples + latencySamples.load(std::memory_order_relaxed))
+    {
+        if (!sleeping)
+        {
+            resetFilterState();
+            sleeping = true;
+        }
+
+        filterMix.setCurrentAndTargetValue(filterMix.getTargetValue());
+        return;
+    }
+
+    sleeping = false;
+
+    // The dry copy runs through the second delay lines whenever there's latency, so it's already aligned when a bypass fade starts
+    const bool bypassFading = bypassMix.isSmoothing();
+    if (bypassFading || dryDelayed)
+    {
+        for (int ch = 0; ch < numCh; ++ch)
+            dryBuffer.copyFrom(ch, 0, channels[ch], numSamples);
+
+        if (limiterDelayed)
+            limiter.delayDry(dryBuffer.getArrayOfWritePointers(), numCh, numSamples);
+        if (multirate.isActive())
+            multirate.delayDry(dryBuffer.getArrayOfWritePointers(), numCh, numSamples);
+    }
+
+    // Input gain affects all channels prior to EQ filter and band application
+    {
+        EQ_TRACE_SCOPE("inputGain");
+        applyGain(channels, numCh, numSamples, inputGain, curSnap.inGainDb);
+    }
+
+    // Multirate - the low band is split off here and the block delayed to line up with it, so everything from
+    // here on (the flat-curve path and its crossfade included) sees the same latency
+    if (multirate.isActive())
+    {
+        EQ_TRACE_SCOPE("multirateSplit");
+        const TelemetryPublisher::StageScope stageTime(telemetry, Telemetry::multirateStage);
+        multirate.split(channels, numCh, numSamples);
+    }
+
+    // Flat-curve fast path - skip the filters, fading them out/in around the switch
+    const bool filterFading = filterMix.isSmoothing();
+    if (filterFading || filterMix.getCurrentValue() > 0.0f)
+    {
+        // The sections pick up from the state they had when they were skipped, so the HPF and low peaks don't
+        // restart from zero and ring under the fade-in
+        filtersEngaged = true;
+
+        if (filterFading)
+        {
+            // Pre-filter signal goes in the second half of the dry buffer when the bypass fade already uses the first
+            const int dryOffset = bypassFading ? numCh : 0;
+            for (int ch = 0; ch < numCh; ++ch)
+                dryBuffer.copyFrom(dryOffset + ch, 0, channels[ch], numSamples);
+
+            processFilters(channels, numCh, numSamples);
+            applyCrossfade(channels, numCh, numSamples, dryOffset, filterMix);
+        }
+        else
+        {
+            processFilters(channels, numCh, numSamples);
+        }
+    }
+    else
+    {
+        filtersEngaged = false;
+    }
+
+    // Apply output gain to all channels
+    {
+        EQ_TRACE_SCOPE("outputGain");
+        applyGain(channels, numCh, numSamples, outputGain, curSnap.outGainDb);
+    }
+
+    // Brickwall limiter after the output gain
+    if (curSnap.limiterEnabled)
+    {
+        EQ_TRACE_SCOPE("limiter");
+        const TelemetryPublisher::StageScope stageTime(telemetry, Telemetry::limiterStage);
+        limiter.process(channels, numCh, numSamples);
+    }
+
+    if (bypassFading)
+    {
+        EQ_TRACE_SCOPE("bypassCrossfade");
+        applyCrossfade(channels, numCh, numSamples, 0, bypassMix);
+    }
+
+    // Only worth checking once the input has gone quiet
+    outputDecayed = inputSilent && isSilent(channels, numCh, numSamples, silenceThreshold);
+}
+
+// Pushes limiter setting changes into the limiter and works out the chain's latency
+void EqChain::updateLimiter()
+{
+    const LookaheadLimiter::Settings settings{ curSnap.limiterCeilingDb, curSnap.limiterLookaheadMs,
+        curSnap.limiterReleaseMs, curSnap.limiterTruePeak };
+
+    if (settings != limiterSettings)
+    {
+        limiter.setSettings(settings);
+        limiterSettings = settings;
+    }
+
+    limiter.setTruePeakOversampling(qualityTier < CpuGovernor::noOversampling);
+
+    // Stale gain and delay state from the last time it was on would click
+    if (curSnap.limiterEnabled && !limiterWasEnabled)
+        limiter.reset();
+    limiterWasEnabled = curSnap.limiterEnabled;
+
+    latencySamples.store((curSnap.limiterEnabled ? limiter.getLatencySamples() : 0) + multirate.getLatencySamples(),
+                         std::memory_order_relaxed);
+}
+
+bool EqChain::isSilent(const float* const* channels, int numChannels, int numSamples, float threshold)
+{
+    const auto& kernels = DspKernels::get();
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        if (kernels.peak(channels[ch], numSamples) > threshold)
+            return false;
+
+    return true;
+}
+
+// One ramp for every channel, filled once and then applied a channel at a time (dsp::Gain steps through the
+// channels inside its per-sample loop, which doesn't vectorise). Unity gain is left alone.
+void EqChain::applyGain(float* const* channels, int numChannels, int numSamples,
+                        juce::SmoothedValue<float>& gain, float gainDb)
+{
+    gain.setTargetValue(juce::Decibels::decibelsToGain(gainDb));
+
+    const auto& kernels = DspKernels::get();
+
+    if (gain.isSmoothing())
+    {
+        for (int i = 0; i < numSamples; ++i)
+            fadeRamp[(size_t)i] = gain.getNextValue();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            kernels.multiplyByRamp(channels[ch], fadeRamp.data(), numSamples);
+
+        return;
+    }
+
+    if (const float g = gain.getCurrentValue(); g != 1.0f)
+        for (int ch = 0; ch < numChannels; ++ch)
+            kernels.multiply(channels[ch], g, numSamples);
+}
+
+// Mixes dryBuffer (starting at dryChannel) back into the channels, following the mix ramp (1 = all of the channels)
+void EqChain::applyCrossfade(float* const* channels, int numChannels, int numSamples, int dryChannel,
+                             juce::SmoothedValue<float>& mix)
+{
+    for (int i = 0; i < numSamples; ++i)
+        fadeRamp[(size_t)i] = mix.getNextValue();
+
+    const int numCh = juce::jmin(numChannels, dryBuffer.getNumChannels() - dryChannel);
+    const auto& kernels = DspKernels::get();
+
+    for (int ch = 0; ch < numCh; ++ch)
+        kernels.crossfade(channels[ch], dryBuffer.getReadPointer(dryChannel + ch), fadeRamp.data(), numSamples);
+}
+
+void EqChain::resetFilterState()
+{
+    for (auto& chain : channelFilters)
+    {
+        for (auto& f : chain.hpf) f.reset();
+        for (auto& f : chain.lpf) f.reset();
+        for (auto& f : chain.peaks) f.reset();
+        chain.graphic = {};
+    }
+
+    for (auto& chain : fixedFilters)
+        chain = {};
+
+    for (auto& chain : lowBandFilters)
+        chain = {};
+    multirate.resetLowBand();
+}
+
+void EqChain::processFilters(float* const* channels, int numChannels, int numSamples)
+{
+    EQ_TRACE_SCOPE("filters");
+    const TelemetryPublisher::StageScope stageTime(telemetry, Telemetry::filtersStage);
+    const int numCh = juce::jmin(numChannels, (int)channelFilters.size());
+
+    // Channels are independent, so wide layouts split into channel groups across the worker pool
+    if (workerPool.getNumWorkers() > 0 && numCh >= workerPoolOptions.channelThreshold)
+    {
+        parallelChannels = channels;
+        parallelNumChannels = numCh;
+        parallelNumSamples = numSamples;
+
+        const int numGroups = (numCh + workerPoolOptions.channelsPerTask - 1) / workerPoolOptions.channelsPerTask;
+        workerPool.run(numGroups, &EqChain::processChannelGroup, this);
+        parallelChannels = nullptr;
+        return;
+    }
+
+    for (int ch = 0; ch < numCh; ++ch)
+        processChannelFilters(channels[ch], numSamples, ch);
+}
+
+// Worker pool task - one group of adjacent channels
+void EqChain::processChannelGroup(void* context, int groupIndex)
+{
+    // Denormal flushing is per thread - set here as well as in processChain, so a worker's channels don't stall in
+    // their tails and come out bit-identical to the ones the audio thread runs
+    juce::ScopedNoDenormals noDenormals;
+    EQ_TRACE_SCOPE("channelGroup");
+    auto& self = *static_cast<EqChain*>(context);
+    const int first = groupIndex * self.workerPoolOptions.channelsPerTask;
+    const int last = juce::jmin(first + self.workerPoolOptions.channelsPerTask, self.parallelNumChannels);
+
+    for (int ch = first; ch < last; ++ch)
+        self.processChannelFilters(self.parallelChannels[ch], self.parallelNumSamples, ch);
+}
+
+// HPF -> peaks -> LPF for a single channel (sections are mono)
+void EqChain::processChannelFilters(float* data, int numSamples, int ch)
+{
+    if (engine == Engine::fixedPoint)
+    {
+        processChannelFixed(data, numSamples, ch);
+        return;
+    }
+
+    auto& chain = channelFilters[(size_t)ch];
+
+    // Sections in the multirate low band first - their change is worked out from the block as split
+    if (multirate.isLowBandInUse())
+        processLowBand(data, numSamples, ch);
+
+    // HPF cascade (mono)
+    if (curSnap.hpfEnabled && !lowBand.hpf)
+        for (int s = 0; s < curSnap.hpfStages; ++s)
+            chain.hpf[s].process(hpfSection, data, numSamples);
+
+    // Graphic bank in one pipelined pass, or the peaking bands - 0 dB peaks are an exact identity, so they're skipped
+    if (curSnap.graphicMode)
+    {
+        if (!isGraphicFlat(curSnap))
+            DspKernels::get().graphicBank(graphicBank, chain.graphic, data, numSamples);
+    }
+    else
+    {
+        for (int b = 0; b < maxEqBands; ++b)
+            if (curSnap.bands[b].enabled && curSnap.bands[b].gainDb != 0.0f && !lowBand.peaks[b])
+                chain.peaks[b].process(peakSections[b], data, numSamples);
+    }
+
+    // LPF cascade (mono)
+    if (curSnap.lpfEnabled)
+        for (int s = 0; s < curSnap.lpfStages; ++s)
+            chain.lpf[s].process(lpfSection, data, numSamples);
+}
+
+// Runs the moved sections over a copy of the channel's low band and adds what they changed back in at the full rate
+void EqChain::processLowBand(float* data, int numSamples, int ch)
+{
+    const auto low = multirate.getLowBand(ch);
+    const auto change = multirate.getChangeBuffer(ch);
+    const int numLow = (int)low.size();
+    auto& filters = lowBandFilters[(size_t)ch];
+
+    std::copy(low.begin(), low.end(), change.begin());
+
+    if (lowBand.hpf)
+        for (int s = 0; s < curSnap.hpfStages; ++s)
+            filters.hpf[s].process(lowHpfSection, change.data(), numLow);
+
+    for (int b = 0; b < maxEqBands; ++b)
+        if (lowBand.peaks[b])
+            filters.peaks[b].process(lowPeakSections[b], change.data(), numLow);
+
+    for (int i = 0; i < numLow; ++i)
+        change[(size_t)i] -= low[(size_t)i];
+
+    multirate.addChange(ch, data, numSamples);
+}
+
+// The fixed-point engine's chain - float only at the ends, Q31 in between. The graphic bands run one section
+// at a time; skipping 0 dB bands matches the float path's skipped peaks.
+void EqChain::processChannelFixed(float* data, int numSamples, int ch)
+{
+    auto& chain = fixedFilters[(size_t)ch];
+    juce::int32* fixed = fixedScratch.data() + (size_t)ch * (size_t)preparedBlockSize;
+
+    FixedPointSection::toFixed(data, fixed, numSamples);
+
+    if (curSnap.hpfEnabled)
+        for (int s = 0; s < curSnap.hpfStages; ++s)
+            chain.hpf[s].process(fixedHpf, fixed, numSamples);
+
+    if (curSnap.graphicMode)
+    {
+        for (int b = 0; b < GraphicEq::getNumBands(curSnap.graphicLayout); ++b)
+            if (curSnap.graphicGainsDb[(size_t)b] != 0.0f)
+                chain.graphic[(size_t)b].process(fixedGraphic[(size_t)b], fixed, numSamples);
+    }
+    else
+    {
+        for (int b = 0; b < maxEqBands; ++b)
+            if (curSnap.bands[b].enabled && curSnap.bands[b].gainDb != 0.0f)
+                chain.peaks[b].process(fixedPeaks[b], fixed, numSamples);
+    }
+
+    if (curSnap.lpfEnabled)
+        for (int s = 0; s < curSnap.lpfStages; ++s)
+            chain.lpf[s].process(fixedLpf, fixed, numSamples);
+
+    FixedPointSection::toFloat(fixed, data, numSamples);
+}
+
+// Everything the filter sections are built from - the settings apart from the gains and the limiter
+static void copySections(const EqChain::Settings& from, EqChain::Settings& to)
+{
+    to.hpfEnabled = from.hpfEnabled;
+    to.hpfStages = from.hpfStages;
+    to.hpfFreqHz = from.hpfFreqHz;
+    to.hpfIndex = from.hpfIndex;
+    to.lpfEnabled = from.lpfEnabled;
+    to.lpfStages = from.lpfStages;
+    to.lpfFreqHz = from.lpfFreqHz;
+    to.lpfIndex = from.lpfIndex;
+    to.bands = from.bands;
+    to.graphicMode = from.graphicMode;
+    to.graphicLayout = from.graphicLayout;
+    to.graphicQMode = from.graphicQMode;
+    to.graphicGainsDb = from.graphicGainsDb;
+}
+
+void EqChain::applySettings()
+{
+    EQ_TRACE_SCOPE("applySettings");
+    auto snap = pendingSettings;
+
+    // A curve going flat fades out on the sections it had - the flat settings already skip the outgoing ones, so
+    // there'd be nothing to fade from. They're held until the fade reaches the dry signal, then applied.
+    const bool goingFlat = isChainFlat(pendingSettings);
+    filterMix.setTargetValue(goingFlat ? 0.0f : 1.0f);
+
+    if (goingFlat && filterMix.getCurrentValue() > 0.0f)
+        copySections(lastSnap, snap);
+
+    // Change detection - only the sections whose own values moved are rebuilt
+    bool redesign = false;
+    auto markDirty = [&redesign](std::atomic<bool>& flag)
+        {
+            flag.store(true);
+            redesign = true;
+        };
+
+    if (snap.hpfEnabled != lastSnap.hpfEnabled || snap.hpfFreqHz != lastSnap.hpfFreqHz || snap.hpfStages != lastSnap.hpfStages || snap.hpfIndex != lastSnap.hpfIndex)
+        markDirty(dirty.hpf);
+    if (snap.lpfEnabled != lastSnap.lpfEnabled || snap.lpfFreqHz != lastSnap.lpfFreqHz || snap.lpfStages != lastSnap.lpfStages || snap.lpfIndex != lastSnap.lpfIndex)
+        markDirty(dirty.lpf);
+
+    for (int b = 0; b < maxEqBands; ++b)
+    {
+        const auto& a = snap.bands[b];
+        const auto& z = lastSnap.bands[b];
+        if (a.enabled != z.enabled || a.freqHz != z.freqHz || a.q != z.q || a.gainDb != z.gainDb)
+            markDirty(dirty.peak[b]);
+    }
+
+    if (snap.graphicMode != lastSnap.graphicMode || snap.graphicLayout != lastSnap.graphicLayout
+        || snap.graphicQMode != lastSnap.graphicQMode || snap.graphicGainsDb != lastSnap.graphicGainsDb)
+        markDirty(dirty.graphic);
+
+    if (redesign)
+        samplesSinceRedesign = 0;
+
+    curSnap = snap;
+    lastSnap = snap;
+}
+
+int EqChain::getEffectiveTiers() const
+{
+    int tiers = 1 << CpuGovernor::full;
+
+    if (curSnap.limiterEnabled && curSnap.limiterTruePeak)
+        tiers |= 1 << CpuGovernor::noOversampling;
+    if (samplesSinceRedesign < redesignHoldSamples)
+        tiers |= 1 << CpuGovernor::coarseUpdates;
+
+    return tiers;
+}
+
+// Float section coefficients for the audio path, in whichever topology suits the design
+// Returns true if the topology changed - that section's state is then meaningless and must be cleared
+bool EqChain::updateSection(FilterSection::Coefficients& section, const FilterSection::Design& design)
+{
+    const auto mode = (FilterSection::TopologyMode)topologyMode.load();
+    const auto topology = FilterSection::chooseTopology(design, mode, section.topology);
+    const bool changed = topology != section.topology;
+
+    section = FilterSection::makeCoefficients(design, topology, blockFilters);
+    return changed;
+}
+
+void EqChain::setFilterTopologyMode(FilterSection::TopologyMode mode)
+{
+    topologyMode.store((int)mode);
+
+    dirty.hpf.store(true);
+    dirty.lpf.store(true);
+    for (auto& d : dirty.peak) d.store(true);
+}
+
+static FixedPointSection::Coefficients quantiseDesign(const FilterSection::Design& design)
+{
+    double coeffs[5];
+    FilterSection::makeDoubleCoefficients(design, coeffs);
+    return FixedPointSection::quantise(coeffs);
+}
+
+// Coefficients are plain values computed in place - nothing is allocated or freed here
+void EqChain::updateDirtyFilters()
+{
+    EQ_TRACE_SCOPE("updateDirtyFilters");
+    bool anyRebuilt = false;
+
+    if (dirty.hpf.exchange(false))
+    {
+        anyRebuilt = true;
+
+        if (updateSection(hpfSection, EqDesign::hpfDesign(curSnap, currentSampleRate)))
+            for (auto& chain : channelFilters)
+                for (auto& f : chain.hpf) f.reset();
+
+        if (engine == Engine::fixedPoint)
+            fixedHpf = quantiseDesign(EqDesign::hpfDesign(curSnap, currentSampleRate));
+    }
+
+    if (dirty.lpf.exchange(false))
+    {
+        anyRebuilt = true;
+
+        if (updateSection(lpfSection, EqDesign::lpfDesign(curSnap, currentSampleRate)))
+            for (auto& chain : channelFilters)
+                for (auto& f : chain.lpf) f.reset();
+
+        if (engine == Engine::fixedPoint)
+            fixedLpf = quantiseDesign(EqDesign::lpfDesign(curSnap, currentSampleRate));
+    }
+
+    // EQ bands
+    for (int b = 0; b < maxEqBands; ++b)
+    {
+        if (!dirty.peak[b].exchange(false)) continue;
+        anyRebuilt = true;
+
+        const auto& band = curSnap.bands[b];
+        if (!band.enabled)
+            continue;
+
+        if (updateSection(peakSections[b], EqDesign::peakDesign(band, currentSampleRate)))
+            for (auto& chain : channelFilters)
+                chain.peaks[b].reset();
+
+        if (engine == Engine::fixedPoint)
+            fixedPeaks[b] = quantiseDesign(EqDesign::peakDesign(band, currentSampleRate));
+    }
+
+    if (dirty.graphic.exchange(false))
+    {
+        anyRebuilt = true;
+
+        // Lanes move around between layouts, and a mode switch leaves the other path's state stale
+        const int lanesBefore = graphicBank.numLanes;
+        graphicDesign.makeBank(curSnap.graphicLayout, curSnap.graphicQMode, curSnap.graphicGainsDb.data(), graphicBank);
+
+        if (graphicBank.numLanes != lanesBefore || curSnap.graphicMode != graphicModeApplied)
+        {
+            for (auto& chain : channelFilters)
+            {
+                chain.graphic = {};
+                for (auto& f : chain.peaks) f.reset();
+            }
+
+            for (auto& chain : fixedFilters)
+                chain = {};
+        }
+
+        if (engine == Engine::fixedPoint)
+        {
+            double graphic[GraphicEq::maxBands][5];
+            graphicDesign.makeCoefficients(curSnap.graphicLayout, curSnap.graphicQMode, curSnap.graphicGainsDb.data(), graphic);
+
+            for (int b = 0; b < GraphicEq::getNumBands(curSnap.graphicLayout); ++b)
+                fixedGraphic[(size_t)b] = FixedPointSection::quantise(graphic[b]);
+        }
+
+        graphicModeApplied = curSnap.graphicMode;
+    }
+
+    if (anyRebuilt)
+    {
+        if (multirate.isActive())
+            updateLowBand();
+
+        updateTailLength();
+        responseVersion.fetch_add(1, std::memory_order_release);
+    }
+}
+
+// The HPF and then the bands, in order, move to the low band while the summed deviation they'd leave above its
+// passband edge stays within budget - the sections already there get the same hysteresis as the topology choice,
+// so automation doesn't flip one back and forth. A section that moves either way starts from a clean state.
+void EqChain::updateLowBand()
+{
+    const double lowRate = multirate.getLowRate();
+    const double edge = multirate.getPassbandEdgeHz();
+    double budget = MultirateSplit::maxDeviation;
+    LowBandSections next;
+
+    auto fits = [&](const FilterSection::Design& design, int numStages, bool moved)
+        {
+            if (design.freqHz >= edge)
+                return false;
+
+            double coeffs[5];
+            FilterSection::makeDoubleCoefficients(design, coeffs);
+            const double d = numStages * MultirateSplit::deviation(coeffs, edge, lowRate);
+
+            if (d > budget * (moved ? FilterSection::hysteresis : 1.0))
+                return false;
+
+            budget = juce::jmax(0.0, budget - d);
+            return true;
+        };
+
+    if (curSnap.hpfEnabled)
+        next.hpf = fits(EqDesign::hpfDesign(curSnap, lowRate), curSnap.hpfStages, lowBand.hpf);
+
+    if (!curSnap.graphicMode)
+        for (int b = 0; b < maxEqBands; ++b)
+            if (curSnap.bands[b].enabled && curSnap.bands[b].gainDb != 0.0f)
+                next.peaks[b] = fits(EqDesign::peakDesign(curSnap.bands[b], lowRate), 1, lowBand.peaks[b]);
+
+    if (next.hpf)
+    {
+        ++next.count;
+        if (updateSection(lowHpfSection, EqDesign::hpfDesign(curSnap, lowRate)) || !lowBand.hpf)
+            for (auto& filters : lowBandFilters)
+                for (auto& f : filters.hpf) f.reset();
+    }
+
+    if (next.hpf != lowBand.hpf)
+        for (auto& chain : channelFilters)
+            for (auto& f : chain.hpf) f.reset();
+
+    for (int b = 0; b < maxEqBands; ++b)
+    {
+        if (next.peaks[b])
+        {
+            ++next.count;
+            if (updateSection(lowPeakSections[b], EqDesign::peakDesign(curSnap.bands[b], lowRate)) || !lowBand.peaks[b])
+                for (auto& filters : lowBandFilters)
+                    filters.peaks[b].reset();
+        }
+
+        if (next.peaks[b] != lowBand.peaks[b])
+            for (auto& chain : channelFilters)
+                chain.peaks[b].reset();
+    }
+
+    lowBand = next;
+    multirate.setLowBandInUse(lowBand.count > 0);
+}
+
+// Samples for one section's impulse response to decay to silenceThreshold, from its largest pole radius
+// (coeffs are { b0, b1, b2, a1, a2 }; first-order sections have a2 = 0, leaving the single pole at -a1)
+int EqChain::decaySamplesForSection(const double (&coeffs)[5])
+{
+    const double a1 = coeffs[3], a2 = coeffs[4];
+    const double disc = a1 * a1 - 4.0 * a2;
+    double radius = 0.0;
+
+    if (disc < 0.0)
+        radius = std::sqrt(a2); // Complex pair, |p|^2 = a2
+    else
+        radius = juce::jmax(std::abs(-a1 + std::sqrt(disc)), std::abs(-a1 - std::sqrt(disc))) * 0.5;
+
+    if (radius < 1.0e-9)
+        return 1;
+
+    if (radius >= 1.0)
+        return std::numeric_limits<int>::max(); // Marginally stable - never decays
+
+    return (int)std::ceil(std::log((double)silenceThreshold) / std::log(radius));
+}
+
+// Cascaded decays overlap, so summing each active section's decay is a safe upper bound for the whole chain
+void EqChain::updateTailLength()
+{
+    const double maxTailSamples = maxTailSeconds * currentSampleRate;
+    double total = 0.0;
+
+    auto add = [&total](const FilterSection::Design& design, int count)
+        {
+            double c[5];
+            FilterSection::makeDoubleCoefficients(design, c);
+            total += (double)count * (double)decaySamplesForSection(c);
+        };
+
+    if (curSnap.hpfEnabled)
+        add(EqDesign::hpfDesign(curSnap, currentSampleRate), curSnap.hpfStages);
+
+    if (curSnap.graphicMode)
+    {
+        double graphic[GraphicEq::maxBands][5];
+        graphicDesign.makeCoefficients(curSnap.graphicLayout, curSnap.graphicQMode, curSnap.graphicGainsDb.data(), graphic);
+
+        for (int b = 0; b < GraphicEq::getNumBands(curSnap.graphicLayout); ++b)
+            if (curSnap.graphicGainsDb[(size_t)b] != 0.0f)
+                total += (double)decaySamplesForSection(graphic[b]);
+    }
+    else
+    {
+        for (int b = 0; b < maxEqBands; ++b)
+            if (curSnap.bands[b].enabled && curSnap.bands[b].gainDb != 0.0f)
+                add(EqDesign::peakDesign(curSnap.bands[b], currentSampleRate), 1);
+    }
+
+    if (curSnap.lpfEnabled)
+        add(EqDesign::lpfDesign(curSnap, currentSampleRate), curSnap.lpfStages);
+
+    tailSamples = (int)juce::jmin(total, maxTailSamples);
+    tailSeconds.store((double)tailSamples / currentSampleRate);
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <span>
+#include "ChannelWorkerPool.h"
+#include "CpuGovernor.h"
+#include "DspArena.h"
+#include "DspKernels.h"
+#include "EqDesign.h"
+#include "FilterSection.h"
+#include "FixedPointSection.h"
+#include "GraphicEq.h"
+#include "Limiter.h"
+#include "MultirateSplit.h"
+#include "Telemetry.h"
+
+/**
+ * The plugin's whole audio path, with no processor, plugin-client or GUI code: input gain -> HPF -> peaks or the
+ * graphic bank -> LPF -> output gain -> limiter, with the bypass and flat-curve crossfades, sleep on silence and
+ * the float/fixed-point, multirate, block-filter and worker-pool variants. JuceEQAudioProcessor runs one per
+ * instance from its parameters; the embedding API (JuceEQ.h) runs one per engine from the caller's settings.
+ * Every channel is filtered as its own mono chain with the shared coefficients; all per-channel state lives in one
+ * DspArena block laid out in prepare(). Nothing locks or allocates after prepare(); process() takes any block
+ * length and splits ones longer than prepared.
+ * Settings, the quality tier and process() belong to one thread (the audio thread, between blocks). The options
+ * (engine, multirate, block filters, worker pool) are applied at the next prepare().
+ */
+class EqChain
+{
+public:
+    using Settings = EqDesign::ChainSettings;
+
+    static constexpr int maxChannels = 64;
+    static constexpr int maxFilterStages = 4;
+
+    // Float sections, or the integer engine for targets without a fast FPU (see FixedPointSection.h) - the default
+    // is the build's (JUCEEQ_FIXED_POINT)
+    enum class Engine { floatingPoint, fixedPoint };
+
+    // Block state-space float sections (see FilterSection.h) for mono and dual-mono layouts. automatic uses them
+    // when FilterSection::isBlockProcessingFaster() says so for the prepared block size; on forces them.
+    enum class BlockFilters { automatic, on, off };
+
+    // Splitting wide channel layouts over worker threads
+    struct WorkerPoolOptions
+    {
+        bool enabled = true;
+        int channelThreshold = 8; // Only layouts at least this wide use the pool
+        int channelsPerTask = 4;
+        int maxWorkers = 3; // Threads are shared by every instance, up to the largest maxWorkers asked for; the audio thread takes tasks too
+    };
+
+    EqChain() = default;
+
+    // ----- Options, applied at the next prepare() -----
+    void setEngine(Engine e) { requestedEngine = e; }
+    Engine getEngine() const { return requestedEngine; }
+
+    // Runs the low HPF and peak sections at a reduced rate from 88.2 kHz up (see MultirateSplit.h), float engine only
+    void setMultirateEnabled(bool shouldBeEnabled) { requestedMultirate = shouldBeEnabled; }
+    bool isMultirateEnabled() const { return requestedMultirate; }
+
+    void setBlockFilters(BlockFilters mode) { requestedBlockFilters = mode; }
+    BlockFilters getBlockFilters() const { return requestedBlockFilters; }
+
+    // What prepare() will settle blockFilters to for this layout - for recording it before the prepare
+    bool willUseBlockFilters(int numChannels, int maxBlockSize) const;
+
+    void setWorkerPoolOptions(const WorkerPoolOptions& options) { workerPoolOptions = options; }
+
+    // Direct form / SVF per section - any thread, takes effect at the next settings update
+    void setFilterTopologyMode(FilterSection::TopologyMode mode);
+    FilterSection::TopologyMode getFilterTopologyMode() const { return (FilterSection::TopologyMode)topologyMode.load(); }
+
+    // ----- Audio -----
+
+    // Not real-time safe. Lays out the state for up to maxChannels channels and designs the filters from the
+    // settings given so far. False if the state can't be allocated - process() then leaves the audio untouched.
+    bool prepare(double sampleRate, int maxBlockSize, int numChannels, bool bypassed);
+    void stop(); // Releases the worker pool's threads (releaseResources)
+
+    // Audio thread, between blocks. Sections are redesigned only where the values changed, at the start of the next
+    // block (or at the control rate from the coarseUpdates tier); gains ramp to new values over 20 ms.
+    void setSettings(const Settings& settings) { pendingSettings = settings; }
+    void jumpGainsToSettings(); // The gains start at the settings' values instead of ramping to them
+
+    // CpuGovernor tier to run at (see CpuGovernor.h) - audio thread, between blocks
+    void setQualityTier(int tier) { qualityTier = tier; }
+
+    // The tiers that would shed work at the current settings, as bits (1 << tier) - full is always one of them.
+    // noOversampling needs the true-peak limiter on, coarseUpdates a section redesigned within the last second.
+    int getEffectiveTiers() const;
+
+    // In place; a bypassed block fades to the (latency-aligned) input and then passes it straight through
+    void process(float* const* channels, int numChannels, int numSamples, bool bypassed);
+
+    void reset(); // Clears the filter, limiter and multirate states - audio thread, between blocks
+
+    // Where stage times go (null for none) - set before processing, not during it
+    void setTelemetry(TelemetryPublisher* publisher) { telemetry = publisher; }
+
+    // ----- State, after prepare() -----
+    bool isPrepared() const { return prepared; }
+    const Settings& getSettings() const { return curSnap; } // As last applied - audio thread
+    int getLatencySamples() const { return latencySamples.load(std::memory_order_relaxed); } // Any thread
+    double getTailSeconds() const { return tailSeconds.load(); } // Any thread
+    juce::uint32 getResponseVersion() const { return responseVersion.load(std::memory_order_acquire); } // Any thread
+    float getGainReductionDb() const { return limiter.getGainReductionDb(); }
+
+    Engine getPreparedEngine() const { return engine; }
+    bool isUsingBlockFilters() const { return blockFilters; }
+    bool isMultirateActive() const { return multirate.isActive(); }
+    bool isSleeping() const { return sleeping; }
+    bool areFiltersEngaged() const { return filtersEngaged; }
+
+    ChannelWorkerPool::Stats getWorkerPoolStats() const { return workerPool.getStats(); }
+    size_t getDspStateBytes() const { return dspArena.getBytes(); }
+
+    // The filter chain is an exact identity - nothing enabled, or only 0 dB peaks (or graphic sliders)
+    static bool isChainFlat(const Settings& settings);
+    static bool isGraphicFlat(const Settings& settings);
+
+private:
+    using BandSettings = EqDesign::BandSettings;
+
+    // Only rebuild changed filters on the audio thread
+    struct DirtyFlags
+    {
+        std::atomic<bool> hpf{ true };
+        std::atomic<bool> lpf{ true };
+        std::array<std::atomic<bool>, EqConstants::maxEqBands> peak{};
+        std::atomic<bool> graphic{ true };
+    } dirty;
+
+    Settings pendingSettings; // As last set
+    Settings curSnap, lastSnap; // As applied, and the baseline for spotting changes
+
+    void applySettings(); // pendingSettings -> curSnap, flagging what changed (sections held while fading to flat)
+    void updateDirtyFilters(); // rebuilds coeffs if they're set as dirty
+
+    void processChain(float* const* channels, int numChannels, int numSamples, bool bypassed); // Up to the prepared size
+    void processFilters(float* const* channels, int numChannels, int numSamples); // HPF -> peaks -> LPF, in place
+    void processChannelFilters(float* data, int numSamples, int ch);
+    void processChannelFixed(float* data, int numSamples, int ch); // The same chain in Q31
+    void processLowBand(float* data, int numSamples, int ch); // The sections moved to the multirate low band
+    static void processChannelGroup(void* context, int groupIndex);
+    void applyGain(float* const* channels, int numChannels, int numSamples, juce::SmoothedValue<float>& gain, float gainDb);
+    void applyCrossfade(float* const* channels, int numChannels, int numSamples, int dryChannel, juce::SmoothedValue<float>& mix);
+    void resetFilterState();
+    static bool isSilent(const float* const* channels, int numChannels, int numSamples, float threshold);
+    void updateLimiter();
+
+    // Tail length - recomputed from the pole radii whenever coefficients are rebuilt
+    static int decaySamplesForSection(const double (&coeffs)[5]);
+    void updateTailLength();
+
+    bool updateSection(FilterSection::Coefficients& section, const FilterSection::Design& design);
+    void updateLowBand(); // Picks the sections the multirate low band takes and designs them at its rate
+
+    bool prepared = false;
+    double currentSampleRate = 44100.0;
+    int preparedBlockSize = 1;
+
+    // Linear gain with 20 ms linear ramps (as dsp::Gain does it), applied a channel at a time by the kernels
+    static constexpr double gainRampSeconds = 0.02;
+    juce::SmoothedValue<float> inputGain;
+    juce::SmoothedValue<float> outputGain;
+
+    // Governor tiers - at coarseUpdates, settings are applied every coarseUpdateSeconds rather than every block
+    static constexpr double coarseUpdateSeconds = 0.02;
+    int qualityTier = CpuGovernor::full;
+    int coarseUpdateSamples = 1;
+    int samplesSinceSnapshot = 0;
+    static constexpr double redesignHoldSeconds = 1.0; // How long after a redesign coarseUpdates still counts
+    int redesignHoldSamples = 1;
+    int samplesSinceRedesign = std::numeric_limits<int>::max();
+
+    // Bypass and flat-curve fast path
+    // Both skip the filters entirely once faded, keeping their state for when they re-engage; the crossfades use
+    // buffers sized in prepare
+    static constexpr double crossfadeSeconds = 0.01;
+    juce::SmoothedValue<float> bypassMix{ 1.0f }; // 1 -> processed, 0 -> untouched input
+    juce::SmoothedValue<float> filterMix{ 1.0f }; // 1 -> filtered, 0 -> filters skipped (flat curve)
+    bool filtersEngaged = true;
+    juce::AudioBuffer<float> dryBuffer; // Refers into dspArena
+    std::span<float> fadeRamp;
+
+    // Output limiter - lookahead (and true-peak detection) is reported as latency
+    LookaheadLimiter limiter;
+    LookaheadLimiter::Settings limiterSettings;
+    bool limiterWasEnabled = false;
+    std::atomic<int> latencySamples{ 0 }; // What the chain runs at
+
+    // Tail reporting and sleep mode
+    static constexpr float silenceThreshold = 1.0e-6f; // -120 dB
+    static constexpr double maxTailSeconds = 60.0;
+    std::atomic<double> tailSeconds{ 0.0 };
+    int tailSamples = 0;
+    int silentSamples = 0; // Consecutive silent input samples
+    bool outputDecayed = false;
+    bool sleeping = false;
+
+    std::atomic<juce::uint32> responseVersion{ 0 };
+
+    // Float sections for the audio path, one set of coefficients per filter
+    // HPF and LPF slopes use "cascades" - the same section chained up to maxFilterStages times for steeper slopes
+    std::atomic<int> topologyMode{ (int)FilterSection::TopologyMode::automatic };
+    FilterSection::Coefficients hpfSection, lpfSection;
+    std::array<FilterSection::Coefficients, EqConstants::maxEqBands> peakSections{};
+    BlockFilters requestedBlockFilters = BlockFilters::automatic;
+    bool blockFilters = false; // As prepared - every section is built with its block form too
+
+    // Graphic bank - designs precomputed for the prepared rate, coefficients rebuilt when a slider moves
+    GraphicEq graphicDesign;
+    DspKernels::GraphicBankCoefficients graphicBank;
+    bool graphicModeApplied = false; // Mode the filter states belong to
+
+    // One mono filter chain per channel, all sharing the section coefficients above
+    struct ChannelFilters
+    {
+        std::array<FilterSection, maxFilterStages> hpf{};
+        std::array<FilterSection, maxFilterStages> lpf{};
+        std::array<FilterSection, EqConstants::maxEqBands> peaks{};
+        DspKernels::GraphicBankState graphic{};
+    };
+    std::span<ChannelFilters> channelFilters; // In dspArena
+
+    // Fixed-point engine - integer versions of the same designs, rebuilt alongside the float ones while it's in use
+    Engine requestedEngine = JUCEEQ_FIXED_POINT ? Engine::fixedPoint : Engine::floatingPoint; // The build's default
+    Engine engine = Engine::floatingPoint; // As prepared
+    FixedPointSection::Coefficients fixedHpf, fixedLpf;
+    std::array<FixedPointSection::Coefficients, EqConstants::maxEqBands> fixedPeaks{};
+    std::array<FixedPointSection::Coefficients, GraphicEq::maxBands> fixedGraphic{};
+
+    struct FixedChannelFilters
+    {
+        std::array<FixedPointSection, maxFilterStages> hpf{};
+        std::array<FixedPointSection, maxFilterStages> lpf{};
+        std::array<FixedPointSection, EqConstants::maxEqBands> peaks{};
+        std::array<FixedPointSection, GraphicEq::maxBands> graphic{};
+    };
+    std::span<FixedChannelFilters> fixedFilters; // In dspArena, only when the engine is fixed
+    std::span<juce::int32> fixedScratch; // One prepared block per channel
+
+    // Multirate low band - which sections run there instead of at the full rate, their low-rate coefficients
+    // and per-channel states
+    bool requestedMultirate = false;
+    MultirateSplit multirate;
+
+    struct LowBandSections
+    {
+        bool hpf = false;
+        std::array<bool, EqConstants::maxEqBands> peaks{};
+        int count = 0;
+    };
+    LowBandSections lowBand;
+    FilterSection::Coefficients lowHpfSection;
+    std::array<FilterSection::Coefficients, EqConstants::maxEqBands> lowPeakSections{};
+
+    struct LowBandFilters
+    {
+        std::array<FilterSection, maxFilterStages> hpf{};
+        std::array<FilterSection, EqConstants::maxEqBands> peaks{};
+    };
+    std::span<LowBandFilters> lowBandFilters; // In dspArena, only when the split is active
+
+    // Filter states, dry/fade buffers and limiter buffers - one aligned block per chain, laid out in prepare
+    DspArena dspArena;
+
+    WorkerPoolOptions workerPoolOptions;
+    ChannelWorkerPool workerPool;
+
+    // Block being split across the pool
+    float* const* parallelChannels = nullptr;
+    int parallelNumChannels = 0;
+    int parallelNumSamples = 0;
+
+    TelemetryPublisher* telemetry = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EqChain)
+};
@@ -0,0 +1,91 @@
+#include "EqDesign.h"
+
+using namespace EqConstants;
+
+int EqDesign::numStagesForSlopeIndex(int slopeIndex)
+{
+    if (slopeIndex <= 1)
+        return 1; // 6 or 12 dB -> 1 stage
+
+    return 1 << (slopeIndex - 1);  // 24 -> 2 stages, 48 -> 4 stages
+}
+
+// Parameter range, then held just below Nyquist (as GraphicEq does) - 20 kHz is past it at low rates, where the
+// bilinear prewarp would blow up
+static double designFreq(float freqHz, double sampleRate)
+{
+    return juce::jmin((double)juce::jlimit(minEqFreq, maxEqFreq, freqHz), 0.49 * sampleRate);
+}
+
+FilterSection::Design EqDesign::hpfDesign(const ChainSettings& settings, double sampleRate)
+{
+    const bool firstOrder = (settings.hpfIndex == 0); // 6 dB -> 1st order
+    return { firstOrder ? FilterSection::Shape::firstOrderHighPass : FilterSection::Shape::highPass,
+        sampleRate, designFreq(settings.hpfFreqHz, sampleRate), butterworthQ, 0.0 };
+}
+
+FilterSection::Design EqDesign::lpfDesign(const ChainSettings& settings, double sampleRate)
+{
+    const bool firstOrder = (settings.lpfIndex == 0); // 6 dB -> 1st order
+    return { firstOrder ? FilterSection::Shape::firstOrderLowPass : FilterSection::Shape::lowPass,
+        sampleRate, designFreq(settings.lpfFreqHz, sampleRate), butterworthQ, 0.0 };
+}
+
+FilterSection::Design EqDesign::peakDesign(const BandSettings& band, double sampleRate)
+{
+    return { FilterSection::Shape::peak, sampleRate,
+        designFreq(band.freqHz, sampleRate), (double)juce::jlimit(eqMinQ, eqMaxQ, band.q),
+        (double)juce::jlimit(minEqGainDb, maxEqGainDb, band.gainDb) };
+}
+
+void EqDesign::getFrequencyResponse(const ChainSettings& settings, double sampleRate,
+                                    const double* freqs, double* magnitudes, int numFreqs)
+{
+    // HPF cascade, peaks, LPF cascade - each section's coefficients once, with how many times it's chained
+    constexpr int maxSections = juce::jmax(maxEqBands, GraphicEq::maxBands) + 2;
+    double coeffs[maxSections][5];
+    int counts[maxSections];
+    int numSections = 0;
+
+    auto add = [&coeffs, &counts, &numSections](const FilterSection::Design& design, int count)
+        {
+            FilterSection::makeDoubleCoefficients(design, coeffs[numSections]);
+            counts[numSections++] = count;
+        };
+
+    if (settings.hpfEnabled)
+        add(hpfDesign(settings, sampleRate), settings.hpfStages);
+
+    if (settings.graphicMode)
+    {
+        const GraphicEq design(sampleRate);
+        const int numBands = GraphicEq::getNumBands(settings.graphicLayout);
+        design.makeCoefficients(settings.graphicLayout, settings.graphicQMode, settings.graphicGainsDb.data(), coeffs + numSections);
+
+        for (int b = 0; b < numBands; ++b)
+            counts[numSections++] = 1;
+    }
+    else
+    {
+        for (int b = 0; b < maxEqBands; ++b)
+            if (settings.bands[(size_t)b].enabled)
+                add(peakDesign(settings.bands[(size_t)b], sampleRate), 1);
+    }
+
+    if (settings.lpfEnabled)
+        add(lpfDesign(settings, sampleRate), settings.lpfStages);
+
+    // Clamped a chunk at a time into a stack buffer, then every section is evaluated over the chunk at once
+    const auto& kernels = DspKernels::get();
+    constexpr int chunk = 256;
+    double clamped[chunk];
+
+    for (int start = 0; start < numFreqs; start += chunk)
+    {
+        const int n = juce::jmin(chunk, numFreqs - start);
+        for (int i = 0; i < n; ++i)
+            clamped[i] = juce::jlimit<double>(minEqFreq, maxEqFreq, freqs[start + i]);
+
+        kernels.responseMagnitudes(coeffs, counts, numSections, clamped, magnitudes + start, n, sampleRate);
+    }
+}
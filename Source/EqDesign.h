@@ -0,0 +1,84 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include "FilterSection.h"
+#include "GraphicEq.h"
+
+namespace EqConstants
+{
+    constexpr int maxEqBands = 8; // Default is 3, max is 8
+
+    // min and max freq for all freq knobs
+    constexpr float minEqFreq = 10.0f;
+    constexpr float maxEqFreq = 20000.0f;
+
+    // min and max gain for EQ bands
+    constexpr float minEqGainDb = -30.0f;
+    constexpr float maxEqGainDb = +30.0f;
+
+    // min and max Q for EQ bands
+    constexpr float eqMinQ = 0.10f;
+    constexpr float eqMaxQ = 40.0f;
+}
+
+/**
+ * The EQ's settings and what they design to - the part of the chain that's plain values and maths, shared by
+ * EqChain (the audio path of both the plugin and the embedding API, JuceEQ.h) and StripBank. Nothing here needs a
+ * processor or the GUI modules, so it's all in the JuceEQDsp library.
+ */
+namespace EqDesign
+{
+    // Parameter values as the DSP sees them - the processor reads them once per block, or from a saved state
+    struct BandSettings
+    {
+        bool enabled = false;
+        float freqHz = 1000.0f;
+        float q = 2.0f;
+        float gainDb = 0.0f;
+    };
+
+    struct ChainSettings
+    {
+        float inGainDb = 0.0f;
+        float outGainDb = 0.0f;
+
+        bool hpfEnabled = false;
+        int hpfStages = 1;
+        float hpfFreqHz = 20.0f;
+        int hpfIndex = 1;
+
+        bool lpfEnabled = false;
+        int lpfStages = 1;
+        float lpfFreqHz = 20000.0f;
+        int lpfIndex = 1;
+
+        std::array<BandSettings, EqConstants::maxEqBands> bands{};
+
+        // Graphic mode swaps the peaking bands for the graphic bank (HPF/LPF stay)
+        bool graphicMode = false;
+        GraphicEq::Layout graphicLayout = GraphicEq::Layout::thirdOctave;
+        GraphicEq::QMode graphicQMode = GraphicEq::QMode::constant;
+        std::array<float, GraphicEq::maxBands> graphicGainsDb{}; // The layout's bands; the rest stay 0
+
+        bool limiterEnabled = false;
+        float limiterCeilingDb = -1.0f;
+        float limiterLookaheadMs = 5.0f;
+        float limiterReleaseMs = 100.0f;
+        bool limiterTruePeak = true;
+    };
+
+    constexpr double butterworthQ = 0.70710678118654752;
+
+    // Biquad stages per HPF/LPF slope choice (6, 12, 24, 48 dB)
+    int numStagesForSlopeIndex(int slopeIndex);
+
+    // Section designs (parameters clamped to their ranges, frequencies to 0.49x the sample rate)
+    FilterSection::Design hpfDesign(const ChainSettings& settings, double sampleRate);
+    FilterSection::Design lpfDesign(const ChainSettings& settings, double sampleRate);
+    FilterSection::Design peakDesign(const BandSettings& band, double sampleRate);
+
+    // |H| of the filter chain (HPF, peaks or graphic bank, LPF - no gains) at each frequency, any thread
+    void getFrequencyResponse(const ChainSettings& settings, double sampleRate,
+                              const double* freqs, double* magnitudes, int numFreqs);
+}
@@ -14,8 +14,23 @@ EqGraphComponent::EqGraphComponent(JuceEQAudioProcessor& proc)
     : processor(proc)
 {
     buildBaseFrequencies();
+    drawnVersion = polledVersion = processor.getResponseVersion();
     rebuildResponse();
-    startTimerHz(30); 
+
+    poller->addClient(*this);
+
+    for (auto* param : processor.getParameters())
+        param->addListener(this);
+}
+
+EqGraphComponent::~EqGraphComponent()
+{
+    for (auto* param : processor.getParameters())
+        param->removeListener(this);
+
+    poller->removeClient(*this);
+    cancelPendingUpdate();
+    vblank.reset();
 }
 
 void EqGraphComponent::resized()
@@ -27,8 +42,128 @@ void EqGraphComponent::resized()
         .withTrimmedBottom((float)bottomPad);
 }
 
-void EqGraphComponent::timerCallback()
+// ---------- Redraw scheduling ----------
+
+void EqGraphComponent::visibilityChanged()
+{
+    requestRedraw(); // Catches up on anything that changed while hidden
+}
+
+void EqGraphComponent::parentHierarchyChanged()
+{
+    requestRedraw();
+}
+
+// Off the message thread this only sets flags: triggerAsyncUpdate() posts a message, which locks and can make a
+// system call. An attached vblank sees redrawRequested on its next frame; otherwise the poller wakes us.
+void EqGraphComponent::requestRedraw()
+{
+    redrawRequested.store(true);
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        triggerAsyncUpdate();
+    else
+        markPending();
+}
+
+void EqGraphComponent::handlePendingChange()
+{
+    handleAsyncUpdate();
+}
+
+// An attached vblank compares versions itself; this catches the ones that move while it's detached
+bool EqGraphComponent::checkForChange()
+{
+    const auto version = processor.getResponseVersion();
+    if (version == polledVersion)
+        return false;
+
+    polledVersion = version;
+    redrawRequested.store(true);
+    return true;
+}
+
+// May arrive on the audio thread (host automation)
+void EqGraphComponent::parameterValueChanged(int, float)
+{
+    requestRedraw();
+}
+
+void EqGraphComponent::parameterGestureChanged(int, bool gestureIsStarting)
+{
+    activeGestures.fetch_add(gestureIsStarting ? 1 : -1);
+    requestRedraw();
+}
+
+bool EqGraphComponent::canDraw() const
+{
+    auto* peer = getPeer();
+    return peer != nullptr && !peer->isMinimised() && isShowing();
+}
+
+void EqGraphComponent::handleAsyncUpdate()
+{
+    const double now = juce::Time::getMillisecondCounterHiRes();
+    if (redrawRequested.exchange(false))
+    {
+        lastActivityMs = now;
+        rebuildPending = true;
+    }
+
+    const bool active = activeGestures.load() > 0 || now - lastActivityMs < idleTimeoutMs;
+
+    if (active && canDraw())
+    {
+        if (vblank == nullptr)
+            vblank = std::make_unique<juce::VBlankAttachment>(this, [this] { onVBlank(); });
+    }
+    else
+    {
+        vblank.reset();
+    }
+}
+
+void EqGraphComponent::onVBlank()
+{
+    EQ_TRACE_THREAD_NAME("Message");
+    EQ_TRACE_SCOPE("EqGraphComponent::onVBlank");
+
+    const double now = juce::Time::getMillisecondCounterHiRes();
+    if (redrawRequested.exchange(false))
+    {
+        lastActivityMs = now;
+        rebuildPending = true;
+    }
+
+    const bool dragging = activeGestures.load() > 0;
+
+    if (!canDraw() || (!dragging && now - lastActivityMs >= idleTimeoutMs))
+    {
+        triggerAsyncUpdate(); // Detach from handleAsyncUpdate, not from inside our own callback
+        return;
+    }
+
+    // Rebuild at the display rate while dragging, at a resting rate for automation and one-off edits
+    const auto version = processor.getResponseVersion();
+    if (version != drawnVersion)
+        rebuildPending = true;
+
+    if (!rebuildPending || (!dragging && now - lastRebuildMs < restingIntervalMs))
+        return;
+
+    rebuildPending = false;
+    drawnVersion = version;
+    lastRebuildMs = now;
+    lastActivityMs = now;
+    rebuildResponse();
+    repaint();
+}
+
+void EqGraphComponent::rebuildNow()
 {
+    rebuildPending = false;
+    drawnVersion = processor.getResponseVersion();
+    lastRebuildMs = juce::Time::getMillisecondCounterHiRes();
     rebuildResponse();
     repaint();
 }
@@ -53,6 +188,7 @@ void EqGraphComponent::buildBaseFrequencies()
 
 void EqGraphComponent::rebuildResponse()
 {
+    EQ_TRACE_SCOPE("EqGraphComponent::rebuildResponse");
     if (freqHz.empty())
         buildBaseFrequencies();
 
@@ -151,6 +287,7 @@ float EqGraphComponent::yForDb(double db, const juce::Rectangle<float>& eqGridBo
 
 void EqGraphComponent::paint(juce::Graphics& graphics)
 {
+    EQ_TRACE_SCOPE("EqGraphComponent::paint");
     const auto outsideBg = juce::Colours::black; // window background
     const auto plotBg = juce::Colour(0xFF15181A); // inner plot fill
     const auto gridCol = juce::Colour(0xFF262A2E); // grid lines
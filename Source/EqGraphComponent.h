@@ -1,6 +1,9 @@
 #pragma once
 
 #include <juce_gui_basics/juce_gui_basics.h>
+#include "MessageThreadPoller.h"
+#include <atomic>
+#include <memory>
 #include <vector>
 
 class JuceEQAudioProcessor;
@@ -9,18 +12,50 @@ class JuceEQAudioProcessor;
  * Renders the EQ filter curve and grid labels.
  * Starts with a log-spaced baseline set of EQ curve points and adds 
  * extra points around local extrema so high-Q peaks/notches are drawn accurately.
+ * Redraws are change driven: parameter changes (or requestRedraw) wake a VBlankAttachment, which rebuilds the
+ * curve after a change or when the processor's response version moves (e.g. a new sample rate), and detaches
+ * again once things go quiet or the component is hidden - an idle editor does no work at all.
+ * Changes from other threads (host automation arrives on the audio thread) only set flags: the vblank picks them up
+ * while it's attached, and the shared MessageThreadPoller wakes it when it isn't - on a flag, or on a response
+ * version it hasn't seen (a prepare with no parameter change).
  */
-class EqGraphComponent : public juce::Component, private juce::Timer
+class EqGraphComponent : public juce::Component,
+    private juce::AudioProcessorParameter::Listener,
+    private juce::AsyncUpdater,
+    private MessageThreadPoller::Client
 {
 public:
     explicit EqGraphComponent(JuceEQAudioProcessor&);
-    ~EqGraphComponent() override = default;
+    ~EqGraphComponent() override;
 
     void paint(juce::Graphics&) override;
     void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+
+    // Safe from any thread, including the audio thread - for anything else the plot shows (e.g. analyzer data arriving)
+    void requestRedraw();
+
+    // Rebuilds the curve straight away instead of on the next vblank - for offscreen rendering (JuceEQUiBench),
+    // where there's no display to drive it. Message thread only.
+    void rebuildNow();
 
 private:
     JuceEQAudioProcessor& processor;
+    juce::SharedResourcePointer<MessageThreadPoller> poller;
+
+    // Redraw scheduling
+    std::unique_ptr<juce::VBlankAttachment> vblank; // Only attached while something is changing
+    std::atomic<bool> redrawRequested{ true };
+    std::atomic<int> activeGestures{ 0 }; // Knob/slider drags in progress
+    juce::uint32 drawnVersion = 0;
+    juce::uint32 polledVersion = 0; // As last seen by checkForChange
+    bool rebuildPending = false;
+    double lastActivityMs = 0.0;
+    double lastRebuildMs = 0.0;
+
+    static constexpr double idleTimeoutMs = 500.0; // Keeps polling a little while - the audio thread applies changes a block later
+    static constexpr double restingIntervalMs = 1000.0 / 30.0; // Rebuild pacing outside of drags (drags follow the display rate)
 
     // Buffers for holding EQ curve plot points
     std::vector<double> freqHz; // Current X axis samples (Hz) are sorted in ascending order
@@ -42,7 +77,13 @@ private:
     double mergeEps = 1e-6; // Prevents duplicate points or those which are too close
 
     // Helper functions
-    void timerCallback() override;
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
+    void handleAsyncUpdate() override; // Attaches/detaches the vblank callback on the message thread
+    void handlePendingChange() override; // A change flagged off the message thread
+    bool checkForChange() override; // The response version moved with the vblank detached
+    void onVBlank();
+    bool canDraw() const; // Showing and not minimised
     void buildBaseFrequencies(); // Build freqHz with baseline log spacing
     void rebuildResponse(); // Recomputes the filter curve with added extrema points
 
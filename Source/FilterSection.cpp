@@ -0,0 +1,359 @@
+#include "FilterSection.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace
+{
+    bool isFirstOrder(FilterSection::Shape shape)
+    {
+        return shape == FilterSection::Shape::firstOrderHighPass || shape == FilterSection::Shape::firstOrderLowPass;
+    }
+
+    // Q of the section's poles - for peaks the denominator's Q is Q * A, so cuts ring harder than boosts
+    double poleQ(const FilterSection::Design& d)
+    {
+        if (isFirstOrder(d.shape))
+            return 0.5;
+
+        if (d.shape == FilterSection::Shape::peak)
+            return d.q * std::pow(10.0, d.gainDb / 40.0);
+
+        return d.q;
+    }
+
+    // A section as s' = s + delta * s + b * x, y = c * s + d * x, in the state its per-sample kernel keeps
+    struct DeltaStateSpace
+    {
+        double delta[2][2]{};
+        double b[2]{}, c[2]{};
+        double d = 1.0;
+    };
+
+    // Powers of A = I + delta are carried as A^k - I, so they keep their precision when A is close to the identity
+    void fillStateSpace(const DeltaStateSpace& m, DspKernels::StateSpaceCoefficients& out)
+    {
+        constexpr int n = DspKernels::StateSpaceCoefficients::blockLength;
+        double power[2][2] = {}; // A^k - I
+        double powerB[n][2]; // A^k B
+
+        for (int k = 0; k < n; ++k)
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                out.fromState[i][k] = (float)(m.c[i] + m.c[0] * power[0][i] + m.c[1] * power[1][i]);
+                powerB[k][i] = m.b[i] + power[i][0] * m.b[0] + power[i][1] * m.b[1];
+            }
+
+            double next[2][2];
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 2; ++j)
+                    next[i][j] = m.delta[i][j] + power[i][j] + m.delta[i][0] * power[0][j] + m.delta[i][1] * power[1][j];
+
+            std::copy(&next[0][0], &next[0][0] + 4, &power[0][0]);
+        }
+
+        std::fill(std::begin(out.impulse), std::end(out.impulse), 0.0f);
+        out.impulse[n] = (float)m.d;
+        for (int k = 1; k < n; ++k)
+            out.impulse[n + k] = (float)(m.c[0] * powerB[k - 1][0] + m.c[1] * powerB[k - 1][1]);
+
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+                out.toState[i][j] = (float)powerB[n - 1 - j][i];
+
+            for (int j = 0; j < 2; ++j)
+            {
+                out.blockDelta[i][j] = (float)power[i][j];
+                out.stepDelta[i][j] = (float)m.delta[i][j];
+            }
+
+            out.input[i] = (float)m.b[i];
+            out.output[i] = (float)m.c[i];
+        }
+
+        out.direct = (float)m.d;
+    }
+
+    // TDF-II: y = b0 x + s1, s1' = b1 x - a1 y + s2, s2' = b2 x - a2 y
+    DeltaStateSpace directFormStateSpace(const double (&c)[5])
+    {
+        DeltaStateSpace m;
+        m.delta[0][0] = -c[3] - 1.0;
+        m.delta[0][1] = 1.0;
+        m.delta[1][0] = -c[4];
+        m.delta[1][1] = -1.0;
+        m.b[0] = c[1] - c[3] * c[0];
+        m.b[1] = c[2] - c[4] * c[0];
+        m.c[0] = 1.0;
+        m.d = c[0];
+        return m;
+    }
+
+    // The kernels' SVF (and one-pole) updates, expanded - see DspKernelsImpl.h
+    DeltaStateSpace svfStateSpace(const double (&c)[6], bool firstOrder)
+    {
+        const double g = c[0], gk = c[1], h = c[2], m0 = c[3], m1 = c[4], m2 = c[5];
+        DeltaStateSpace m;
+
+        if (firstOrder)
+        {
+            // z' = z + 2g (x - z), y = m0 x + m2 (g x + (1 - g) z); the second state stays put
+            m.delta[0][0] = -2.0 * g;
+            m.b[0] = 2.0 * g;
+            m.c[0] = m2 * (1.0 - g);
+            m.d = m0 + m2 * g;
+            return m;
+        }
+
+        // band = (1 - h gk) ic1 - h ic2 + h x, low = ic2 + g band, ic1' = 2 band - ic1, ic2' = 2 low - ic2
+        m.delta[0][0] = -2.0 * h * gk;
+        m.delta[0][1] = -2.0 * h;
+        m.delta[1][0] = 2.0 * g * (1.0 - h * gk);
+        m.delta[1][1] = -2.0 * g * h;
+        m.b[0] = 2.0 * h;
+        m.b[1] = 2.0 * g * h;
+        m.c[0] = (m1 + m2 * g) * (1.0 - h * gk);
+        m.c[1] = m2 * (1.0 - g * h) - m1 * h;
+        m.d = m0 + m1 * h + m2 * g * h;
+        return m;
+    }
+}
+
+// Pole distance from the unit circle is roughly pi * (f / fs) / Q, so the SVF threshold scales with pole Q.
+// Hysteresis keeps a sweeping knob from flipping topology (and resetting state) back and forth.
+FilterSection::Topology FilterSection::chooseTopology(const Design& design, TopologyMode mode, Topology current)
+{
+    if (mode == TopologyMode::directForm) return Topology::directForm;
+    if (mode == TopologyMode::svf) return Topology::svf;
+
+    const double ratio = design.freqHz / design.sampleRate;
+    const double threshold = svfFreqRatio * juce::jmax(1.0, poleQ(design) / 0.70710678);
+
+    if (current == Topology::svf)
+        return ratio < threshold * hysteresis ? Topology::svf : Topology::directForm;
+
+    return ratio < threshold ? Topology::svf : Topology::directForm;
+}
+
+void FilterSection::makeDoubleCoefficients(const Design& d, double (&c)[5])
+{
+    // Bilinear transform prewarped at the centre/corner frequency - the same designs as IIR::Coefficients
+    const double K = std::tan(juce::MathConstants<double>::pi * d.freqHz / d.sampleRate);
+    const double K2 = K * K;
+
+    switch (d.shape)
+    {
+        case Shape::firstOrderHighPass:
+        case Shape::firstOrderLowPass:
+        {
+            const double b0 = (d.shape == Shape::firstOrderLowPass ? K : 1.0) / (1.0 + K);
+            c[0] = b0;
+            c[1] = d.shape == Shape::firstOrderLowPass ? b0 : -b0;
+            c[2] = 0.0;
+            c[3] = (K - 1.0) / (K + 1.0);
+            c[4] = 0.0;
+            return;
+        }
+
+        case Shape::highPass:
+        case Shape::lowPass:
+        {
+            const double a0 = 1.0 + K / d.q + K2;
+            const double b0 = d.shape == Shape::lowPass ? K2 : 1.0;
+            c[0] = b0 / a0;
+            c[1] = (d.shape == Shape::lowPass ? 2.0 : -2.0) * b0 / a0;
+            c[2] = b0 / a0;
+            c[3] = 2.0 * (K2 - 1.0) / a0;
+            c[4] = (1.0 - K / d.q + K2) / a0;
+            return;
+        }
+
+        case Shape::peak:
+        default:
+        {
+            const double A = std::pow(10.0, d.gainDb / 40.0);
+            const double a0 = 1.0 + K / (A * d.q) + K2;
+            c[0] = (1.0 + K * A / d.q + K2) / a0;
+            c[1] = 2.0 * (K2 - 1.0) / a0;
+            c[2] = (1.0 - K * A / d.q + K2) / a0;
+            c[3] = 2.0 * (K2 - 1.0) / a0;
+            c[4] = (1.0 - K / (A * d.q) + K2) / a0;
+            return;
+        }
+    }
+}
+
+double FilterSection::getMagnitudeForFrequency(const double (&c)[5], double freqHz, double sampleRate)
+{
+    const double w = 2.0 * juce::MathConstants<double>::pi * freqHz / sampleRate;
+    const double cos1 = std::cos(w), sin1 = std::sin(w);
+    const double cos2 = std::cos(2.0 * w), sin2 = std::sin(2.0 * w);
+
+    // Numerator and denominator at z = e^jw
+    const double numRe = c[0] + c[1] * cos1 + c[2] * cos2;
+    const double numIm = -(c[1] * sin1 + c[2] * sin2);
+    const double denRe = 1.0 + c[3] * cos1 + c[4] * cos2;
+    const double denIm = -(c[3] * sin1 + c[4] * sin2);
+
+    return std::sqrt((numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm));
+}
+
+FilterSection::Coefficients FilterSection::makeCoefficients(const Design& d, Topology topology, bool blockProcessing)
+{
+    Coefficients c;
+    c.topology = topology;
+    c.firstOrder = isFirstOrder(d.shape);
+    c.blockProcessing = blockProcessing;
+
+    if (topology == Topology::directForm)
+    {
+        double dc[5];
+        makeDoubleCoefficients(d, dc);
+        c.b0 = (float)dc[0];
+        c.b1 = (float)dc[1];
+        c.b2 = (float)dc[2];
+        c.a1 = (float)dc[3];
+        c.a2 = (float)dc[4];
+
+        if (blockProcessing)
+            fillStateSpace(directFormStateSpace(dc), c.stateSpace);
+
+        return c;
+    }
+
+    double svf[6];
+    makeSvfCoefficients(d, svf);
+    c.g = (float)svf[0];
+    c.gk = (float)svf[1];
+    c.h = (float)svf[2];
+    c.m0 = (float)svf[3];
+    c.m1 = (float)svf[4];
+    c.m2 = (float)svf[5];
+
+    if (blockProcessing)
+        fillStateSpace(svfStateSpace(svf, c.firstOrder), c.stateSpace);
+
+    return c;
+}
+
+// Times both ways of running a mid-band direct-form peak and a low SVF peak over the same noise, best of five runs
+// of about 64k samples each. The block kernel has to win by 10% - on a near tie the per-sample kernels are the
+// more accurate choice.
+bool FilterSection::isBlockProcessingFaster(int blockSize)
+{
+    if (blockSize < DspKernels::StateSpaceCoefficients::blockLength)
+        return false;
+
+    static juce::CriticalSection lock;
+    static std::map<std::pair<juce::String, int>, bool> results;
+
+    const juce::ScopedLock sl(lock);
+    const auto key = std::make_pair(juce::String(DspKernels::get().name), blockSize);
+    if (const auto found = results.find(key); found != results.end())
+        return found->second;
+
+    const Design designs[] = {
+        { Shape::peak, 48000.0, 1000.0, 1.0, 6.0 },
+        { Shape::peak, 48000.0, 60.0, 2.0, -6.0 },
+    };
+
+    std::vector<float> input((size_t)blockSize), buffer((size_t)blockSize);
+    juce::Random random(1);
+    for (auto& x : input)
+        x = random.nextFloat() - 0.5f;
+
+    const int repeats = juce::jmax(1, 65536 / blockSize);
+
+    auto measure = [&](bool block)
+        {
+            double best = std::numeric_limits<double>::max();
+
+            for (int run = 0; run < 5; ++run)
+            {
+                juce::int64 ticks = 0;
+
+                for (const auto& design : designs)
+                {
+                    const auto c = makeCoefficients(design, chooseTopology(design, TopologyMode::automatic, Topology::directForm), block);
+                    FilterSection section;
+                    const auto start = juce::Time::getHighResolutionTicks();
+
+                    // Fresh input each time, so a boost can't build up over the repeats
+                    for (int r = 0; r < repeats; ++r)
+                    {
+                        std::copy(input.begin(), input.end(), buffer.begin());
+                        section.process(c, buffer.data(), blockSize);
+                    }
+
+                    ticks += juce::Time::getHighResolutionTicks() - start;
+                }
+
+                best = juce::jmin(best, (double)ticks);
+            }
+
+            return best;
+        };
+
+    const double perSample = measure(false);
+    const double blockTime = measure(true);
+    return results[key] = blockTime < 0.9 * perSample;
+}
+
+// First-order sections only use g (as the one-pole gain g / (1 + g)), m0 and m2
+void FilterSection::makeSvfCoefficients(const Design& d, double (&c)[6])
+{
+    const double g = std::tan(juce::MathConstants<double>::pi * d.freqHz / d.sampleRate);
+
+    if (isFirstOrder(d.shape))
+    {
+        const bool highPass = d.shape == Shape::firstOrderHighPass;
+        c[0] = g / (1.0 + g);
+        c[1] = c[2] = c[4] = 0.0;
+        c[3] = highPass ? 1.0 : 0.0;
+        c[5] = highPass ? -1.0 : 1.0;
+        return;
+    }
+
+    double k = 1.0 / d.q;
+    double m0 = 0.0, m1 = 0.0, m2 = 0.0;
+
+    switch (d.shape)
+    {
+        case Shape::highPass: m0 = 1.0; m1 = -k; m2 = -1.0; break;
+        case Shape::lowPass: m2 = 1.0; break;
+        case Shape::peak:
+        default:
+        {
+            const double A = std::pow(10.0, d.gainDb / 40.0);
+            k = 1.0 / (d.q * A);
+            m0 = 1.0;
+            m1 = k * (A * A - 1.0);
+            break;
+        }
+    }
+
+    c[0] = g;
+    c[1] = g + k;
+    c[2] = g / (1.0 + g * (g + k));
+    c[3] = m0;
+    c[4] = m1;
+    c[5] = m2;
+}
+
+void FilterSection::process(const Coefficients& c, float* data, int numSamples)
+{
+    const auto& kernels = DspKernels::get();
+
+    if (c.blockProcessing && numSamples >= DspKernels::StateSpaceCoefficients::blockLength)
+        kernels.stateSpace(c.stateSpace, state, data, numSamples);
+    else if (c.topology == Topology::directForm)
+        kernels.directForm({ c.b0, c.b1, c.b2, c.a1, c.a2 }, state, data, numSamples);
+    else if (c.firstOrder)
+        kernels.onePole({ c.g, c.gk, c.h, c.m0, c.m1, c.m2 }, state, data, numSamples);
+    else
+        kernels.svf({ c.g, c.gk, c.h, c.m0, c.m1, c.m2 }, state, data, numSamples);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "DspKernels.h"
+
+/**
+ * One second-order (or first-order) EQ section in float, in one of two topologies:
+ *  - directForm: transposed direct form II biquad - cheapest, but its a1/a2 crowd -2/+1 as poles approach the
+ *    unit circle, so float coefficient rounding and state noise grow quickly at low f/fs and high Q.
+ *  - svf: trapezoidal (TPT) state variable filter - a couple of extra multiplies, but its coefficients stay
+ *    well conditioned down to a few Hz at 192 kHz.
+ * Both realise the same bilinear (RBJ) designs JUCE's IIR::Coefficients produce, so the curves match exactly.
+ * Coefficients are shared between channels; each channel keeps its own FilterSection (state only).
+ * The per-sample loops are the selected DspKernels variant's. For a single channel, where there's nothing to
+ * vectorise across, a section can also run as a block state-space system that computes 16 outputs at a time.
+ */
+class FilterSection
+{
+public:
+    enum class Topology { directForm, svf };
+    enum class Shape { peak, highPass, lowPass, firstOrderHighPass, firstOrderLowPass };
+
+    // Per-processor choice - automatic picks per section from frequency, Q and sample rate
+    enum class TopologyMode { automatic, directForm, svf };
+
+    struct Design
+    {
+        Shape shape = Shape::peak;
+        double sampleRate = 44100.0;
+        double freqHz = 1000.0;
+        double q = 0.70710678;
+        double gainDb = 0.0; // Peaks only
+    };
+
+    struct Coefficients
+    {
+        Topology topology = Topology::directForm;
+        bool firstOrder = false;
+
+        // Transposed direct form II, a0 normalised to 1
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+        // TPT SVF: g = tan(pi f / fs), gk = g + k, h = g / (1 + g * gk), out = m0 * x + m1 * band + m2 * low
+        // (first-order sections use g as the one-pole gain g / (1 + g))
+        float g = 0.0f, gk = 0.0f, h = 0.0f;
+        float m0 = 1.0f, m1 = 0.0f, m2 = 0.0f;
+
+        // The same section as a block state-space system (see DspKernels::StateSpaceCoefficients), used for blocks
+        // of at least its blockLength when blockProcessing is set - it shares the topology's state, so a channel can
+        // move between the two from one block to the next
+        bool blockProcessing = false;
+        DspKernels::StateSpaceCoefficients stateSpace;
+    };
+
+    // Sections below this f/fs (scaled up with Q) switch to the SVF; see chooseTopology()
+    static constexpr double svfFreqRatio = 0.004;
+    static constexpr double hysteresis = 1.25;
+
+    static Topology chooseTopology(const Design& design, TopologyMode mode, Topology current);
+    static Coefficients makeCoefficients(const Design& design, Topology topology, bool blockProcessing = false);
+
+    // Whether the block kernel beats the per-sample ones on a single channel at this block size, with the selected
+    // kernel variant. Measured on first use for each variant and block size (a few ms), so call it off the audio thread.
+    static bool isBlockProcessingFaster(int blockSize);
+
+    // Same design in double, for reference models and accuracy measurements
+    static void makeDoubleCoefficients(const Design& design, double (&coeffs)[5]); // TDF-II { b0, b1, b2, a1, a2 }
+    static void makeSvfCoefficients(const Design& design, double (&coeffs)[6]); // { g, gk, h, m0, m1, m2 }
+
+    // |H| of TDF-II coefficients { b0, b1, b2, a1, a2 } at freqHz
+    static double getMagnitudeForFrequency(const double (&coeffs)[5], double freqHz, double sampleRate);
+
+    void reset() { state[0] = state[1] = 0.0f; }
+    void process(const Coefficients& c, float* data, int numSamples);
+
+private:
+    // TDF-II: s1, s2 / SVF: ic1eq (band), ic2eq (low) / one-pole: integrator state
+    float state[2] = { 0.0f, 0.0f };
+};
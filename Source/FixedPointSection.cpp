@@ -0,0 +1,100 @@
+#include "FixedPointSection.h"
+#include <cmath>
+
+namespace
+{
+    juce::int32 saturate(juce::int64 v)
+    {
+        return (juce::int32)juce::jlimit((juce::int64)std::numeric_limits<juce::int32>::min(),
+                                         (juce::int64)std::numeric_limits<juce::int32>::max(), v);
+    }
+}
+
+FixedPointSection::Coefficients FixedPointSection::quantise(const double (&coeffs)[5])
+{
+    Coefficients q;
+
+    // As many fraction bits as the largest coefficient leaves room for (peaks near Nyquist boost b0 well past 2)
+    double largest = 0.0;
+    for (double c : coeffs)
+        largest = juce::jmax(largest, std::abs(c));
+
+    q.fractionBits = 30;
+    while (q.fractionBits > 8 && largest * std::ldexp(1.0, q.fractionBits) >= 2147483647.0)
+        --q.fractionBits;
+
+    const double scale = std::ldexp(1.0, q.fractionBits);
+    auto fixed = [scale](double c) { return (juce::int64)std::llround(c * scale); };
+
+    const auto a1 = fixed(coeffs[3]), a2 = fixed(coeffs[4]);
+    const auto b0 = fixed(coeffs[0]), b2 = fixed(coeffs[2]);
+
+    // DC gain of the double design, rebuilt on the rounded denominator - b1 takes the difference
+    const double den = 1.0 + coeffs[3] + coeffs[4];
+    const double dcGain = std::abs(den) > 1.0e-300 ? (coeffs[0] + coeffs[1] + coeffs[2]) / den : 0.0;
+    const double roundedDen = (double)((juce::int64)scale + a1 + a2);
+    const auto b1 = dcGain == 0.0 ? -(b0 + b2) : (juce::int64)std::llround(dcGain * roundedDen) - b0 - b2;
+
+    q.b0 = saturate(b0);
+    q.b1 = saturate(b1);
+    q.b2 = saturate(b2);
+    q.a1 = saturate(a1);
+    q.a2 = saturate(a2);
+
+    q.feedback1 = (int)std::lround(-coeffs[3]);
+    q.feedback2 = (int)std::lround(-coeffs[4]);
+    return q;
+}
+
+void FixedPointSection::toFixed(const float* in, juce::int32* out, int numSamples)
+{
+    constexpr float limit = 2147483520.0f; // Largest float below 2^31
+    for (int i = 0; i < numSamples; ++i)
+        out[i] = (juce::int32)juce::jlimit(-limit, limit, in[i] * toFixedScale);
+}
+
+void FixedPointSection::toFloat(const juce::int32* in, float* out, int numSamples)
+{
+    constexpr float scale = 1.0f / toFixedScale;
+    for (int i = 0; i < numSamples; ++i)
+        out[i] = (float)in[i] * scale;
+}
+
+// The sum is formed modulo 2^64, so partial sums may wrap; the final one is exact unless the output would be over
+// 4x the Q31 range, and the headroom keeps real signals far from that. Outputs past the Q31 range saturate.
+void FixedPointSection::process(const Coefficients& c, juce::int32* data, int numSamples)
+{
+    const juce::int64 b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+    const int shift = c.fractionBits;
+    const juce::int64 k1 = c.feedback1, k2 = c.feedback2;
+
+    juce::int64 px1 = x1, px2 = x2, py1 = y1, py2 = y2, pe1 = e1, pe2 = e2;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const juce::int64 x = data[i];
+        const auto sum = (juce::uint64)(b0 * x) + (juce::uint64)(b1 * px1) + (juce::uint64)(b2 * px2)
+                       - (juce::uint64)(a1 * py1) - (juce::uint64)(a2 * py2)
+                       + (juce::uint64)(k1 * pe1) + (juce::uint64)(k2 * pe2);
+        const auto acc = (juce::int64)sum;
+
+        juce::int64 y = acc >> shift; // Floor
+        const juce::int64 error = acc - (y << shift);
+        y = saturate(y);
+
+        px2 = px1;
+        px1 = x;
+        py2 = py1;
+        py1 = y;
+        pe2 = pe1;
+        pe1 = error;
+        data[i] = (juce::int32)y;
+    }
+
+    x1 = (juce::int32)px1;
+    x2 = (juce::int32)px2;
+    y1 = (juce::int32)py1;
+    y2 = (juce::int32)py2;
+    e1 = pe1;
+    e2 = pe2;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#ifndef JUCEEQ_FIXED_POINT
+ #define JUCEEQ_FIXED_POINT 0
+#endif
+
+/**
+ * One EQ section in integer arithmetic, for targets without a fast FPU - the processor's fixed-point engine runs
+ * the whole HPF -> peaks -> LPF chain through these, converting to and from float only at the chain's ends.
+ *  - samples are Q31 with headroomBits of headroom (+-64, so a +36 dB boost of a full-scale signal still fits)
+ *  - direct form I, so the state is just past inputs and outputs and can't overflow between samples
+ *  - coefficients are Q(fractionBits), with fractionBits picked per section as large as its biggest coefficient
+ *    allows (30 for anything within +-2); products are summed in 64 bits
+ *  - quantisation is shaped twice over: the coefficient rounding keeps the section's DC gain exact (b1 absorbs the
+ *    rounding of the others, so a high-pass still nulls DC), and the output rounding error is fed back through
+ *    the integer approximation of the poles (error feedback), which cancels the noise gain of poles near z = 1
+ *    - the low-frequency, high-Q sections that float direct form handles worst
+ * Coefficients come from the same double designs as the float sections (FilterSection::makeDoubleCoefficients).
+ */
+class FixedPointSection
+{
+public:
+    static constexpr int headroomBits = 6;
+    static constexpr float toFixedScale = (float)(1 << (31 - headroomBits));
+
+    struct Coefficients
+    {
+        juce::int32 b0 = 1 << 30, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+        int fractionBits = 30;
+        int feedback1 = 0, feedback2 = 0; // Error feedback: -a1 and -a2 rounded to integers
+    };
+
+    // TDF-II { b0, b1, b2, a1, a2 } (a0 = 1)
+    static Coefficients quantise(const double (&coeffs)[5]);
+
+    // Float <-> Q31 with the headroom above, saturating
+    static void toFixed(const float* in, juce::int32* out, int numSamples);
+    static void toFloat(const juce::int32* in, float* out, int numSamples);
+
+    void reset() { *this = {}; }
+    void process(const Coefficients& c, juce::int32* data, int numSamples);
+
+private:
+    juce::int32 x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    juce::int64 e1 = 0, e2 = 0; // Last two output rounding errors, in accumulator units
+};
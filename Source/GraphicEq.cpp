@@ -0,0 +1,108 @@
+#include "GraphicEq.h"
+#include <cmath>
+
+namespace
+{
+    // Third-octave band n (from 0) sits at 1 kHz * 2^((n - 17) / 3); the octave layout is every third one from 31.5 Hz
+    constexpr int thirdOctaveOneKHz = 17;
+    constexpr int octaveFirstBand = 2;
+
+    const char* const thirdOctaveNames[GraphicEq::maxBands] = {
+        "20", "25", "31.5", "40", "50", "63", "80", "100", "125", "160", "200", "250", "315", "400", "500", "630",
+        "800", "1k", "1.25k", "1.6k", "2k", "2.5k", "3.15k", "4k", "5k", "6.3k", "8k", "10k", "12.5k", "16k", "20k"
+    };
+
+    // Nominal Q for the band spacing: sqrt(2^N) / (2^N - 1) for N octaves
+    double nominalQ(GraphicEq::Layout layout)
+    {
+        const double n = layout == GraphicEq::Layout::thirdOctave ? 1.0 / 3.0 : 1.0;
+        return std::sqrt(std::pow(2.0, n)) / (std::pow(2.0, n) - 1.0);
+    }
+
+    // Proportional Q widens bands to this fraction of the nominal Q as the gain goes to 0 dB
+    constexpr double proportionalMinQ = 0.4;
+}
+
+int GraphicEq::getNumBands(Layout layout)
+{
+    return layout == Layout::thirdOctave ? numThirdOctaveBands : numOctaveBands;
+}
+
+double GraphicEq::getCentreFrequency(Layout layout, int band)
+{
+    const int thirdOctaveIndex = layout == Layout::thirdOctave ? band : octaveFirstBand + 3 * band;
+    return 1000.0 * std::pow(2.0, (double)(thirdOctaveIndex - thirdOctaveOneKHz) / 3.0);
+}
+
+juce::String GraphicEq::getBandName(Layout layout, int band)
+{
+    const int thirdOctaveIndex = layout == Layout::thirdOctave ? band : octaveFirstBand + 3 * band;
+    return thirdOctaveNames[juce::jlimit(0, maxBands - 1, thirdOctaveIndex)];
+}
+
+juce::String GraphicEq::getParamId(Layout layout, int band)
+{
+    return (layout == Layout::thirdOctave ? "geq31_" : "geq10_") + juce::String(band + 1);
+}
+
+GraphicEq::GraphicEq(double rate)
+    : sampleRate(rate)
+{
+    // Bands near or past Nyquist (20 kHz at 44.1 kHz) are held just below it
+    auto prewarp = [this](double freqHz)
+        {
+            return std::tan(juce::MathConstants<double>::pi * juce::jmin(freqHz, 0.49 * sampleRate) / sampleRate);
+        };
+
+    for (int b = 0; b < getNumBands(Layout::thirdOctave); ++b)
+        thirdOctaveK[(size_t)b] = prewarp(getCentreFrequency(Layout::thirdOctave, b));
+
+    for (int b = 0; b < getNumBands(Layout::octave); ++b)
+        octaveK[(size_t)b] = prewarp(getCentreFrequency(Layout::octave, b));
+}
+
+// The same bilinear peak as FilterSection::makeDoubleCoefficients, with K taken from the per-rate table
+void GraphicEq::makeCoefficients(Layout layout, QMode qMode, const float* gainsDb, double (*coeffs)[5]) const
+{
+    const auto& table = layout == Layout::thirdOctave ? thirdOctaveK : octaveK;
+    const double q0 = nominalQ(layout);
+
+    for (int b = 0; b < getNumBands(layout); ++b)
+    {
+        const double gainDb = (double)juce::jlimit(-maxGainDb, maxGainDb, gainsDb[b]);
+        const double q = qMode == QMode::proportional
+                             ? q0 * juce::jmap(std::abs(gainDb) / (double)maxGainDb, proportionalMinQ, 1.0)
+                             : q0;
+
+        const double K = table[(size_t)b];
+        const double K2 = K * K;
+        const double A = std::pow(10.0, gainDb / 40.0);
+        const double a0 = 1.0 + K / (A * q) + K2;
+
+        auto* c = coeffs[b];
+        c[0] = (1.0 + K * A / q + K2) / a0;
+        c[1] = 2.0 * (K2 - 1.0) / a0;
+        c[2] = (1.0 - K * A / q + K2) / a0;
+        c[3] = c[1];
+        c[4] = (1.0 - K / (A * q) + K2) / a0;
+    }
+}
+
+void GraphicEq::makeBank(Layout layout, QMode qMode, const float* gainsDb, DspKernels::GraphicBankCoefficients& bank) const
+{
+    double coeffs[maxBands][5];
+    const int numBands = getNumBands(layout);
+    makeCoefficients(layout, qMode, gainsDb, coeffs);
+
+    bank.numLanes = (numBands + 7) / 8 * 8;
+
+    for (int lane = 0; lane < bank.numLanes; ++lane)
+    {
+        const bool used = lane < numBands;
+        bank.b0[lane] = used ? (float)coeffs[lane][0] : 1.0f;
+        bank.b1[lane] = used ? (float)coeffs[lane][1] : 0.0f;
+        bank.b2[lane] = used ? (float)coeffs[lane][2] : 0.0f;
+        bank.a1[lane] = used ? (float)coeffs[lane][3] : 0.0f;
+        bank.a2[lane] = used ? (float)coeffs[lane][4] : 0.0f;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include "DspKernels.h"
+
+/**
+ * Graphic EQ designs: ISO 266 third-octave (31 bands, 20 Hz - 20 kHz) or octave (10 bands, 31.5 Hz - 16 kHz)
+ * peaking sections in series, which the processor runs as one DspKernels graphic bank rather than band by band.
+ *  - constant Q: every band keeps its nominal bandwidth at any gain (Q 4.32 third-octave, 1.41 octave)
+ *  - proportional Q: bands are wide for small moves and narrow to the nominal bandwidth at full boost or cut,
+ *    like most analogue graphics - smoother curves for gentle settings, less spill into neighbours for big ones
+ * Centres are the exact base-2 frequencies (1 kHz * 2^(n/3)); the ISO nominal values are only labels.
+ * The prewarped centres depend only on the sample rate, so an instance computes them once per rate and
+ * gain changes only redo the cheap part of the design.
+ */
+class GraphicEq
+{
+public:
+    enum class Layout { thirdOctave, octave };
+    enum class QMode { constant, proportional };
+
+    static constexpr int numThirdOctaveBands = 31;
+    static constexpr int numOctaveBands = 10;
+    static constexpr int maxBands = numThirdOctaveBands;
+    static constexpr float maxGainDb = 12.0f;
+
+    static int getNumBands(Layout layout);
+    static double getCentreFrequency(Layout layout, int band);
+    static juce::String getBandName(Layout layout, int band); // Nominal, e.g. "31.5", "1.6k"
+    static juce::String getParamId(Layout layout, int band); // "geq31_1" .. "geq31_31", "geq10_1" .. "geq10_10"
+
+    explicit GraphicEq(double sampleRate = 44100.0);
+    double getSampleRate() const { return sampleRate; }
+
+    // TDF-II { b0, b1, b2, a1, a2 } per band of the layout, gains in dB (clamped to +-maxGainDb)
+    void makeCoefficients(Layout layout, QMode qMode, const float* gainsDb, double (*coeffs)[5]) const;
+
+    // The same sections in float, one per lane
+    void makeBank(Layout layout, QMode qMode, const float* gainsDb, DspKernels::GraphicBankCoefficients& bank) const;
+
+private:
+    double sampleRate;
+    std::array<double, maxBands> thirdOctaveK{}, octaveK{}; // tan(pi f / fs) per band
+};
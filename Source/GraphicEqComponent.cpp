@@ -0,0 +1,106 @@
+#include "GraphicEqComponent.h"
+
+GraphicEqComponent::GraphicEqComponent(JuceEQAudioProcessor& proc) : processor(proc)
+{
+    layoutBox.addItemList({ "31-band", "10-band" }, 1);
+    qModeBox.addItemList({ "Constant Q", "Proportional Q" }, 1);
+    addAndMakeVisible(layoutBox);
+    addAndMakeVisible(qModeBox);
+
+    flatButton.setTooltip("Set every band of this layout to 0 dB");
+    flatButton.onClick = [this]() { resetToFlat(); };
+    addAndMakeVisible(flatButton);
+
+    for (size_t b = 0; b < faders.size(); ++b)
+    {
+        auto& fader = faders[b];
+        fader.setSliderStyle(juce::Slider::LinearVertical);
+        fader.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
+        fader.setPopupDisplayEnabled(true, true, this);
+        fader.setDoubleClickReturnValue(true, 0.0);
+        addChildComponent(fader);
+
+        auto& name = names[b];
+        name.setJustificationType(juce::Justification::centred);
+        name.setFont(juce::Font(juce::FontOptions(10.0f)));
+        name.setMinimumHorizontalScale(0.5f);
+        addChildComponent(name);
+    }
+
+    // Attach before hooking onChange, so the first attachLayout sees the stored layout
+    layoutAttach = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(processor.apvts, "geqLayout", layoutBox);
+    qModeAttach = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(processor.apvts, "geqQ", qModeBox);
+
+    layoutBox.onChange = [this]() { attachLayout(); };
+    attachLayout();
+}
+
+GraphicEq::Layout GraphicEqComponent::currentLayout() const
+{
+    return layoutBox.getSelectedItemIndex() == 1 ? GraphicEq::Layout::octave : GraphicEq::Layout::thirdOctave;
+}
+
+void GraphicEqComponent::attachLayout()
+{
+    const auto layout = currentLayout();
+    numVisible = GraphicEq::getNumBands(layout);
+
+    for (int b = 0; b < GraphicEq::maxBands; ++b)
+    {
+        faderAttach[(size_t)b].reset();
+
+        const bool used = b < numVisible;
+        faders[(size_t)b].setVisible(used);
+        names[(size_t)b].setVisible(used);
+
+        if (used)
+        {
+            faderAttach[(size_t)b] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+                processor.apvts, GraphicEq::getParamId(layout, b), faders[(size_t)b]);
+            names[(size_t)b].setText(GraphicEq::getBandName(layout, b), juce::dontSendNotification);
+        }
+    }
+
+    resized();
+}
+
+void GraphicEqComponent::resetToFlat()
+{
+    const auto layout = currentLayout();
+
+    for (int b = 0; b < GraphicEq::getNumBands(layout); ++b)
+    {
+        if (auto* param = processor.apvts.getParameter(GraphicEq::getParamId(layout, b)))
+        {
+            param->beginChangeGesture();
+            param->setValueNotifyingHost(param->convertTo0to1(0.0f));
+            param->endChangeGesture();
+        }
+    }
+}
+
+void GraphicEqComponent::resized()
+{
+    auto bounds = getLocalBounds().reduced(4);
+
+    auto top = bounds.removeFromTop(24);
+    layoutBox.setBounds(top.removeFromLeft(100));
+    top.removeFromLeft(8);
+    qModeBox.setBounds(top.removeFromLeft(130));
+    flatButton.setBounds(top.removeFromRight(60));
+
+    bounds.removeFromTop(8);
+    if (numVisible == 0)
+        return;
+
+    auto labelRow = bounds.removeFromBottom(16);
+    const float columnWidth = (float)bounds.getWidth() / (float)numVisible;
+
+    for (int b = 0; b < numVisible; ++b)
+    {
+        const int x = bounds.getX() + juce::roundToInt(columnWidth * (float)b);
+        const int w = juce::roundToInt(columnWidth * (float)(b + 1)) - juce::roundToInt(columnWidth * (float)b);
+        faders[(size_t)b].setBounds(x, bounds.getY(), w, bounds.getHeight());
+        names[(size_t)b].setBounds(x, labelRow.getY(), w, labelRow.getHeight());
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include "PluginProcessor.h"
+
+// Graphic EQ mode controls: layout and Q mode, a "Flat" reset, and one vertical fader per band of the layout.
+// The faders are attached to the active layout's parameters, so switching layout re-attaches them.
+class GraphicEqComponent : public juce::Component
+{
+public:
+    explicit GraphicEqComponent(JuceEQAudioProcessor& proc);
+    void resized() override;
+
+private:
+    void attachLayout(); // Faders and labels for the layout the combo shows
+    void resetToFlat();
+
+    GraphicEq::Layout currentLayout() const;
+
+    JuceEQAudioProcessor& processor;
+
+    juce::ComboBox layoutBox, qModeBox;
+    juce::TextButton flatButton{ "Flat" };
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> layoutAttach, qModeAttach;
+
+    std::array<juce::Slider, GraphicEq::maxBands> faders;
+    std::array<juce::Label, GraphicEq::maxBands> names;
+    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>, GraphicEq::maxBands> faderAttach;
+    int numVisible = 0;
+};
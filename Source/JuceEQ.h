@@ -0,0 +1,84 @@
+#pragma once
+
+// JuceEQ embedding API - the EQ's audio path for render engines and game-audio runtimes, without JUCE's
+// AudioProcessor or any GUI code. Plain C, so it links from C, C++ or anything with a C FFI, and it's all JuceEQDsp
+// exports - the C++ classes behind it (EqChain, EqDesign) need JUCE, so projects that build JUCE themselves compile
+// them from source instead (see CMakeLists.txt).
+//
+// An engine is the plugin's own chain (EqChain) for a fixed number of channels, all with the same settings: input
+// gain -> HPF -> peaks -> LPF -> output gain -> limiter, with the plugin's designs, parameter ranges, gain ramps
+// and flat-curve bypass. The output matches the plugin's for the same settings and block sizes.
+// Processing is in place on the caller's buffers and nothing is allocated or locked after juceeq_create(). Planar
+// buffers are processed where they are; interleaved ones cost two copies per block, through num_channels *
+// max_block_size floats of scratch the engine allocates at create. Settings calls aren't thread-safe against
+// processing: make them from the audio thread between blocks.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JUCEEQ_MAX_BANDS 8
+#define JUCEEQ_MAX_CHANNELS 64
+
+typedef struct juceeq_engine juceeq_engine;
+
+typedef struct juceeq_band
+{
+    int enabled;
+    float freq_hz; // 10 Hz - 20 kHz, and below 0.49x the sample rate
+    float q;       // 0.1 - 40
+    float gain_db; // -30 - +30
+} juceeq_band;
+
+typedef struct juceeq_settings
+{
+    float in_gain_db;
+    float out_gain_db;
+
+    int hpf_enabled;
+    int hpf_slope; // 0 = 6, 1 = 12, 2 = 24, 3 = 48 dB/octave
+    float hpf_freq_hz;
+
+    int lpf_enabled;
+    int lpf_slope;
+    float lpf_freq_hz;
+
+    juceeq_band bands[JUCEEQ_MAX_BANDS];
+
+    // Brickwall limiter after the output gain - its lookahead is latency (see juceeq_get_latency_samples)
+    int limiter_enabled;
+    float limiter_ceiling_db;   // -24 - 0
+    float limiter_lookahead_ms; // 0.1 - 20
+    float limiter_release_ms;   // 1 - 1000
+    int limiter_true_peak;
+} juceeq_settings;
+
+// Flat: 0 dB gains, filters, bands and limiter off
+void juceeq_default_settings(juceeq_settings* settings);
+
+// Null if the arguments are out of range (1 to JUCEEQ_MAX_CHANNELS channels) or memory runs out. Blocks longer than
+// max_block_size are split.
+juceeq_engine* juceeq_create(double sample_rate, int max_block_size, int num_channels);
+void juceeq_destroy(juceeq_engine* engine);
+
+// The first settings after create jump to their gains; later changes ramp them over 20 ms, and sections are only
+// redesigned where their values changed. Return 0, or -1 for a null pointer.
+int juceeq_set_settings(juceeq_engine* engine, const juceeq_settings* settings);
+
+void juceeq_reset(juceeq_engine* engine); // Clears the filter and limiter states
+
+// channels[num_channels] separate buffers, or one buffer of num_samples frames with the channels interleaved
+// (copied out to planar scratch and back a max_block_size piece at a time - prefer planar where the data allows)
+void juceeq_process_planar(juceeq_engine* engine, float* const* channels, int num_samples);
+void juceeq_process_interleaved(juceeq_engine* engine, float* data, int num_samples);
+
+// Delay through the engine as of the last block processed (the limiter's lookahead when it's on), 0 for null
+int juceeq_get_latency_samples(const juceeq_engine* engine);
+
+// |H| of the filter chain (no gains) at each frequency, any thread, no engine needed
+void juceeq_get_response(const juceeq_settings* settings, double sample_rate,
+                         const double* freqs_hz, double* magnitudes, int num_freqs);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,184 @@
+#include "JuceEQ.h"
+#include "EqChain.h"
+#include <memory>
+#include <new>
+
+static_assert(JUCEEQ_MAX_BANDS == EqConstants::maxEqBands);
+static_assert(JUCEEQ_MAX_CHANNELS == EqChain::maxChannels);
+
+// The plugin's chain, plus planar scratch for interleaved callers
+struct juceeq_engine
+{
+    EqChain chain;
+    int numChannels = 0;
+    int maxBlockSize = 0;
+    bool hasSettings = false; // The first settings jump to their gains
+    juce::HeapBlock<float> planar; // maxBlockSize samples per channel
+    float* channels[JUCEEQ_MAX_CHANNELS]{};
+};
+
+namespace
+{
+    EqDesign::ChainSettings toChainSettings(const juceeq_settings& s)
+    {
+        EqDesign::ChainSettings c;
+        c.inGainDb = s.in_gain_db;
+        c.outGainDb = s.out_gain_db;
+
+        c.hpfEnabled = s.hpf_enabled != 0;
+        c.hpfIndex = juce::jlimit(0, 3, s.hpf_slope);
+        c.hpfStages = EqDesign::numStagesForSlopeIndex(c.hpfIndex);
+        c.hpfFreqHz = s.hpf_freq_hz;
+
+        c.lpfEnabled = s.lpf_enabled != 0;
+        c.lpfIndex = juce::jlimit(0, 3, s.lpf_slope);
+        c.lpfStages = EqDesign::numStagesForSlopeIndex(c.lpfIndex);
+        c.lpfFreqHz = s.lpf_freq_hz;
+
+        for (int b = 0; b < JUCEEQ_MAX_BANDS; ++b)
+        {
+            auto& band = c.bands[(size_t)b];
+            band.enabled = s.bands[b].enabled != 0;
+            band.freqHz = s.bands[b].freq_hz;
+            band.q = s.bands[b].q;
+            band.gainDb = s.bands[b].gain_db;
+        }
+
+        c.limiterEnabled = s.limiter_enabled != 0;
+        c.limiterCeilingDb = s.limiter_ceiling_db;
+        c.limiterLookaheadMs = s.limiter_lookahead_ms;
+        c.limiterReleaseMs = s.limiter_release_ms;
+        c.limiterTruePeak = s.limiter_true_peak != 0;
+
+        return c;
+    }
+}
+
+void juceeq_default_settings(juceeq_settings* settings)
+{
+    if (settings == nullptr)
+        return;
+
+    const EqDesign::ChainSettings c;
+    *settings = {};
+    settings->hpf_slope = c.hpfIndex;
+    settings->hpf_freq_hz = c.hpfFreqHz;
+    settings->lpf_slope = c.lpfIndex;
+    settings->lpf_freq_hz = c.lpfFreqHz;
+
+    for (int b = 0; b < JUCEEQ_MAX_BANDS; ++b)
+    {
+        settings->bands[b].freq_hz = c.bands[(size_t)b].freqHz;
+        settings->bands[b].q = c.bands[(size_t)b].q;
+    }
+
+    settings->limiter_ceiling_db = c.limiterCeilingDb;
+    settings->limiter_lookahead_ms = c.limiterLookaheadMs;
+    settings->limiter_release_ms = c.limiterReleaseMs;
+    settings->limiter_true_peak = c.limiterTruePeak ? 1 : 0;
+}
+
+juceeq_engine* juceeq_create(double sampleRate, int maxBlockSize, int numChannels)
+{
+    if (!(sampleRate > 0.0) || maxBlockSize < 1 || !juce::isPositiveAndNotGreaterThan(numChannels, JUCEEQ_MAX_CHANNELS))
+        return nullptr;
+
+    DspKernels::get(); // Picks the kernel variant here rather than on the first block
+
+    std::unique_ptr<juceeq_engine> engine(new (std::nothrow) juceeq_engine());
+    if (engine == nullptr)
+        return nullptr;
+
+    engine->numChannels = numChannels;
+    engine->maxBlockSize = maxBlockSize;
+
+    engine->planar.malloc((size_t)numChannels * (size_t)maxBlockSize);
+    if (engine->planar == nullptr)
+        return nullptr;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        engine->channels[ch] = engine->planar + (size_t)ch * (size_t)maxBlockSize;
+
+    // The worker pool is the plugin's business - an embedding host schedules its own threads
+    EqChain::WorkerPoolOptions poolOptions;
+    poolOptions.enabled = false;
+    engine->chain.setWorkerPoolOptions(poolOptions);
+
+    if (!engine->chain.prepare(sampleRate, maxBlockSize, numChannels, false))
+        return nullptr;
+
+    return engine.release();
+}
+
+void juceeq_destroy(juceeq_engine* engine)
+{
+    delete engine;
+}
+
+int juceeq_set_settings(juceeq_engine* engine, const juceeq_settings* settings)
+{
+    if (engine == nullptr || settings == nullptr)
+        return -1;
+
+    engine->chain.setSettings(toChainSettings(*settings));
+
+    if (!engine->hasSettings)
+    {
+        engine->chain.jumpGainsToSettings();
+        engine->hasSettings = true;
+    }
+
+    return 0;
+}
+
+void juceeq_reset(juceeq_engine* engine)
+{
+    if (engine != nullptr)
+        engine->chain.reset();
+}
+
+void juceeq_process_planar(juceeq_engine* engine, float* const* channels, int numSamples)
+{
+    if (engine != nullptr && channels != nullptr && numSamples > 0)
+        engine->chain.process(channels, engine->numChannels, numSamples, false);
+}
+
+// Deinterleaved into the engine's own planar buffers a prepared block at a time, so the chain runs exactly as it
+// does on planar input
+void juceeq_process_interleaved(juceeq_engine* engine, float* data, int numSamples)
+{
+    if (engine == nullptr || data == nullptr || numSamples <= 0)
+        return;
+
+    const int numCh = engine->numChannels;
+
+    for (int start = 0; start < numSamples; start += engine->maxBlockSize)
+    {
+        const int n = juce::jmin(engine->maxBlockSize, numSamples - start);
+        float* frames = data + (size_t)start * (size_t)numCh;
+
+        for (int ch = 0; ch < numCh; ++ch)
+            for (int i = 0; i < n; ++i)
+                engine->channels[ch][i] = frames[(size_t)i * (size_t)numCh + (size_t)ch];
+
+        engine->chain.process(engine->channels, numCh, n, false);
+
+        for (int ch = 0; ch < numCh; ++ch)
+            for (int i = 0; i < n; ++i)
+                frames[(size_t)i * (size_t)numCh + (size_t)ch] = engine->channels[ch][i];
+    }
+}
+
+int juceeq_get_latency_samples(const juceeq_engine* engine)
+{
+    return engine != nullptr ? engine->chain.getLatencySamples() : 0;
+}
+
+void juceeq_get_response(const juceeq_settings* settings, double sampleRate,
+                         const double* freqs, double* magnitudes, int numFreqs)
+{
+    if (settings == nullptr || freqs == nullptr || magnitudes == nullptr || numFreqs <= 0 || !(sampleRate > 0.0))
+        return;
+
+    EqDesign::getFrequencyResponse(toChainSettings(*settings), sampleRate, freqs, magnitudes, numFreqs);
+}
@@ -0,0 +1,221 @@
+#include "Limiter.h"
+#include <cmath>
+
+// Hann-windowed sinc, interpolating between x[n-4] and x[n-3] from x[n-7..n]
+const LookaheadLimiter::TruePeakPhases& LookaheadLimiter::getTruePeakPhases()
+{
+    static const TruePeakPhases phases = []
+        {
+            TruePeakPhases p{};
+
+            for (int k = 0; k < 3; ++k)
+            {
+                const double frac = (double)(k + 1) / 4.0;
+                double sum = 0.0;
+                for (int j = 0; j < tpTaps; ++j)
+                {
+                    const double x = 3.0 + frac - (double)j;
+                    const double sinc = std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+                    const double hann = 0.5 * (1.0 + std::cos(juce::MathConstants<double>::pi * x / 4.0));
+                    p[(size_t)k][(size_t)j] = (float)(sinc * hann);
+                    sum += sinc * hann;
+                }
+
+                for (auto& t : p[(size_t)k])
+                    t = (float)(t / sum);
+            }
+
+            return p;
+        }();
+
+    return phases;
+}
+
+void LookaheadLimiter::prepare(double newSampleRate, int maxBlockSize, int numChannels)
+{
+    sampleRate = newSampleRate;
+    numChannelsPrepared = numChannels;
+    maxBlock = juce::jmax(1, maxBlockSize);
+    maxWindow = juce::jmax(1, (int)std::ceil(maxLookaheadMs * 0.001 * sampleRate));
+    tpStride = maxBlock + tpTaps - 1;
+}
+
+void LookaheadLimiter::allocate(DspArena& arena)
+{
+    const int maxDelay = maxWindow - 1 + truePeakDelay;
+    audioDelay.allocate(arena, numChannelsPrepared, maxDelay);
+    dryDelay.allocate(arena, numChannelsPrepared, maxDelay);
+
+    peakBuf = arena.take<float>((size_t)maxBlock);
+    gainBuf = arena.take<float>((size_t)maxBlock);
+    scratch = arena.take<float>((size_t)maxBlock);
+
+    dequeGain = arena.take<float>((size_t)maxWindow + 1);
+    dequeIndex = arena.take<juce::int64>((size_t)maxWindow + 1);
+    boxRing = arena.take<float>((size_t)maxWindow);
+
+    tpHistory = arena.take<float>((size_t)numChannelsPrepared * (size_t)tpStride);
+
+    if (arena.isMeasuring())
+        return;
+
+    window = 0; // Forces setSettings to recompute the window for this sample rate
+    setSettings(settings);
+    reset();
+}
+
+void LookaheadLimiter::reset()
+{
+    audioDelay.setLength(delaySamples);
+    dryDelay.setLength(delaySamples);
+    std::fill(tpHistory.begin(), tpHistory.end(), 0.0f);
+
+    dequeHead = 0;
+    dequeCount = 0;
+    sampleIndex = 0;
+
+    std::fill(boxRing.begin(), boxRing.end(), 1.0f);
+    boxPos = 0;
+    boxSum = (double)window;
+    smoothedGain = 1.0f;
+    gainReductionDb.store(0.0f);
+}
+
+void LookaheadLimiter::setSettings(const Settings& newSettings)
+{
+    const bool latencyChanged = newSettings.lookaheadMs != settings.lookaheadMs
+        || newSettings.truePeak != settings.truePeak
+        || window < 1;
+
+    settings = newSettings;
+    ceiling = juce::Decibels::decibelsToGain(settings.ceilingDb);
+
+    const double releaseSamples = juce::jmax(1.0, (double)settings.releaseMs * 0.001 * sampleRate);
+    releaseCoeff = (float)(1.0 - std::exp(-1.0 / releaseSamples));
+
+    if (latencyChanged || delaySamples != window - 1 + (settings.truePeak ? truePeakDelay : 0))
+    {
+        window = juce::jlimit(1, maxWindow, (int)std::round((double)settings.lookaheadMs * 0.001 * sampleRate));
+        delaySamples = window - 1 + (settings.truePeak ? truePeakDelay : 0);
+        reset();
+    }
+}
+
+// peakBuf[i] = loudest channel at sample i (4x interpolated when true-peak is on, unless oversampling is off)
+void LookaheadLimiter::detectPeaks(const float* const* channels, int numChannels, int numSamples)
+{
+    const int numCh = juce::jmin(numChannels, numChannelsPrepared);
+    juce::FloatVectorOperations::clear(peakBuf.data(), numSamples);
+
+    for (int ch = 0; ch < numCh; ++ch)
+    {
+        const float* in = channels[ch];
+
+        if (!settings.truePeak)
+        {
+            juce::FloatVectorOperations::abs(scratch.data(), in, numSamples);
+            juce::FloatVectorOperations::max(peakBuf.data(), peakBuf.data(), scratch.data(), numSamples);
+            continue;
+        }
+
+        // history (tpTaps - 1) + this block, so ext[i .. i + 7] = x[n - 7 .. n]
+        float* ext = tpHistory.data() + (size_t)ch * (size_t)tpStride;
+        juce::FloatVectorOperations::copy(ext + tpTaps - 1, in, numSamples);
+
+        // Phase 0 is the sample itself, x[n - 4]
+        juce::FloatVectorOperations::abs(scratch.data(), ext + 3, numSamples);
+        juce::FloatVectorOperations::max(peakBuf.data(), peakBuf.data(), scratch.data(), numSamples);
+
+        if (oversampleTruePeaks)
+        {
+            for (const auto& taps : getTruePeakPhases())
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    float y = 0.0f;
+                    for (int j = 0; j < tpTaps; ++j)
+                        y += taps[(size_t)j] * ext[i + j];
+                    scratch[(size_t)i] = std::abs(y);
+                }
+
+                juce::FloatVectorOperations::max(peakBuf.data(), peakBuf.data(), scratch.data(), numSamples);
+            }
+        }
+
+        // Keep the newest samples for the next block
+        std::copy(ext + numSamples, ext + numSamples + tpTaps - 1, ext);
+    }
+}
+
+// Required gain -> sliding minimum over the lookahead -> box average over the lookahead -> release
+void LookaheadLimiter::computeGain(int numSamples)
+{
+    const int cap = (int)dequeGain.size();
+    const float invWindow = 1.0f / (float)window;
+    float minGain = 1.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float peak = peakBuf[(size_t)i];
+        const float required = peak > ceiling ? ceiling / peak : 1.0f;
+
+        // Drop queued gains that can no longer be the minimum, then any that left the window
+        while (dequeCount > 0)
+        {
+            const int back = (dequeHead + dequeCount - 1) % cap;
+            if (dequeGain[(size_t)back] < required)
+                break;
+            --dequeCount;
+        }
+
+        const int slot = (dequeHead + dequeCount) % cap;
+        dequeGain[(size_t)slot] = required;
+        dequeIndex[(size_t)slot] = sampleIndex;
+        ++dequeCount;
+
+        while (dequeIndex[(size_t)dequeHead] <= sampleIndex - window)
+        {
+            dequeHead = (dequeHead + 1) % cap;
+            --dequeCount;
+        }
+
+        const float held = dequeGain[(size_t)dequeHead];
+
+        // Averaging the held gain over the same window ramps it down before the peak leaves the delay
+        boxSum += (double)held - (double)boxRing[(size_t)boxPos];
+        boxRing[(size_t)boxPos] = held;
+        if (++boxPos == window)
+            boxPos = 0;
+
+        const float target = juce::jmin(1.0f, (float)boxSum * invWindow);
+
+        // Attack follows the (already smooth) target, release eases back up
+        smoothedGain = target < smoothedGain ? target : smoothedGain + releaseCoeff * (target - smoothedGain);
+
+        gainBuf[(size_t)i] = smoothedGain;
+        minGain = juce::jmin(minGain, smoothedGain);
+        ++sampleIndex;
+    }
+
+    gainReductionDb.store(juce::Decibels::gainToDecibels(minGain));
+}
+
+void LookaheadLimiter::process(float* const* channels, int numChannels, int numSamples)
+{
+    const int numCh = juce::jmin(numChannels, numChannelsPrepared);
+
+    jassert(numSamples <= maxBlock);
+
+    detectPeaks(channels, numCh, numSamples);
+    computeGain(numSamples);
+
+    audioDelay.process(channels, numCh, numSamples);
+
+    for (int ch = 0; ch < numCh; ++ch)
+        juce::FloatVectorOperations::multiply(channels[ch], gainBuf.data(), numSamples);
+}
+
+void LookaheadLimiter::delayDry(float* const* channels, int numChannels, int numSamples)
+{
+    dryDelay.process(channels, juce::jmin(numChannels, numChannelsPrepared), numSamples);
+}
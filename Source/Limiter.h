@@ -0,0 +1,98 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+#include <span>
+#include "DelayLine.h"
+#include "DspArena.h"
+
+/**
+ * Brickwall lookahead limiter for the end of the chain.
+ * Gain is worked out from a sliding maximum of the (optionally 4x oversampled, "true") peaks, so the cost
+ * per sample doesn't depend on the lookahead length, then box-smoothed over the lookahead so it never
+ * overshoots the ceiling. Buffers are carved from the owner's DspArena in allocate(); process() never allocates,
+ * and blocks must not exceed the prepared size (the processor splits longer ones).
+ */
+class LookaheadLimiter
+{
+public:
+    static constexpr double maxLookaheadMs = 20.0;
+    static constexpr int truePeakDelay = 4; // Samples the 4x interpolator runs behind the input
+
+    struct Settings
+    {
+        float ceilingDb = -1.0f;
+        float lookaheadMs = 5.0f;
+        float releaseMs = 100.0f;
+        bool truePeak = true;
+
+        bool operator==(const Settings&) const = default;
+    };
+
+    void prepare(double sampleRate, int maxBlockSize, int numChannels); // Sizes only - memory comes from allocate()
+    void allocate(DspArena& arena); // Part of the owner's arena layout; resets once the memory is live
+    void reset();
+
+    // Ceiling and release apply straight away. Lookahead and true-peak changes alter the latency,
+    // so they reset the delay lines (no allocation).
+    void setSettings(const Settings& newSettings);
+
+    // With true-peak on, whether the detector interpolates 4x or reads the sample peaks at the same delay - the
+    // latency stays the same either way, so it can change between any two blocks (see CpuGovernor)
+    void setTruePeakOversampling(bool shouldOversample) { oversampleTruePeaks = shouldOversample; }
+
+    int getLatencySamples() const { return delaySamples; }
+    float getGainReductionDb() const { return gainReductionDb.load(); }
+
+    void process(float* const* channels, int numChannels, int numSamples); // In place, delays by getLatencySamples()
+
+    // Keeps a dry (bypassed) signal time-aligned with the limited one
+    void delayDry(float* const* channels, int numChannels, int numSamples);
+
+private:
+    // 4x windowed-sinc interpolator, 8 taps per phase - the same for every instance
+    static constexpr int tpTaps = 8;
+    using TruePeakPhases = std::array<std::array<float, tpTaps>, 3>; // Phases 1/4, 2/4 and 3/4 (phase 0 is the sample itself)
+    static const TruePeakPhases& getTruePeakPhases();
+
+    void detectPeaks(const float* const* channels, int numChannels, int numSamples);
+    void computeGain(int numSamples);
+
+    double sampleRate = 44100.0;
+    int maxWindow = 1;
+    int maxBlock = 1;
+    int numChannelsPrepared = 0;
+
+    Settings settings;
+    bool oversampleTruePeaks = true;
+    float ceiling = 0.89f; // Linear
+    float releaseCoeff = 0.0f;
+
+    int window = 1; // Lookahead samples (sliding window length)
+    int delaySamples = 0;
+
+    DelayLine audioDelay, dryDelay;
+
+    // Per-block scratch
+    std::span<float> peakBuf, gainBuf, scratch;
+
+    // Sliding minimum of the required gain (monotonic deque over a ring)
+    std::span<float> dequeGain;
+    std::span<juce::int64> dequeIndex;
+    int dequeHead = 0, dequeCount = 0;
+    juce::int64 sampleIndex = 0;
+
+    // Box (moving average) smoothing of the held gain
+    std::span<float> boxRing;
+    int boxPos = 0;
+    double boxSum = 0.0;
+
+    float smoothedGain = 1.0f;
+
+    // True-peak detection - last (tpTaps - 1) input samples ahead of each block, per channel
+    std::span<float> tpHistory;
+    int tpStride = tpTaps;
+
+    std::atomic<float> gainReductionDb{ 0.0f };
+};
@@ -0,0 +1,37 @@
+#include "MessageThreadPoller.h"
+
+MessageThreadPoller::~MessageThreadPoller()
+{
+    stopTimer();
+}
+
+void MessageThreadPoller::addClient(Client& client)
+{
+    const juce::ScopedLock sl(lock);
+    clients.addIfNotAlreadyThere(&client);
+
+    if (!isTimerRunning())
+        startTimerHz(pollHz);
+}
+
+void MessageThreadPoller::removeClient(Client& client)
+{
+    const juce::ScopedLock sl(lock);
+    clients.removeFirstMatchingValue(&client);
+
+    if (clients.isEmpty())
+        stopTimer();
+}
+
+void MessageThreadPoller::timerCallback()
+{
+    const juce::ScopedLock sl(lock);
+
+    // A client's handler may add or remove clients (the lock is re-entrant), so index rather than iterate
+    for (int i = 0; i < clients.size(); ++i)
+    {
+        auto* client = clients.getUnchecked(i);
+        if (client->pending.exchange(false, std::memory_order_acquire) || client->checkForChange())
+            client->handlePendingChange();
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+#include <atomic>
+
+/**
+ * One message-thread timer shared by every instance in the process, for changes made on the audio thread that the
+ * message thread has to act on. Posting a message from the audio thread takes a lock and can make a system call, so
+ * the audio thread only calls markPending() on its client; each tick handles just the clients with that flag set
+ * (or whose checkForChange() finds something).
+ * Hold it through juce::SharedResourcePointer - the timer runs while at least one client is registered.
+ */
+class MessageThreadPoller : private juce::Timer
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // Any thread, lock-free - asks for handlePendingChange() on the next tick
+        void markPending() noexcept { pending.store(true, std::memory_order_release); }
+
+    protected:
+        virtual void handlePendingChange() = 0; // Message thread
+
+        // Message thread, every tick - for state the client can compare cheaply itself (a version counter) rather
+        // than have flagged. True asks for handlePendingChange() as markPending() does.
+        virtual bool checkForChange() { return false; }
+
+    private:
+        friend class MessageThreadPoller;
+        std::atomic<bool> pending{ false };
+    };
+
+    MessageThreadPoller() = default;
+    ~MessageThreadPoller() override;
+
+    // Not real-time safe. A client must remove itself before it's destroyed.
+    void addClient(Client&);
+    void removeClient(Client&);
+
+    static constexpr int pollHz = 10;
+
+private:
+    void timerCallback() override;
+
+    juce::CriticalSection lock; // Guards clients - never taken on the audio thread
+    juce::Array<Client*> clients;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MessageThreadPoller)
+};
@@ -0,0 +1,278 @@
+#include "MultirateSplit.h"
+#include <cmath>
+#include <complex>
+
+namespace
+{
+    // Modified Bessel function of the first kind, order 0 - for the Kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 64 && term > 1.0e-12 * sum; ++k)
+        {
+            term *= (x * x) / (4.0 * k * k);
+            sum += term;
+        }
+        return sum;
+    }
+}
+
+int MultirateSplit::factorFor(double sampleRate)
+{
+    int f = 1;
+    while (f < (1 << maxStages) && sampleRate / (2 * f) >= minLowRate)
+        f *= 2;
+
+    return f >= 4 ? f : 1;
+}
+
+double MultirateSplit::deviation(const double (&coeffs)[5], double freqHz, double sampleRate)
+{
+    const double w = juce::MathConstants<double>::twoPi * freqHz / sampleRate;
+    const std::complex<double> z1 = std::polar(1.0, -w), z2 = z1 * z1;
+    const auto h = (coeffs[0] + coeffs[1] * z1 + coeffs[2] * z2) / (1.0 + coeffs[3] * z1 + coeffs[4] * z2);
+    return std::abs(h - 1.0);
+}
+
+// Kaiser-windowed sinc at a quarter of the input rate, as short as the transition band and stopbandDb allow.
+// Lengths are 4k + 3, which puts the centre tap on an odd offset and keeps the taps symmetric about it.
+MultirateSplit::Halfband MultirateSplit::design(double transitionWidth)
+{
+    const double taps = (stopbandDb - 7.95) / (14.36 * transitionWidth) + 1.0;
+    const int k = juce::jlimit(0, maxSideTaps - 1, (int)std::ceil((taps - 3.0) / 4.0));
+    const double beta = 0.1102 * (stopbandDb - 8.7);
+    const int center = 2 * k + 1;
+
+    Halfband hb;
+    hb.numTaps = 4 * k + 3;
+    hb.numSide = k + 1;
+
+    double sum = 0.0;
+    for (int m = 0; m < hb.numSide; ++m)
+    {
+        const double t = 2 * m + 1; // Offset from the centre
+        const double r = t / center;
+        const double window = besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+        const double sinc = std::sin(juce::MathConstants<double>::halfPi * t) / (juce::MathConstants<double>::halfPi * t);
+        hb.side[(size_t)m] = (float)(0.5 * sinc * window);
+        sum += 0.5 * sinc * window;
+    }
+
+    // Unity at DC: the centre's 1/2 plus both sides
+    for (int m = 0; m < hb.numSide; ++m)
+        hb.side[(size_t)m] = (float)(hb.side[(size_t)m] * 0.25 / sum);
+
+    return hb;
+}
+
+void MultirateSplit::prepare(double sampleRate, int maxBlockSize, int numChannels)
+{
+    factor = numChannels > 0 ? factorFor(sampleRate) : 1;
+    numStages = 0;
+    while ((1 << numStages) < factor)
+        ++numStages;
+
+    lowRate = sampleRate / factor;
+    maxBlock = juce::jmax(1, maxBlockSize);
+    numChannelsPrepared = isActive() ? numChannels : 0;
+    lowBandInUse = false;
+
+    // Each stage passes up to the final passband edge and stops everything that would fold back onto it;
+    // the early stages run at high rates with wide transitions, so they're short
+    const double edge = passbandEdge * lowRate;
+    latency = 0;
+
+    for (int s = 0; s < numStages; ++s)
+    {
+        const double inputRate = sampleRate / (1 << s);
+        stages[(size_t)s] = design(0.5 - 2.0 * edge / inputRate);
+        latency += (stages[(size_t)s].numTaps - 1) << s; // Down and back up, centre tap to centre tap
+    }
+}
+
+void MultirateSplit::allocate(DspArena& arena)
+{
+    channels = arena.take<Channel>((size_t)numChannelsPrepared);
+
+    // Taken channel by channel whether or not the arena is measuring, so both passes see the same layout
+    const size_t lowLength = (size_t)(maxBlock / factor + 2);
+    for (int ch = 0; ch < numChannelsPrepared; ++ch)
+    {
+        Channel c;
+        for (int s = 0; s < numStages; ++s)
+        {
+            const auto& hb = stages[(size_t)s];
+            c.decimator[(size_t)s].length = hb.numTaps;
+            c.decimator[(size_t)s].data = arena.take<float>((size_t)(2 * hb.numTaps));
+            c.interpolator[(size_t)s].length = (hb.numTaps + 1) / 2;
+            c.interpolator[(size_t)s].data = arena.take<float>((size_t)(hb.numTaps + 1));
+        }
+
+        c.lowBand = arena.take<float>(lowLength);
+        c.change = arena.take<float>(lowLength);
+        c.scratchA = arena.take<float>((size_t)maxBlock + 1); // Full rate, 1/4, 1/16
+        c.scratchB = arena.take<float>((size_t)maxBlock / 2 + 2); // 1/2, 1/8
+
+        if (!arena.isMeasuring())
+            channels[(size_t)ch] = c;
+    }
+
+    delay.allocate(arena, numChannelsPrepared, latency);
+    dryDelay.allocate(arena, numChannelsPrepared, latency);
+
+    if (!arena.isMeasuring())
+        reset();
+}
+
+void MultirateSplit::History::clear()
+{
+    std::fill(data.begin(), data.end(), 0.0f);
+    pos = 0;
+}
+
+void MultirateSplit::reset()
+{
+    resetLowBand();
+    delay.setLength(latency);
+    dryDelay.setLength(latency);
+    samplesSplit = 0;
+}
+
+void MultirateSplit::resetLowBand()
+{
+    for (auto& c : channels)
+    {
+        for (int s = 0; s < numStages; ++s)
+        {
+            c.decimator[(size_t)s].clear();
+            c.interpolator[(size_t)s].clear();
+        }
+        c.numLow = 0;
+    }
+}
+
+void MultirateSplit::setLowBandInUse(bool shouldBeInUse)
+{
+    if (shouldBeInUse && !lowBandInUse)
+        resetLowBand();
+
+    lowBandInUse = shouldBeInUse;
+}
+
+// Keeps the odd-indexed outputs: output j is ready once input 2j + 1 has arrived, so every stage stays causal
+// and a block's outputs at each rate are known from the sample count alone
+int MultirateSplit::decimate(const Halfband& hb, History& history, const float* in, int numIn, juce::uint64 firstIndex, float* out)
+{
+    const int center = hb.numTaps / 2;
+    int numOut = 0;
+
+    for (int i = 0; i < numIn; ++i)
+    {
+        history.push(in[i]);
+        if (((firstIndex + (juce::uint64)i) & 1) == 0)
+            continue;
+
+        const float* x = history.oldest(); // x[numTaps - 1] is the newest
+        float sum = 0.5f * x[center];
+        for (int m = 0; m < hb.numSide; ++m)
+            sum += hb.side[(size_t)m] * (x[center - 2 * m - 1] + x[center + 2 * m + 1]);
+
+        out[numOut++] = sum;
+    }
+
+    return numOut;
+}
+
+// The mirror image: each low-rate input lands on an odd output index. Even outputs only see the centre tap,
+// so they're a delayed input; odd outputs take the side taps.
+void MultirateSplit::interpolate(const Halfband& hb, History& history, const float* in, float* out, int numOut, juce::uint64 firstIndex)
+{
+    const int k = hb.numSide - 1;
+
+    for (int i = 0; i < numOut; ++i)
+    {
+        if (((firstIndex + (juce::uint64)i) & 1) == 0)
+        {
+            out[i] = history.oldest()[k + 1];
+            continue;
+        }
+
+        history.push(*in++);
+
+        const float* y = history.oldest(); // y[2k + 1] is the newest
+        float sum = 0.0f;
+        for (int m = 0; m < hb.numSide; ++m)
+            sum += hb.side[(size_t)m] * (y[k + 1 + m] + y[k - m]);
+
+        out[i] = 2.0f * sum;
+    }
+}
+
+void MultirateSplit::split(float* const* data, int numChannels, int numSamples)
+{
+    if (!isActive())
+        return;
+
+    numChannels = juce::jmin(numChannels, numChannelsPrepared);
+
+    const auto end = samplesSplit + (juce::uint64)numSamples;
+    for (int s = 0; s <= numStages; ++s)
+    {
+        blockStart[(size_t)s] = samplesSplit >> s;
+        blockLength[(size_t)s] = (int)((end >> s) - (samplesSplit >> s));
+    }
+    samplesSplit = end;
+
+    for (int ch = 0; ch < numChannels && lowBandInUse; ++ch)
+    {
+        auto& c = channels[(size_t)ch];
+        const float* in = data[ch];
+        int numIn = numSamples;
+
+        for (int s = 0; s < numStages; ++s)
+        {
+            float* out = s + 1 == numStages ? c.lowBand.data() : (s % 2 == 0 ? c.scratchB.data() : c.scratchA.data());
+            numIn = decimate(stages[(size_t)s], c.decimator[(size_t)s], in, numIn, blockStart[(size_t)s], out);
+            in = out;
+        }
+
+        jassert(numIn == blockLength[(size_t)numStages]);
+        c.numLow = numIn;
+    }
+
+    delay.process(data, numChannels, numSamples);
+}
+
+std::span<const float> MultirateSplit::getLowBand(int channel) const
+{
+    const auto& c = channels[(size_t)channel];
+    return { c.lowBand.data(), (size_t)c.numLow };
+}
+
+std::span<float> MultirateSplit::getChangeBuffer(int channel)
+{
+    const auto& c = channels[(size_t)channel];
+    return { c.change.data(), (size_t)c.numLow };
+}
+
+void MultirateSplit::addChange(int channel, float* data, int numSamples)
+{
+    auto& c = channels[(size_t)channel];
+    jassert(numSamples == blockLength[0]);
+
+    const float* in = c.change.data();
+    for (int s = numStages - 1; s >= 0; --s)
+    {
+        float* out = s % 2 == 0 ? c.scratchA.data() : c.scratchB.data();
+        interpolate(stages[(size_t)s], c.interpolator[(size_t)s], in, out, blockLength[(size_t)s], blockStart[(size_t)s]);
+        in = out;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+        data[i] += in[i];
+}
+
+void MultirateSplit::delayDry(float* const* data, int numChannels, int numSamples)
+{
+    dryDelay.process(data, juce::jmin(numChannels, numChannelsPrepared), numSamples);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <span>
+#include "DelayLine.h"
+#include "DspArena.h"
+
+/**
+ * Runs the low-frequency sections at 1/4 to 1/16 of the sample rate (96 kHz and up), where they're far better
+ * conditioned than at the full rate - and, once there are a few of them, cheaper than the split itself costs.
+ * The input is decimated through a cascade of linear-phase halfband FIRs to the low rate (about 24 kHz) and delayed
+ * by the cascade's round-trip latency at the full rate. The low sections run on the decimated copy, and only their
+ * change - processed minus unprocessed - is interpolated back up and added to the delayed signal. The split is
+ * complementary: with no change the output is exactly the delayed input, and the halfbands only shape the change.
+ * That change has to have died away by the low band's passband edge (see maxDeviation) - sections that haven't
+ * stay at the full rate. Latency is constant while prepared, whichever sections are moved.
+ * Buffers come from the owner's DspArena; blocks must not exceed the prepared size.
+ */
+class MultirateSplit
+{
+public:
+    static constexpr int maxStages = 4; // Factor 16
+    static constexpr double minLowRate = 22050.0;
+    static constexpr double passbandEdge = 0.4; // Of the low rate - where the halfbands start rolling off
+    static constexpr double stopbandDb = 120.0;
+
+    // Summed |H - 1| of the moved sections at the passband edge - above it the change is reproduced only partly,
+    // so this bounds the response error (0.01 is under 0.09 dB)
+    static constexpr double maxDeviation = 0.01;
+
+    // 4, 8 or 16 - the largest that keeps the low rate above minLowRate - or 1 (no split) below 88.2 kHz
+    static int factorFor(double sampleRate);
+
+    // |H(e^jw) - 1| of TDF-II coefficients { b0, b1, b2, a1, a2 } at freqHz - how far a section is from a wire
+    static double deviation(const double (&coeffs)[5], double freqHz, double sampleRate);
+
+    // Sizes only - memory comes from allocate(). No channels (or a rate below 88.2 kHz) leaves it inactive.
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    void allocate(DspArena& arena); // Part of the owner's arena layout; resets once the memory is live
+    void reset(); // Filter histories and delays
+    void resetLowBand(); // Filter histories only - the delays keep the signal that's in flight
+
+    // With no sections moved there's nothing to decimate - split() only delays. Switching it back on starts the
+    // halfbands from silence, like the sections that just moved.
+    void setLowBandInUse(bool shouldBeInUse);
+    bool isLowBandInUse() const { return lowBandInUse; }
+
+    bool isActive() const { return factor > 1; }
+    int getFactor() const { return factor; }
+    double getLowRate() const { return lowRate; }
+    double getPassbandEdgeHz() const { return passbandEdge * lowRate; }
+    int getLatencySamples() const { return latency; }
+
+    // Audio thread, once per block for all channels: decimates each channel into its low band (while it's in use)
+    // and delays it in place by getLatencySamples()
+    void split(float* const* channels, int numChannels, int numSamples);
+
+    // The last split()'s low band for a channel - the low sections process a copy of it into 'change' (see below)
+    std::span<const float> getLowBand(int channel) const;
+    std::span<float> getChangeBuffer(int channel);
+
+    // Interpolates 'change' (processed minus unprocessed low band, getLowBand().size() samples) and adds it to the
+    // channel's delayed block. Any channel, any thread - each channel's state is its own.
+    void addChange(int channel, float* data, int numSamples);
+
+    // Keeps a dry signal time-aligned with the split one
+    void delayDry(float* const* channels, int numChannels, int numSamples);
+
+private:
+    static constexpr int maxSideTaps = 32; // Per side, so up to 127 taps
+
+    // Halfband FIR: h[center] = 1/2, side[m] at center +- (2m + 1), zero at every other offset
+    struct Halfband
+    {
+        int numTaps = 3;
+        int numSide = 1;
+        std::array<float, maxSideTaps> side{};
+    };
+
+    static Halfband design(double transitionWidth); // Normalised to the input rate
+
+    // Per stage and channel: the last numTaps inputs (decimator) and the last (numTaps + 1) / 2 low-rate inputs
+    // (interpolator), each written twice so the taps read one contiguous run
+    struct History
+    {
+        std::span<float> data;
+        int length = 0;
+        int pos = 0;
+
+        void push(float x)
+        {
+            data[(size_t)pos] = data[(size_t)(pos + length)] = x;
+            pos = pos + 1 == length ? 0 : pos + 1;
+        }
+
+        const float* oldest() const { return data.data() + pos; }
+        void clear();
+    };
+
+    struct Channel
+    {
+        std::array<History, maxStages> decimator, interpolator;
+        std::span<float> lowBand, change, scratchA, scratchB;
+        int numLow = 0;
+    };
+
+    static int decimate(const Halfband& hb, History& history, const float* in, int numIn, juce::uint64 firstIndex, float* out);
+    static void interpolate(const Halfband& hb, History& history, const float* in, float* out, int numOut, juce::uint64 firstIndex);
+
+    int factor = 1;
+    int numStages = 0;
+    double lowRate = 0.0;
+    int latency = 0;
+    int maxBlock = 1;
+    int numChannelsPrepared = 0;
+    bool lowBandInUse = false;
+
+    std::array<Halfband, maxStages> stages{};
+    std::span<Channel> channels;
+    DelayLine delay, dryDelay;
+
+    // Samples split so far, and the current block's first index and sample count at each rate (0 = full)
+    juce::uint64 samplesSplit = 0;
+    std::array<juce::uint64, maxStages + 1> blockStart{};
+    std::array<int, maxStages + 1> blockLength{};
+};
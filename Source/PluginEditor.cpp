@@ -2,6 +2,9 @@
 #include "PluginProcessor.h"
 #include "EqGraphComponent.h"
 #include "BandControlsComponent.h"
+#include "AutoFit.h"
+#include "PresetBrowserComponent.h"
+#include "CpuGovernor.h"
 
 // Layout constants for I/O rails
 // Ensure faderWidth >= textBoxWidth to prevent clipping the I/O sliders' text boxes
@@ -58,6 +61,29 @@ JuceEQAudioProcessorEditor::JuceEQAudioProcessorEditor(JuceEQAudioProcessor& p)
     controlsViewport.setScrollOnDragEnabled(true);
     addAndMakeVisible(controlsViewport);
 
+    matchButton.setTooltip("Fit the EQ to a target curve (.csv/.txt) or a reference audio file");
+    matchButton.onClick = [this]() { chooseMatchTarget(); };
+    addAndMakeVisible(matchButton);
+
+    presetsButton.setTooltip("Browse, search and save presets");
+    presetsButton.setClickingTogglesState(true);
+    presetsButton.onClick = [this]() { togglePresetBrowser(); };
+    addAndMakeVisible(presetsButton);
+
+    bypassAttach = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(processor.apvts, "bypass", bypassButton);
+    addAndMakeVisible(bypassButton);
+
+    qualityLabel.setColour(juce::Label::textColourId, juce::Colours::orange);
+    qualityLabel.setTooltip("The CPU governor has reduced quality to keep up with the audio deadline");
+    addChildComponent(qualityLabel);
+
+    if (auto* tierParam = processor.apvts.getParameter("qualityTier"))
+    {
+        qualityAttach = std::make_unique<juce::ParameterAttachment>(*tierParam,
+            [this](float tier) { showQualityTier(juce::roundToInt(tier)); });
+        qualityAttach->sendInitialUpdate();
+    }
+
     setResizable(true, true);
     setSize(1250, 760);
 }
@@ -104,6 +130,11 @@ void JuceEQAudioProcessorEditor::resized()
     // For EQ graph and EQ filter & band controls
     auto bottom = bounds.removeFromBottom(280);
     graph->setBounds(bounds);
+    matchButton.setBounds(bounds.getX() + 58, bounds.getY() + 16, 84, 22); // Top-left corner of the plot
+    presetsButton.setBounds(matchButton.getRight() + 8, matchButton.getY(), 84, 22);
+    bypassButton.setBounds(presetsButton.getRight() + 8, matchButton.getY(), 80, 22);
+    qualityLabel.setBounds(bypassButton.getRight() + 8, matchButton.getY(), 200, 22);
+    layoutPresetBrowser();
 
     controlsViewport.setBounds(bottom);
     const int prefH = BandControlsComponent::preferredHeight();
@@ -111,6 +142,82 @@ void JuceEQAudioProcessorEditor::resized()
     bandControls->setSize(visibleW, prefH);
 }
 
+void JuceEQAudioProcessorEditor::chooseMatchTarget()
+{
+    matchChooser = std::make_unique<juce::FileChooser>("Choose a target curve or reference file", juce::File(),
+        "*.csv;*.txt;*.wav;*.aif;*.aiff;*.flac");
+
+    matchChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this](const juce::FileChooser& chooser)
+        {
+            const auto file = chooser.getResult();
+            if (file.existsAsFile())
+                startAutoFit(file);
+        });
+}
+
+// Runs the fit on a background thread, then writes the result into the parameters on the message thread
+void JuceEQAudioProcessorEditor::startAutoFit(const juce::File& file)
+{
+    EqAutoFit::Options options;
+    options.sampleRate = processor.getSampleRate() > 0.0 ? processor.getSampleRate() : 48000.0;
+
+    // Keep the user's chosen slopes
+    if (auto* p = processor.apvts.getRawParameterValue("hpfSlope")) options.hpfSlopeIndex = (int)p->load();
+    if (auto* p = processor.apvts.getRawParameterValue("lpfSlope")) options.lpfSlopeIndex = (int)p->load();
+
+    matchButton.setEnabled(false);
+    matchButton.setButtonText("Fitting...");
+
+    juce::Thread::launch([safeThis = juce::Component::SafePointer<JuceEQAudioProcessorEditor>(this), file, options]()
+        {
+            const auto target = EqAutoFit::loadTarget(file);
+            const auto result = EqAutoFit::fit(target, options);
+            const bool valid = target.isValid();
+
+            juce::MessageManager::callAsync([safeThis, result, valid]()
+                {
+                    if (safeThis == nullptr)
+                        return;
+
+                    if (valid)
+                        EqAutoFit::applyToParameters(result, safeThis->processor.apvts);
+
+                    safeThis->matchButton.setButtonText("Match...");
+                    safeThis->matchButton.setEnabled(true);
+                });
+        });
+}
+
+void JuceEQAudioProcessorEditor::showQualityTier(int tier)
+{
+    qualityLabel.setText(juce::String("Reduced quality: ") + CpuGovernor::getTierName(tier), juce::dontSendNotification);
+    qualityLabel.setVisible(tier != CpuGovernor::full);
+}
+
+void JuceEQAudioProcessorEditor::togglePresetBrowser()
+{
+    if (presetBrowser == nullptr)
+    {
+        presetBrowser = std::make_unique<PresetBrowserComponent>(processor);
+        addChildComponent(*presetBrowser);
+        layoutPresetBrowser();
+    }
+
+    presetBrowser->setVisible(presetsButton.getToggleState());
+}
+
+// Right-hand side of the plot, below the buttons
+void JuceEQAudioProcessorEditor::layoutPresetBrowser()
+{
+    if (presetBrowser == nullptr)
+        return;
+
+    const auto plot = graph->getBounds();
+    presetBrowser->setBounds(plot.withTrimmedTop(46).withTrimmedBottom(8).withTrimmedRight(8)
+                                 .withLeft(juce::jmax(plot.getX() + 8, plot.getRight() - 8 - 420)));
+}
+
 juce::AudioProcessorEditor* createEQEditor(JuceEQAudioProcessor& p)
 {
     return new JuceEQAudioProcessorEditor(p);
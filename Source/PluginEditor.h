@@ -7,6 +7,7 @@
 class JuceEQAudioProcessor;
 class EqGraphComponent;
 class BandControlsComponent;
+class PresetBrowserComponent;
 
 class JuceEQAudioProcessorEditor : public juce::AudioProcessorEditor
 {
@@ -32,6 +33,26 @@ private:
     juce::Viewport controlsViewport;
     std::unique_ptr<BandControlsComponent> bandControls;
 
+    juce::ToggleButton bypassButton{ "Bypass" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> bypassAttach;
+
+    // Shows the CPU governor's tier while it's below full quality
+    juce::Label qualityLabel;
+    std::unique_ptr<juce::ParameterAttachment> qualityAttach;
+    void showQualityTier(int tier);
+
+    // Auto-fit to a target curve (.csv/.txt) or a reference audio file
+    juce::TextButton matchButton{ "Match..." };
+    std::unique_ptr<juce::FileChooser> matchChooser;
+    void chooseMatchTarget();
+    void startAutoFit(const juce::File& file);
+
+    // Preset browser over the right of the plot - created on first use, so the library isn't touched before then
+    juce::TextButton presetsButton{ "Presets..." };
+    std::unique_ptr<PresetBrowserComponent> presetBrowser;
+    void togglePresetBrowser();
+    void layoutPresetBrowser();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JuceEQAudioProcessorEditor)
 };
 
@@ -5,51 +5,172 @@ extern juce::AudioProcessorEditor* createEQEditor(JuceEQAudioProcessor&);
 
 using namespace EqConstants;
 
-static juce::StringArray slopeChoices() { return { "6 dB", "12 dB", "24 dB", "48 dB" }; }
 static constexpr int defaultSlopeIndex = 0; // Default to 6 dB
 
+// Immutable data shared by every instance - juce::String copies only bump a reference count
+static const juce::StringArray& slopeChoices()
+{
+    static const juce::StringArray choices{ "6 dB", "12 dB", "24 dB", "48 dB" };
+    return choices;
+}
+
+struct BandParamIds
+{
+    juce::String enabled, freq, gain, q;
+};
+
+static const juce::StringArray& eqModeChoices()
+{
+    static const juce::StringArray choices{ "Parametric", "Graphic" };
+    return choices;
+}
+
+static const juce::StringArray& graphicLayoutChoices()
+{
+    static const juce::StringArray choices{ "31-band", "10-band" };
+    return choices;
+}
+
+static const juce::StringArray& qualityTierChoices()
+{
+    static const juce::StringArray choices = []
+        {
+            juce::StringArray names;
+            for (int tier = 0; tier < CpuGovernor::numTiers; ++tier)
+                names.add(CpuGovernor::getTierName(tier));
+            return names;
+        }();
+
+    return choices;
+}
+
+static const juce::StringArray& graphicQChoices()
+{
+    static const juce::StringArray choices{ "Constant Q", "Proportional Q" };
+    return choices;
+}
+
+static const std::array<BandParamIds, maxEqBands>& bandParamIds()
+{
+    static const auto ids = []
+        {
+            std::array<BandParamIds, maxEqBands> a;
+            for (int b = 0; b < maxEqBands; ++b)
+                a[b] = { eqBandParamType(b + 1, "enabled"), eqBandParamType(b + 1, "freq"),
+                         eqBandParamType(b + 1, "gain"), eqBandParamType(b + 1, "q") };
+            return a;
+        }();
+
+    return ids;
+}
+
 JuceEQAudioProcessor::JuceEQAudioProcessor()
     : AudioProcessor(BusesProperties()
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
         .withOutput("Output", juce::AudioChannelSet::stereo(), true))
     , apvts(*this, nullptr, "PARAMS", createParameterLayout())
 {
-
-    // HPF and LPF base coeffs before first plugin window render
-    auto initFilterCoeffs = new IIRBiquadCoeffs(1, 0, 0, 1, 0, 0);
-
-    for (int i = 0; i < maxFilterStages; ++i)
-    {
-        hpfCoeffs[i] = initFilterCoeffs;
-        lpfCoeffs[i] = initFilterCoeffs;
-        hpfL[i].coefficients = initFilterCoeffs;
-        hpfR[i].coefficients = initFilterCoeffs;
-        lpfL[i].coefficients = initFilterCoeffs;
-        lpfR[i].coefficients = initFilterCoeffs;
-    }
+    rawParams.inGain = apvts.getRawParameterValue("inGain");
+    rawParams.outGain = apvts.getRawParameterValue("outGain");
+    rawParams.hpfEnabled = apvts.getRawParameterValue("hpfEnabled");
+    rawParams.hpfFreq = apvts.getRawParameterValue("hpfFreq");
+    rawParams.hpfSlope = apvts.getRawParameterValue("hpfSlope");
+    rawParams.lpfEnabled = apvts.getRawParameterValue("lpfEnabled");
+    rawParams.lpfFreq = apvts.getRawParameterValue("lpfFreq");
+    rawParams.lpfSlope = apvts.getRawParameterValue("lpfSlope");
+    rawParams.limiterEnabled = apvts.getRawParameterValue("limiterEnabled");
+    rawParams.limiterCeiling = apvts.getRawParameterValue("limiterCeiling");
+    rawParams.limiterLookahead = apvts.getRawParameterValue("limiterLookahead");
+    rawParams.limiterRelease = apvts.getRawParameterValue("limiterRelease");
+    rawParams.limiterTruePeak = apvts.getRawParameterValue("limiterTruePeak");
 
     for (int b = 0; b < maxEqBands; ++b)
     {
-        peakCoeffs[b] = initFilterCoeffs;
-        peaksL[b].coefficients = initFilterCoeffs;
-        peaksR[b].coefficients = initFilterCoeffs;
+        const auto& ids = bandParamIds()[b];
+        rawParams.bands[b] = { apvts.getRawParameterValue(ids.enabled), apvts.getRawParameterValue(ids.freq),
+                               apvts.getRawParameterValue(ids.gain), apvts.getRawParameterValue(ids.q) };
     }
 
-    // Prevents zipping noises when moving I/O faders
-    inputGain.setRampDurationSeconds(0.02);
-    outputGain.setRampDurationSeconds(0.02);
+    rawParams.eqMode = apvts.getRawParameterValue("eqMode");
+    rawParams.graphicLayout = apvts.getRawParameterValue("geqLayout");
+    rawParams.graphicQ = apvts.getRawParameterValue("geqQ");
+
+    for (int b = 0; b < GraphicEq::numThirdOctaveBands; ++b)
+        rawParams.graphicThirdOctave[(size_t)b] = apvts.getRawParameterValue(GraphicEq::getParamId(GraphicEq::Layout::thirdOctave, b));
+
+    for (int b = 0; b < GraphicEq::numOctaveBands; ++b)
+        rawParams.graphicOctave[(size_t)b] = apvts.getRawParameterValue(GraphicEq::getParamId(GraphicEq::Layout::octave, b));
+
+    // Picks the DSP kernel variant now rather than on the first audio callback
+    DspKernels::get();
+
+    // Filter engine - the build's default unless JUCEEQ_ENGINE says otherwise
+    const auto engineName = juce::SystemStats::getEnvironmentVariable("JUCEEQ_ENGINE", {});
+    if (engineName == "fixed")
+        chain.setEngine(Engine::fixedPoint);
+    else if (engineName == "float")
+        chain.setEngine(Engine::floatingPoint);
+
+    chain.setMultirateEnabled(juce::SystemStats::getEnvironmentVariable("JUCEEQ_MULTIRATE", {}) == "on");
+
+    const auto blockFiltersName = juce::SystemStats::getEnvironmentVariable("JUCEEQ_BLOCK_FILTERS", {});
+    if (blockFiltersName == "on")
+        chain.setBlockFilters(BlockFilters::on);
+    else if (blockFiltersName == "off")
+        chain.setBlockFilters(BlockFilters::off);
+
+    bypassParam = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter("bypass"));
+    qualityTierParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("qualityTier"));
+
+    // Starts a trace if JUCEEQ_TRACE is set (see Trace.h)
+    EqTrace::getInstance().acquireFromEnvironment();
+
+    // Records this instance's session if JUCEEQ_CAPTURE is set
+    capture = SessionCapture::createFromEnvironment(apvts, DspKernels::get().name);
+
+    // Publishes this instance's meters and timing if JUCEEQ_TELEMETRY is set (see Telemetry.h)
+    telemetry = TelemetryPublisher::createFromEnvironment(DspKernels::get().name);
+    if (telemetry != nullptr)
+        telemetry->setNames(juce::PluginHostType().getHostDescription(), {});
+    chain.setTelemetry(telemetry.get());
+
+    // Latency and tier changes are flagged by the audio thread and reported from the shared poll (see processHostBlock)
+    poller->addClient(*this);
+}
+
+JuceEQAudioProcessor::~JuceEQAudioProcessor()
+{
+    poller->removeClient(*this);
+    chain.stop();
+    chain.setTelemetry(nullptr);
+    capture.reset();
+    telemetry.reset();
+    EqTrace::getInstance().releaseFromEnvironment();
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout JuceEQAudioProcessor::createParameterLayout()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
 
+    // Plugin bypass (reported to the host through getBypassParameter)
+    params.push_back(std::make_unique<juce::AudioParameterBool>("bypass", "Bypass", false));
+
     // For I/O gain 
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "inGain", "Input", juce::NormalisableRange<float>(-60.0f, 10.0f, 0.01f), 0.0f));
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "outGain", "Output", juce::NormalisableRange<float>(-60.0f, 10.0f, 0.01f), 0.0f));
 
+    // Output limiter
+    params.push_back(std::make_unique<juce::AudioParameterBool>("limiterEnabled", "Limiter Enabled", false));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "limiterCeiling", "Limiter Ceiling", juce::NormalisableRange<float>(-24.0f, 0.0f, 0.01f), -1.0f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "limiterLookahead", "Limiter Lookahead", juce::NormalisableRange<float>(0.1f, (float)LookaheadLimiter::maxLookaheadMs, 0.01f, 0.5f), 5.0f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "limiterRelease", "Limiter Release", juce::NormalisableRange<float>(1.0f, 1000.0f, 0.01f, 0.4f), 100.0f));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("limiterTruePeak", "Limiter True Peak", true));
+
     // HPF 
     params.push_back(std::make_unique<juce::AudioParameterBool>("hpfEnabled", "HPF Enabled", true));
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
@@ -69,67 +190,86 @@ juce::AudioProcessorValueTreeState::ParameterLayout JuceEQAudioProcessor::create
     {
         const bool enabledDefault = (i <= 3); // Default 3 bands
 
+        const auto& ids = bandParamIds()[i - 1];
+
         params.push_back(std::make_unique<juce::AudioParameterBool>(
-            eqBandParamType(i, "enabled"), "B" + juce::String(i) + " Enabled", enabledDefault));
+            ids.enabled, "B" + juce::String(i) + " Enabled", enabledDefault));
 
         const float defaultFreq = juce::jmap<float>((float)i, 1.0f, (float)maxEqBands, 100.0f, 5000.0f);
         params.push_back(std::make_unique<juce::AudioParameterFloat>(
-            eqBandParamType(i, "freq"), "B" + juce::String(i) + " Freq",
+            ids.freq, "B" + juce::String(i) + " Freq",
             juce::NormalisableRange<float>(minEqFreq, maxEqFreq, 0.01f, 0.5f), defaultFreq));
 
         params.push_back(std::make_unique<juce::AudioParameterFloat>(
-            eqBandParamType(i, "gain"), "B" + juce::String(i) + " Gain",
+            ids.gain, "B" + juce::String(i) + " Gain",
             juce::NormalisableRange<float>(minEqGainDb, maxEqGainDb, 0.01f), 0.0f));
 
         params.push_back(std::make_unique<juce::AudioParameterFloat>(
-            eqBandParamType(i, "q"), "B" + juce::String(i) + " Q",
+            ids.q, "B" + juce::String(i) + " Q",
             juce::NormalisableRange<float>(eqMinQ, eqMaxQ, 0.01f, 0.5f), 2.0f));
     }
 
+    // Graphic EQ - its own sliders for each layout, so switching layouts doesn't lose either setting
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("eqMode", "EQ Mode", eqModeChoices(), 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("geqLayout", "Graphic Bands", graphicLayoutChoices(), 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("geqQ", "Graphic Q", graphicQChoices(), 0));
+
+    for (auto layout : { GraphicEq::Layout::thirdOctave, GraphicEq::Layout::octave })
+    {
+        for (int b = 0; b < GraphicEq::getNumBands(layout); ++b)
+        {
+            params.push_back(std::make_unique<juce::AudioParameterFloat>(
+                GraphicEq::getParamId(layout, b), "GEQ " + GraphicEq::getBandName(layout, b) + " Hz",
+                juce::NormalisableRange<float>(-GraphicEq::maxGainDb, GraphicEq::maxGainDb, 0.1f), 0.0f));
+        }
+    }
+
+    // The CPU governor's quality tier, for the host to display - set by the plugin, not automatable. Last, so hosts that
+    // address parameters by index still find the others where they were.
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("qualityTier", "Quality Tier", qualityTierChoices(), 0,
+        juce::AudioParameterChoiceAttributes().withAutomatable(false).withCategory(juce::AudioProcessorParameter::otherMeter)));
+
     return { params.begin(), params.end() };
 }
 
 void JuceEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    currentSampleRate = sampleRate;
-
-    // For multi-channel (Gain) processing
-    juce::dsp::ProcessSpec fullSpec{ sampleRate, (juce::uint32)samplesPerBlock, (juce::uint32)getTotalNumOutputChannels() };
+    const int numCh = juce::jlimit(1, EqChain::maxChannels, getTotalNumOutputChannels());
+    const bool bypassed = bypassParam != nullptr && bypassParam->get();
 
-    // NOTE: IIR::Filter is mono-only. 
-    juce::dsp::ProcessSpec monoSpec{ sampleRate, (juce::uint32)samplesPerBlock, 1 };
+    // The capture gets the block-filter choice as it'll be settled (automatic goes by this machine's benchmark,
+    // which a replay elsewhere can't repeat)
+    if (capture != nullptr)
+        capture->recordPrepare(sampleRate, samplesPerBlock, getTotalNumInputChannels(), (int)chain.getFilterTopologyMode(),
+                               (int)chain.getEngine(), chain.isMultirateEnabled(),
+                               chain.willUseBlockFilters(numCh, samplesPerBlock), bypassed);
 
-    inputGain.prepare(fullSpec);
-    outputGain.prepare(fullSpec);
+    currentSampleRate = sampleRate;
+    governor.prepare(sampleRate);
+    chain.setQualityTier(governor.getTier());
 
-    // Treat every filter as if were mono - hence each having a left and right
-    for (int s = 0; s < maxFilterStages; ++s)
-    {
-        hpfL[s].prepare(monoSpec);
-        hpfR[s].prepare(monoSpec);
-        lpfL[s].prepare(monoSpec);
-        lpfR[s].prepare(monoSpec);
-    }
+    readParameters(parameters);
+    chain.setSettings(parameters);
 
-    for (int b = 0; b < maxEqBands; ++b)
-    {
-        peaksL[b].prepare(monoSpec);
-        peaksR[b].prepare(monoSpec);
-    }
+    // Without its state the chain passes audio through untouched - there's no way to fail a prepare to the host
+    const bool prepared = chain.prepare(sampleRate, samplesPerBlock, numCh, bypassed);
+    jassert(prepared);
+    juce::ignoreUnused(prepared);
 
-    specValid = true;
+    pendingLatency.store(chain.getLatencySamples());
+    setLatencySamples(pendingLatency.load());
+    markPending(); // The governor is back at full quality - its parameter follows on the next poll
 
-    // Force first-time coeff build
-    dirty.hpf.store(true);
-    dirty.lpf.store(true);
-    for (auto& d : dirty.peak) d.store(true);
+    if (telemetry != nullptr)
+        telemetry->setPrepared(sampleRate, juce::jmax(1, samplesPerBlock), numCh);
+}
 
-    lastSnap = {}; // reset baseline
-    snapshotParameters();
-    updateDirtyFilters();
+void JuceEQAudioProcessor::releaseResources()
+{
+    chain.stop();
 }
 
-// Checks if mono or stereo is being used
+// Any matching input/output layout up to maxChannels (mono, stereo, surround, ambisonic beds...)
 bool JuceEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
     auto in = layouts.getMainInputChannelSet();
@@ -138,73 +278,100 @@ bool JuceEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) co
     if (in != out) 
         return false;
 
-    return in == juce::AudioChannelSet::mono() || in == juce::AudioChannelSet::stereo();
+    return !in.isDisabled() && in.size() <= EqChain::maxChannels;
 }
 
 void JuceEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
-    juce::ScopedNoDenormals noDenormals; // For effeciency - rounds down very small floats to 0 to reduce processing load
+    processHostBlock(buffer, bypassParam != nullptr && bypassParam->get());
+}
+
+// Hosts that bypass without touching the bypass parameter call this instead
+void JuceEQAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processHostBlock(buffer, true);
+}
 
-    snapshotParameters();
-    updateDirtyFilters(); // Rebuild only what's different from the last process block
+void JuceEQAudioProcessor::processHostBlock(juce::AudioBuffer<float>& buffer, bool bypassed)
+{
+    // The capture sees the host's block as it arrived, before the chain splits it
+    // The tier only changes in governor.end(), so the one recorded is the one the whole block runs at
+    const int tierBefore = governor.getTier();
+    const bool captured = capture != nullptr && capture->beginBlock(buffer, bypassed, tierBefore);
+    const auto startTicks = governor.begin();
+
+    Telemetry::Block telemetryBlock{};
+    if (telemetry != nullptr)
+    {
+        telemetry->beginBlock();
+        measurePeaks(buffer, telemetryBlock.inputPeak);
+    }
 
-    // Audio buffer
-    juce::dsp::AudioBlock<float> block(buffer);
+    {
+        EQ_TRACE_SCOPE("readParameters");
+        readParameters(parameters);
+    }
 
-    // For multichannel contexts
-    juce::dsp::ProcessContextReplacing<float> chContext(block);
+    chain.setSettings(parameters);
+    chain.setQualityTier(tierBefore);
 
-    // Input gain affects all channels prior to EQ filter and band application
-    inputGain.setGainDecibels(curSnap.inGainDb);
-    inputGain.process(chContext);
+    const int numSamples = buffer.getNumSamples();
+    chain.process(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples, bypassed);
 
-    // Seperates channels into their own mono channels to be processed 
-    const int numCh = buffer.getNumChannels();
-    auto ch0Block = block.getSingleChannelBlock(0);
-    juce::dsp::ProcessContextReplacing<float> ctxL(ch0Block);
+    governor.end(startTicks, numSamples, chain.getEffectiveTiers());
 
-    // For mono only cases, use just the right channel
-    std::unique_ptr<juce::dsp::ProcessContextReplacing<float>> ctxRPtr;
-    if (numCh > 1)
-    {
-        auto ch1Block = block.getSingleChannelBlock(1);
-        ctxRPtr = std::make_unique<juce::dsp::ProcessContextReplacing<float>>(ch1Block);
-    }
+    // setLatencySamples notifies the host, which isn't safe on the audio thread - and neither is posting a message
+    // (a lock and a syscall), so a latency or tier change only flags this instance for the shared message-thread poll
+    const int latency = chain.getLatencySamples();
+    if (pendingLatency.exchange(latency) != latency || governor.getTier() != tierBefore)
+        markPending();
 
-    // Helper for mono-only filters 
-    auto processMonoStage = [&](juce::dsp::IIR::Filter<float>& fl,
-        juce::dsp::IIR::Filter<float>& fr,
-        int stages,
-        bool enabled)
-        {
-            if (!enabled) return;
-            for (int s = 0; s < stages; ++s)
-            {
-                fl.process(ctxL);
-                if (ctxRPtr) fr.process(*ctxRPtr);
-            }
-        };
-
-    auto processMonoBand = [&](int b)
-        {
-            if (!curSnap.bands[b].enabled) return;
-            peaksL[b].process(ctxL);
-            if (ctxRPtr) peaksR[b].process(*ctxRPtr);
-        };
+    if (telemetry != nullptr)
+        publishTelemetry(telemetryBlock, buffer, bypassed);
 
-    // HPF cascade (mono)
-    processMonoStage(hpfL[0], hpfR[0], curSnap.hpfStages, curSnap.hpfEnabled);
+    if (captured)
+        capture->endBlock(buffer);
+}
 
-    // Peaking bands
-    for (int b = 0; b < maxEqBands; ++b)
-        processMonoBand(b);
+void JuceEQAudioProcessor::handlePendingChange()
+{
+    const int latency = pendingLatency.load();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
 
-    // LPF cascade (mono)
-    processMonoStage(lpfL[0], lpfR[0], curSnap.lpfStages, curSnap.lpfEnabled);
+    // The governor's tier goes out to the host (and the editor) through its parameter, from here for the same reason
+    if (qualityTierParam != nullptr && qualityTierParam->getIndex() != governor.getReportedTier())
+        *qualityTierParam = governor.getReportedTier();
+}
+
+// Everything but the timing (the publisher adds that) - the state is the last chunk's when a long block was split
+void JuceEQAudioProcessor::publishTelemetry(Telemetry::Block& block, const juce::AudioBuffer<float>& buffer, bool bypassed) noexcept
+{
+    measurePeaks(buffer, block.outputPeak);
+    const auto& settings = chain.getSettings();
+    block.gainReductionDb = settings.limiterEnabled ? chain.getGainReductionDb() : 0.0f;
+    block.latencySamples = chain.getLatencySamples();
+    block.tier = governor.getTier();
+    block.parameterVersion = chain.getResponseVersion();
+
+    block.state = (bypassed ? Telemetry::bypassedFlag : 0u)
+                | (chain.isSleeping() ? Telemetry::sleepingFlag : 0u)
+                | (chain.areFiltersEngaged() ? Telemetry::filtersEngagedFlag : 0u)
+                | (settings.limiterEnabled ? Telemetry::limiterFlag : 0u)
+                | (chain.isMultirateActive() ? Telemetry::multirateFlag : 0u)
+                | (chain.getPreparedEngine() == Engine::fixedPoint ? Telemetry::fixedPointFlag : 0u)
+                | (settings.graphicMode ? Telemetry::graphicFlag : 0u)
+                | (chain.isUsingBlockFilters() ? Telemetry::blockFiltersFlag : 0u);
+
+    telemetry->endBlock(block, buffer.getNumSamples());
+}
 
-    // Apply output gain to all channels 
-    outputGain.setGainDecibels(curSnap.outGainDb);
-    outputGain.process(chContext);
+void JuceEQAudioProcessor::measurePeaks(const juce::AudioBuffer<float>& buffer, float* peaks) noexcept
+{
+    const auto& kernels = DspKernels::get();
+
+    for (int ch = 0; ch < 2; ++ch)
+        peaks[ch] = ch < buffer.getNumChannels() ? kernels.peak(buffer.getReadPointer(ch), buffer.getNumSamples()) : 0.0f;
 }
 
 // Getter and setter for preset info
@@ -216,71 +383,60 @@ void JuceEQAudioProcessor::getStateInformation(juce::MemoryBlock& dataDest)
 
 void JuceEQAudioProcessor::setStateInformation(const void* xmlData, int sizeInBytes)
 {
+    EQ_TRACE_SCOPE("setStateInformation");
     if (auto xml = getXmlFromBinary(xmlData, sizeInBytes))
         apvts.replaceState(juce::ValueTree::fromXml(*xml));
 }
 
-// For slope index
-int JuceEQAudioProcessor::numStagesForSlopeIndex(int slopeIndex)
-{
-    if (slopeIndex <= 1) 
-        return 1; // 6 or 12 dB -> 1 stage
-
-    return 1 << (slopeIndex - 1);  // 24 -> 2 stages, 48 -> 4 stages
-}
-
-float JuceEQAudioProcessor::readParam(const juce::AudioProcessorValueTreeState& apvtState, const juce::String& id)
+void JuceEQAudioProcessor::updateTrackProperties(const TrackProperties& properties)
 {
-    if (auto* p = apvtState.getRawParameterValue(id)) 
-        return p->load();
-
-    return 0.0f;
+    if (telemetry != nullptr)
+        telemetry->setNames(juce::PluginHostType().getHostDescription(), properties.name.value_or(juce::String()));
 }
 
-void JuceEQAudioProcessor::snapshotParameters()
+void JuceEQAudioProcessor::readParameters(ChainSnapshot& snap) const
 {
-    ChainSnapshot snap;
+    snap.inGainDb = rawParams.inGain->load();
+    snap.outGainDb = rawParams.outGain->load();
 
-    snap.inGainDb = readParam(apvts, "inGain");
-    snap.outGainDb = readParam(apvts, "outGain");
-
-    snap.hpfIndex = (int)readParam(apvts, "hpfSlope");
-    snap.hpfEnabled = readParam(apvts, "hpfEnabled") > 0.5f;
-    snap.hpfFreqHz = readParam(apvts, "hpfFreq");
+    snap.hpfIndex = (int)rawParams.hpfSlope->load();
+    snap.hpfEnabled = rawParams.hpfEnabled->load() > 0.5f;
+    snap.hpfFreqHz = rawParams.hpfFreq->load();
     snap.hpfStages = numStagesForSlopeIndex(snap.hpfIndex);
 
-    snap.lpfIndex = (int)readParam(apvts, "lpfSlope");
-    snap.lpfEnabled = readParam(apvts, "lpfEnabled") > 0.5f;
-    snap.lpfFreqHz = readParam(apvts, "lpfFreq");
+    snap.lpfIndex = (int)rawParams.lpfSlope->load();
+    snap.lpfEnabled = rawParams.lpfEnabled->load() > 0.5f;
+    snap.lpfFreqHz = rawParams.lpfFreq->load();
     snap.lpfStages = numStagesForSlopeIndex(snap.lpfIndex);
 
+    snap.limiterEnabled = rawParams.limiterEnabled->load() > 0.5f;
+    snap.limiterCeilingDb = rawParams.limiterCeiling->load();
+    snap.limiterLookaheadMs = rawParams.limiterLookahead->load();
+    snap.limiterReleaseMs = rawParams.limiterRelease->load();
+    snap.limiterTruePeak = rawParams.limiterTruePeak->load() > 0.5f;
+
     // For EQ bands
     for (int b = 0; b < maxEqBands; ++b)
     {
-        const int i = b + 1;
+        const auto& raw = rawParams.bands[b];
         auto& band = snap.bands[b];
-        band.enabled = readParam(apvts, eqBandParamType(i, "enabled")) > 0.5f;
-        band.freqHz = readParam(apvts, eqBandParamType(i, "freq"));
-        band.q = readParam(apvts, eqBandParamType(i, "q"));
-        band.gainDb = readParam(apvts, eqBandParamType(i, "gain"));
-    }
-
-    // Snapshot detection - checks for parameter changes
-    if (snap.hpfEnabled != lastSnap.hpfEnabled || snap.hpfFreqHz != lastSnap.hpfFreqHz || snap.hpfStages != lastSnap.hpfStages || snap.hpfIndex != lastSnap.hpfIndex)
-        dirty.hpf.store(true);
-    if (snap.lpfEnabled != lastSnap.lpfEnabled || snap.lpfFreqHz != lastSnap.lpfFreqHz || snap.lpfStages != lastSnap.lpfStages || snap.lpfIndex != lastSnap.lpfIndex)
-        dirty.lpf.store(true);
-
-    for (int b = 0; b < maxEqBands; ++b)
-    {
-        const auto& a = snap.bands[b];
-        const auto& z = lastSnap.bands[b];
-        if (a.enabled != z.enabled || a.freqHz != z.freqHz || a.q != z.q || a.gainDb != z.gainDb)
-            dirty.peak[b].store(true);
+        band.enabled = raw.enabled->load() > 0.5f;
+        band.freqHz = raw.freq->load();
+        band.q = raw.q->load();
+        band.gainDb = raw.gain->load();
     }
 
-    curSnap = snap;
-    lastSnap = snap;
+    snap.graphicMode = (int)rawParams.eqMode->load() == 1;
+    snap.graphicLayout = (int)rawParams.graphicLayout->load() == 1 ? GraphicEq::Layout::octave : GraphicEq::Layout::thirdOctave;
+    snap.graphicQMode = (int)rawParams.graphicQ->load() == 1 ? GraphicEq::QMode::proportional : GraphicEq::QMode::constant;
+
+    snap.graphicGainsDb.fill(0.0f);
+    if (snap.graphicLayout == GraphicEq::Layout::thirdOctave)
+        for (int b = 0; b < GraphicEq::numThirdOctaveBands; ++b)
+            snap.graphicGainsDb[(size_t)b] = rawParams.graphicThirdOctave[(size_t)b]->load();
+    else
+        for (int b = 0; b < GraphicEq::numOctaveBands; ++b)
+            snap.graphicGainsDb[(size_t)b] = rawParams.graphicOctave[(size_t)b]->load();
 }
 
 JuceEQAudioProcessor::IIRBiquadCoeffPtr JuceEQAudioProcessor::makePeak(float sampleRate, float freqHz, float q, float gainDb)
@@ -288,12 +444,12 @@ JuceEQAudioProcessor::IIRBiquadCoeffPtr JuceEQAudioProcessor::makePeak(float sam
     const float g = juce::Decibels::decibelsToGain(juce::jlimit(minEqGainDb, maxEqGainDb, gainDb));
 
     return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        juce::jlimit(minEqFreq, maxEqFreq, freqHz), juce::jlimit(eqMinQ, eqMaxQ, q), g);
+        juce::jmin(juce::jlimit(minEqFreq, maxEqFreq, freqHz), 0.49f * sampleRate), juce::jlimit(eqMinQ, eqMaxQ, q), g);
 }
 
 JuceEQAudioProcessor::IIRBiquadCoeffPtr JuceEQAudioProcessor::makeHPF(float sampleRate, float freqHz, bool firstOrder)
 {
-    const float f = juce::jlimit(minEqFreq, maxEqFreq, freqHz);
+    const float f = juce::jmin(juce::jlimit(minEqFreq, maxEqFreq, freqHz), 0.49f * sampleRate); // As EqDesign clamps it
 
     return firstOrder ? IIRBiquadCoeffs::makeFirstOrderHighPass(sampleRate, f)
         : IIRBiquadCoeffs::makeHighPass(sampleRate, f);
@@ -301,108 +457,25 @@ JuceEQAudioProcessor::IIRBiquadCoeffPtr JuceEQAudioProcessor::makeHPF(float samp
 
 JuceEQAudioProcessor::IIRBiquadCoeffPtr JuceEQAudioProcessor::makeLPF(float sampleRate, float freqHz, bool firstOrder)
 {
-    const float f = juce::jlimit(minEqFreq, maxEqFreq, freqHz);
+    const float f = juce::jmin(juce::jlimit(minEqFreq, maxEqFreq, freqHz), 0.49f * sampleRate); // As EqDesign clamps it
 
     return firstOrder ? IIRBiquadCoeffs::makeFirstOrderLowPass(sampleRate, f)
         : IIRBiquadCoeffs::makeLowPass(sampleRate, f);
 }
 
-void JuceEQAudioProcessor::updateDirtyFilters()
+void JuceEQAudioProcessor::getFrequencyResponse(const std::vector<double>& freqs,
+    std::vector<double>& mags) const
 {
-    const auto sampleRate = (float)currentSampleRate;
-
-    if (dirty.hpf.exchange(false))
-    {
-        const bool firstOrder = (curSnap.hpfIndex == 0); // 6 dB -> 1st order
-        auto c = makeHPF(sampleRate, curSnap.hpfFreqHz, firstOrder);
-        
-        for (int i = 0; i < maxFilterStages; ++i) 
-            hpfCoeffs[i] = c;
-        
-        for (int i = 0; i < maxFilterStages; ++i) 
-        { 
-            hpfL[i].coefficients = hpfCoeffs[i]; 
-            hpfR[i].coefficients = hpfCoeffs[i]; 
-        }
-
-        hpfStageCount = curSnap.hpfStages;
-    }
-
-    if (dirty.lpf.exchange(false))
-    {
-        const bool firstOrder = (curSnap.lpfIndex == 0); // 6 dB -> 1st order
-        auto c = makeLPF(sampleRate, curSnap.lpfFreqHz, firstOrder);
-        
-        for (int i = 0; i < maxFilterStages; ++i) 
-            lpfCoeffs[i] = c;
-        
-        for (int i = 0; i < maxFilterStages; ++i) 
-        { 
-            lpfL[i].coefficients = lpfCoeffs[i]; 
-            lpfR[i].coefficients = lpfCoeffs[i]; 
-        }
-
-        lpfStageCount = curSnap.lpfStages;
-    }
-
-    // EQ bands
-    for (int b = 0; b < maxEqBands; ++b)
-    {
-        if (!dirty.peak[b].exchange(false)) continue;
-
-        if (curSnap.bands[b].enabled)
-            peakCoeffs[b] = makePeak(sampleRate, curSnap.bands[b].freqHz, curSnap.bands[b].q, curSnap.bands[b].gainDb);
-        else
-            peakCoeffs[b] = IIRBiquadCoeffPtr();
-
-        peaksL[b].coefficients = peakCoeffs[b];
-        peaksR[b].coefficients = peakCoeffs[b];
-    }
+    ChainSnapshot snap;
+    readParameters(snap);
+    getFrequencyResponse(snap, currentSampleRate, freqs, mags);
 }
 
-void JuceEQAudioProcessor::getFrequencyResponse(const std::vector<double>& freqs,
-    std::vector<double>& mags) const
+void JuceEQAudioProcessor::getFrequencyResponse(const ChainSnapshot& snap, double sampleRate,
+    const std::vector<double>& freqs, std::vector<double>& mags)
 {
     jassert(mags.size() == freqs.size());
-
-    // For local copies of the shared_ptr arrays
-    // Safer in case of thread swaps during the for loop
-    auto locHpfC = hpfCoeffs;
-    auto locLpfC = lpfCoeffs;
-    auto locPeakC = peakCoeffs;
-
-    const bool locHpfEnabled = curSnap.hpfEnabled;
-    const int  locHpfCount = hpfStageCount;
-    const bool locLpfEnabled = curSnap.lpfEnabled;
-    const int  locLpfCount = lpfStageCount;
-
-    for (size_t i = 0; i < freqs.size(); ++i)
-    {
-        const double newFreq = juce::jlimit<double>(minEqFreq, maxEqFreq, freqs[i]);
-        double H = 1.0;
-
-        if (locHpfEnabled) {
-            for (int s = 0; s < locHpfCount; ++s)
-            {
-                if (locHpfC[s] != nullptr)
-                    H *= locHpfC[s]->getMagnitudeForFrequency(newFreq, currentSampleRate);
-            }
-        }
-               
-        for (int b = 0; b < maxEqBands; ++b)
-            if (locPeakC[b] != nullptr) 
-                H *= locPeakC[b]->getMagnitudeForFrequency(newFreq, currentSampleRate);
-
-        if (locLpfEnabled) {
-            for (int s = 0; s < locLpfCount; ++s)
-            {
-                if (locLpfC[s] != nullptr)
-                    H *= locLpfC[s]->getMagnitudeForFrequency(newFreq, currentSampleRate);
-            }
-        }
-
-        mags[i] = H;
-    }
+    EqDesign::getFrequencyResponse(snap, sampleRate, freqs.data(), mags.data(), (int)freqs.size());
 }
 
 juce::AudioProcessorEditor* JuceEQAudioProcessor::createEditor()
@@ -5,23 +5,12 @@
 #include <array>
 #include <vector>
 #include <atomic>
-
-namespace EqConstants
-{
-    constexpr int maxEqBands = 8; // Default is 3, max is 8
-
-    // min and max freq for all freq knobs
-    constexpr float minEqFreq = 10.0f;
-    constexpr float maxEqFreq = 20000.0f;
-
-    // min and max gain for EQ bands
-    constexpr float minEqGainDb = -30.0f;
-    constexpr float maxEqGainDb = +30.0f;
-
-    // min and max Q for EQ bands
-    constexpr float eqMinQ = 0.10f;
-    constexpr float eqMaxQ = 40.0f;
-}
+#include "CpuGovernor.h"
+#include "EqChain.h"
+#include "MessageThreadPoller.h"
+#include "SessionCapture.h"
+#include "Telemetry.h"
+#include "Trace.h"
 
 // For the 8 (max) EQ bands' knob IDs 
 // i.e. eqBandParamType(3, "gain") -> "b3_gain".
@@ -30,23 +19,26 @@ static inline juce::String eqBandParamType(int bandIndex, const juce::String& pa
     return "b" + juce::String(bandIndex) + "_" + paramType;
 }
 
-class JuceEQAudioProcessor : public juce::AudioProcessor
+class JuceEQAudioProcessor : public juce::AudioProcessor,
+                             private MessageThreadPoller::Client
 {
 public:
     using IIRBiquadCoeffs = juce::dsp::IIR::Coefficients<float>; // Biquad coeff holder
     using IIRBiquadCoeffPtr = IIRBiquadCoeffs::Ptr; // Reference-counted pointer to coeffs
 
     JuceEQAudioProcessor();
-    ~JuceEQAudioProcessor() override = default;
+    ~JuceEQAudioProcessor() override;
 
     // ----- JUCE boilerplate -----
 
     const juce::String getName() const override { return "JuceEQ"; }
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override {}
+    void releaseResources() override;
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    juce::AudioProcessorParameter* getBypassParameter() const override { return bypassParam; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
@@ -55,7 +47,7 @@ public:
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override { return chain.getTailSeconds(); }
 
     // For factory presets
     int getNumPrograms() override { return 1; }
@@ -68,11 +60,14 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
+    // The track name goes into the telemetry slot, for telling instances apart on a dashboard
+    void updateTrackProperties(const TrackProperties& properties) override;
+
     // For JUCE's parameter system, AudioProcessorValueTreeState - stores Ids, ranges, default values, etc. 
     // Syncs UI to DSP via "attachments", and stores state info
     juce::AudioProcessorValueTreeState apvts;
 
-    /* Computes freq response from parameter values to avoid races
+    /* Computes freq response from parameter values (designed here, nothing shared with the audio thread)
      * freqs - vector of frequencies that're being evaluated
      *
      * magLinear - a vector of costant linear magnitudes (aka amplitude ratio |H(f)|) at each respective frequency
@@ -85,6 +80,17 @@ public:
     void getFrequencyResponse(const std::vector<double>& freqs,
         std::vector<double>& magLinear) const;
 
+    // Parameter values as the DSP sees them - read once per process block, or from a saved state (see EqDesign.h)
+    using BandSnapshot = EqDesign::BandSettings;
+    using ChainSnapshot = EqDesign::ChainSettings;
+
+    // The same response for any set of values, e.g. a preset on disk (any thread)
+    static void getFrequencyResponse(const ChainSnapshot& snap, double sampleRate,
+        const std::vector<double>& freqs, std::vector<double>& magLinear);
+
+    // Bumped whenever the audio thread rebuilds filters (parameter or sample rate changes)
+    juce::uint32 getResponseVersion() const { return chain.getResponseVersion(); }
+
     // For I/O Volume Meters
     float getInputPeakLinear(int ch) const 
     { 
@@ -96,85 +102,123 @@ public:
         return outputPeak[juce::jlimit(0, 1, ch)].load(); 
     }
 
+    // Splitting wide channel layouts over worker threads (applied at the next prepareToPlay)
+    using WorkerPoolOptions = EqChain::WorkerPoolOptions;
+    void setWorkerPoolOptions(const WorkerPoolOptions& options) { chain.setWorkerPoolOptions(options); }
+    ChannelWorkerPool::Stats getWorkerPoolStats() const { return chain.getWorkerPoolStats(); }
+
+    // JUCE's designs of the same filters - the verification tool checks FilterSection's designs against these
+    static IIRBiquadCoeffPtr makePeak(float sampleRate, float freqHz, float q, float gainDb);
+    static IIRBiquadCoeffPtr makeHPF(float sampleRate, float freqHz, bool firstOrder);
+    static IIRBiquadCoeffPtr makeLPF(float sampleRate, float freqHz, bool firstOrder);
+
+    // Direct form / SVF per section - automatic by default, forcing one is mostly for A/B listening and benchmarks
+    void setFilterTopologyMode(FilterSection::TopologyMode mode) { chain.setFilterTopologyMode(mode); }
+
+    // Float sections, or the integer engine for targets without a fast FPU (see FixedPointSection.h), applied at the
+    // next prepareToPlay. The default is the build's (JUCEEQ_FIXED_POINT); JUCEEQ_ENGINE=float|fixed overrides it.
+    using Engine = EqChain::Engine;
+    void setEngine(Engine e) { chain.setEngine(e); }
+    Engine getEngine() const { return chain.getEngine(); }
+
+    // Runs the low HPF and peak sections at a reduced rate from 88.2 kHz up (see MultirateSplit.h), for the float
+    // engine only. Adds a fixed latency while on. Applied at the next prepareToPlay; off unless JUCEEQ_MULTIRATE=on.
+    void setMultirateEnabled(bool shouldBeEnabled) { chain.setMultirateEnabled(shouldBeEnabled); }
+    bool isMultirateEnabled() const { return chain.isMultirateEnabled(); }
+
+    // Block state-space float sections (see FilterSection.h) for mono and dual-mono layouts, where each channel's
+    // recurrence is all there is to run. automatic uses them when FilterSection::isBlockProcessingFaster() says so
+    // for the prepared block size; on forces them for any layout. Applied at the next prepareToPlay;
+    // JUCEEQ_BLOCK_FILTERS=auto|on|off sets the default.
+    using BlockFilters = EqChain::BlockFilters;
+    void setBlockFilters(BlockFilters mode) { chain.setBlockFilters(mode); }
+    BlockFilters getBlockFilters() const { return chain.getBlockFilters(); }
+    bool isUsingBlockFilters() const { return chain.isUsingBlockFilters(); } // As prepared
+
+    // CPU governor (see CpuGovernor.h) - the quality tier this instance is running at and its smoothed load (block
+    // time over block duration). The host sees the tier as the read-only "qualityTier" parameter.
+    int getQualityTier() const { return governor.getReportedTier(); }
+
+    // Runs the next blocks at this tier - JuceEQReplay uses it (with the governor's policy off) to follow a capture's
+    // tier changes. Call between blocks, from the thread that processes them.
+    void setQualityTier(int tier) { governor.setTier(tier); }
+    float getCpuLoad() const { return governor.getLoad(); }
+
+    // Size of the single allocation holding this instance's audio-thread state (after prepareToPlay)
+    size_t getDspStateBytes() const { return chain.getDspStateBytes(); }
+
+    // Biquad stages per HPF/LPF slope choice (also used by EqAutoFit's model)
+    static int numStagesForSlopeIndex(int slopeIndex) { return EqDesign::numStagesForSlopeIndex(slopeIndex); }
+
+    // Section designs for a snapshot, parameters clamped to their ranges
+    static FilterSection::Design hpfDesign(const ChainSnapshot& snap, double sampleRate) { return EqDesign::hpfDesign(snap, sampleRate); }
+    static FilterSection::Design lpfDesign(const ChainSnapshot& snap, double sampleRate) { return EqDesign::lpfDesign(snap, sampleRate); }
+    static FilterSection::Design peakDesign(const BandSnapshot& band, double sampleRate) { return EqDesign::peakDesign(band, sampleRate); }
+
 private:
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    static int  numStagesForSlopeIndex(int slopeIndex);
-    static float readParam(const juce::AudioProcessorValueTreeState& s, const juce::String& id);
 
-    // Only rebuild changed filters on the audio thread
-    struct DirtyFlags
+    // Raw parameter values, looked up once - reading by ID would build a juce::String per read on the audio thread
+    struct BandParams
     {
-        std::atomic<bool> hpf{ true };
-        std::atomic<bool> lpf{ true };
-        std::array<std::atomic<bool>, EqConstants::maxEqBands> peak{};
-    } dirty;
-
-    // For current parameter values, read once per process block
-    struct BandSnapshot 
-    { 
-        bool enabled = false; 
-        float freqHz = 1000.0f; 
-        float q = 2.0f; 
-        float gainDb = 0.0f; 
+        std::atomic<float>* enabled = nullptr;
+        std::atomic<float>* freq = nullptr;
+        std::atomic<float>* gain = nullptr;
+        std::atomic<float>* q = nullptr;
     };
-    struct ChainSnapshot
+    struct RawParams
     {
-        float inGainDb = 0.0f;
-        float outGainDb = 0.0f;
-        
-        bool hpfEnabled = false; 
-        int hpfStages = 1; 
-        float hpfFreqHz = 20.0f;
-        int hpfIndex = 1;
-        
-        bool lpfEnabled = false; 
-        int lpfStages = 1; 
-        float lpfFreqHz = 20000.0f;
-        int lpfIndex = 1;
-
-        std::array<BandSnapshot, EqConstants::maxEqBands> bands{};
-    } curSnap, lastSnap;
-
-    void snapshotParameters(); // read apvts into curSnap
-    void updateDirtyFilters(); // rebuilds coeffs if they're set as dirty
-
-    // For coeffs of band peaks, hpf, and lpf EQ filters
-    static IIRBiquadCoeffPtr makePeak(float sampleRate, float freqHz, float q, float gainDb);
-    static IIRBiquadCoeffPtr makeHPF(float sampleRate, float freqHz, bool firstOrder);
-    static IIRBiquadCoeffPtr makeLPF(float sampleRate, float freqHz, bool firstOrder);
-
+        std::atomic<float>* inGain = nullptr;
+        std::atomic<float>* outGain = nullptr;
+        std::atomic<float>* hpfEnabled = nullptr;
+        std::atomic<float>* hpfFreq = nullptr;
+        std::atomic<float>* hpfSlope = nullptr;
+        std::atomic<float>* lpfEnabled = nullptr;
+        std::atomic<float>* lpfFreq = nullptr;
+        std::atomic<float>* lpfSlope = nullptr;
+        std::atomic<float>* limiterEnabled = nullptr;
+        std::atomic<float>* limiterCeiling = nullptr;
+        std::atomic<float>* limiterLookahead = nullptr;
+        std::atomic<float>* limiterRelease = nullptr;
+        std::atomic<float>* limiterTruePeak = nullptr;
+        std::array<BandParams, EqConstants::maxEqBands> bands{};
+        std::atomic<float>* eqMode = nullptr;
+        std::atomic<float>* graphicLayout = nullptr;
+        std::atomic<float>* graphicQ = nullptr;
+        std::array<std::atomic<float>*, GraphicEq::maxBands> graphicThirdOctave{};
+        std::array<std::atomic<float>*, GraphicEq::numOctaveBands> graphicOctave{};
+    } rawParams;
+
+    void readParameters(ChainSnapshot& snap) const; // Any thread - atomic loads only
+
+    void processHostBlock(juce::AudioBuffer<float>& buffer, bool bypassed); // One host block, measured and recorded
+    void handlePendingChange() override; // Reports latency and quality tier changes from the message thread
+
+    // The audio path itself (see EqChain.h) - fed the parameters once per block
+    EqChain chain;
+    ChainSnapshot parameters; // Audio thread - read into here, then handed to the chain
     double currentSampleRate = 44100.0;
-    juce::dsp::ProcessSpec lastSpec{};
-    bool specValid = false;
-
-    juce::dsp::Gain<float> inputGain;
-    juce::dsp::Gain<float> outputGain;
 
-    static constexpr int maxFilterStages = 4;
+    CpuGovernor governor;
+    juce::AudioParameterChoice* qualityTierParam = nullptr; // Written from the message thread only
+    juce::AudioParameterBool* bypassParam = nullptr;
+    std::atomic<int> pendingLatency{ 0 }; // What the chain runs at - the host hears about it from handlePendingChange()
 
-    // For HPF and LPF slope choices
-    // Uses "cascades" - flatter slopes are chained/cascaded together multiple stages to get steeper slopes
-    // More efficient to chain together the filters rather than have multiple different slope filters
-    std::array<juce::dsp::IIR::Filter<float>, maxFilterStages> hpfL{};
-    std::array<juce::dsp::IIR::Filter<float>, maxFilterStages> hpfR{};
-    std::array<IIRBiquadCoeffPtr, maxFilterStages> hpfCoeffs{};
+    // Shared message-thread poll for the latency and tier reports - the audio thread only flags that one is due
+    juce::SharedResourcePointer<MessageThreadPoller> poller;
 
-    std::array<juce::dsp::IIR::Filter<float>, maxFilterStages> lpfL{};
-    std::array<juce::dsp::IIR::Filter<float>, maxFilterStages> lpfR{};
-    std::array<IIRBiquadCoeffPtr, maxFilterStages> lpfCoeffs{};
+    // JUCEEQ_CAPTURE session recording for offline replay (see SessionCapture.h) - null unless it's set
+    std::unique_ptr<SessionCapture> capture;
 
-    // Peaking bands per channel (left, right)
-    std::array<juce::dsp::IIR::Filter<float>, EqConstants::maxEqBands> peaksL{};
-    std::array<juce::dsp::IIR::Filter<float>, EqConstants::maxEqBands> peaksR{};
-    std::array<IIRBiquadCoeffPtr, EqConstants::maxEqBands> peakCoeffs{};
+    // JUCEEQ_TELEMETRY slot for monitoring dashboards (see Telemetry.h) - null unless it's set
+    std::unique_ptr<TelemetryPublisher> telemetry;
+    void publishTelemetry(Telemetry::Block& block, const juce::AudioBuffer<float>& buffer, bool bypassed) noexcept;
+    static void measurePeaks(const juce::AudioBuffer<float>& buffer, float* peaks) noexcept; // First two channels
 
     // Peak meters (updated each block)
     std::atomic<float> inputPeak[2]{ 0.0f, 0.0f };
     std::atomic<float> outputPeak[2]{ 0.0f, 0.0f };
 
-    int hpfStageCount = 0;
-    int lpfStageCount = 0;
-
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JuceEQAudioProcessor)
 };
 
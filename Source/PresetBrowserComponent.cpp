@@ -0,0 +1,211 @@
+#include "PresetBrowserComponent.h"
+#include "PluginProcessor.h"
+
+PresetBrowserComponent::PresetBrowserComponent(JuceEQAudioProcessor& p)
+    : processor(p)
+{
+    searchBox.setTextToShowWhenEmpty("Search names and tags", juce::Colours::grey);
+    searchBox.onTextChange = [this]() { refresh(); };
+    searchBox.onReturnKey = [this]() { loadRow(list.getSelectedRow()); };
+    addAndMakeVisible(searchBox);
+
+    similarButton.setTooltip("Order the results by how close each preset's curve is to the current curve");
+    similarButton.onClick = [this]() { refresh(); };
+    addAndMakeVisible(similarButton);
+
+    folderButton.onClick = [this]() { chooseFolder(); };
+    addAndMakeVisible(folderButton);
+
+    saveButton.onClick = [this]() { saveCurrent(); };
+    addAndMakeVisible(saveButton);
+
+    statusLabel.setJustificationType(juce::Justification::centredRight);
+    statusLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFB9BEC4));
+    addAndMakeVisible(statusLabel);
+
+    list.setRowHeight(rowHeight);
+    list.setColour(juce::ListBox::backgroundColourId, juce::Colours::black);
+    addAndMakeVisible(list);
+
+    library->addListener(this);
+    refresh();
+}
+
+PresetBrowserComponent::~PresetBrowserComponent()
+{
+    library->removeListener(this);
+}
+
+void PresetBrowserComponent::paint(juce::Graphics& graphics)
+{
+    graphics.fillAll(juce::Colours::black.withAlpha(0.92f));
+    graphics.setColour(juce::Colour(0xFF2E3236));
+    graphics.drawRect(getLocalBounds());
+}
+
+void PresetBrowserComponent::resized()
+{
+    auto bounds = getLocalBounds().reduced(6);
+
+    auto top = bounds.removeFromTop(24);
+    saveButton.setBounds(top.removeFromRight(64));
+    top.removeFromRight(4);
+    folderButton.setBounds(top.removeFromRight(72));
+    top.removeFromRight(4);
+    similarButton.setBounds(top.removeFromRight(76));
+    top.removeFromRight(4);
+    searchBox.setBounds(top);
+
+    statusLabel.setBounds(bounds.removeFromBottom(18));
+    bounds.removeFromTop(4);
+    list.setBounds(bounds);
+}
+
+// The curve ordering follows the current settings, which may have changed while the browser was hidden
+void PresetBrowserComponent::visibilityChanged()
+{
+    if (isVisible())
+    {
+        refresh();
+        searchBox.grabKeyboardFocus();
+    }
+}
+
+void PresetBrowserComponent::refresh()
+{
+    rows = library->search(searchBox.getText());
+
+    if (similarButton.getToggleState())
+    {
+        const auto current = PresetLibrary::getCurveDb(processor);
+        rows = library->sortByCurveDistance(std::move(rows), current.data());
+    }
+
+    list.updateContent();
+    list.repaint();
+
+    juce::String status = juce::String(rows.size()) + " of " + juce::String(library->getNumEntries()) + " presets";
+    if (library->isScanning())
+        status << " - scanning...";
+    statusLabel.setText(status, juce::dontSendNotification);
+}
+
+int PresetBrowserComponent::getNumRows()
+{
+    return (int)rows.size();
+}
+
+void PresetBrowserComponent::paintListBoxItem(int row, juce::Graphics& graphics, int width, int height, bool rowIsSelected)
+{
+    if (row < 0 || row >= (int)rows.size())
+        return;
+
+    const int index = rows[(size_t)row];
+
+    if (rowIsSelected)
+        graphics.fillAll(juce::Colour(0xFF262A2E));
+
+    // Thumbnails are requested as rows come into view - a placeholder until the render lands
+    const juce::Rectangle<int> thumbArea(4, 3, PresetLibrary::thumbnailWidth, PresetLibrary::thumbnailHeight);
+    if (auto thumbnail = library->getThumbnail(index); thumbnail.isValid())
+    {
+        graphics.drawImageAt(thumbnail, thumbArea.getX(), thumbArea.getY());
+    }
+    else
+    {
+        graphics.setColour(juce::Colour(0xFF15181A));
+        graphics.fillRoundedRectangle(thumbArea.toFloat(), 3.0f);
+    }
+
+    auto text = juce::Rectangle<int>(thumbArea.getRight() + 8, 0, width - thumbArea.getRight() - 12, height);
+
+    graphics.setColour(juce::Colours::white);
+    graphics.setFont(14.0f);
+    graphics.drawText(library->getName(index), text.removeFromTop(height / 2 + 2), juce::Justification::bottomLeft, true);
+
+    graphics.setColour(juce::Colour(0xFFB9BEC4));
+    graphics.setFont(12.0f);
+    graphics.drawText(library->getTags(index).replace(",", "  "), text, juce::Justification::topLeft, true);
+}
+
+void PresetBrowserComponent::listBoxItemDoubleClicked(int row, const juce::MouseEvent&)
+{
+    loadRow(row);
+}
+
+void PresetBrowserComponent::returnKeyPressed(int lastRowSelected)
+{
+    loadRow(lastRowSelected);
+}
+
+void PresetBrowserComponent::selectedRowsChanged(int lastRowSelected)
+{
+    selectedFile = lastRowSelected >= 0 && lastRowSelected < (int)rows.size() ? library->getFile(rows[(size_t)lastRowSelected])
+                                                                               : juce::File();
+}
+
+void PresetBrowserComponent::loadRow(int row)
+{
+    if (row < 0 || row >= (int)rows.size())
+        return;
+
+    const auto file = library->getFile(rows[(size_t)row]);
+    if (!PresetLibrary::loadPreset(file, processor.apvts))
+        statusLabel.setText("Couldn't load " + file.getFileName(), juce::dontSendNotification);
+}
+
+void PresetBrowserComponent::presetIndexChanged()
+{
+    // Keep the selection on the same preset across a catalogue swap
+    const auto keep = selectedFile;
+    refresh();
+
+    for (size_t r = 0; r < rows.size(); ++r)
+    {
+        if (keep != juce::File() && library->getFile(rows[r]) == keep)
+        {
+            list.selectRow((int)r, true);
+            return;
+        }
+    }
+
+    list.deselectAllRows();
+}
+
+void PresetBrowserComponent::presetThumbnailsChanged()
+{
+    list.repaint();
+}
+
+void PresetBrowserComponent::chooseFolder()
+{
+    chooser = std::make_unique<juce::FileChooser>("Choose the preset folder", library->getFolder());
+
+    chooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectDirectories,
+        [this](const juce::FileChooser& fc)
+        {
+            const auto folder = fc.getResult();
+            if (folder.isDirectory())
+                library->setFolder(folder);
+        });
+}
+
+void PresetBrowserComponent::saveCurrent()
+{
+    library->getFolder().createDirectory();
+    chooser = std::make_unique<juce::FileChooser>("Save preset", library->getFolder().getChildFile("New Preset.xml"), "*.xml");
+
+    chooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                         | juce::FileBrowserComponent::warnAboutOverwriting,
+        [this](const juce::FileChooser& fc)
+        {
+            const auto file = fc.getResult();
+            if (file == juce::File())
+                return;
+
+            if (PresetLibrary::savePreset(file.withFileExtension("xml"), processor.apvts))
+                library->rescan();
+            else
+                statusLabel.setText("Couldn't save " + file.getFileName(), juce::dontSendNotification);
+        });
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <vector>
+#include "PresetLibrary.h"
+
+class JuceEQAudioProcessor;
+
+/**
+ * Preset browser panel: a search box, a "Similar" toggle that orders the results by how close each preset's curve
+ * is to the current one, and a list of presets with their curve thumbnails. Double-click or Return loads one.
+ * Everything comes from the shared PresetLibrary's mapped catalogue - nothing is read from the preset files
+ * until one is loaded.
+ */
+class PresetBrowserComponent : public juce::Component,
+    private juce::ListBoxModel,
+    private PresetLibrary::Listener
+{
+public:
+    explicit PresetBrowserComponent(JuceEQAudioProcessor&);
+    ~PresetBrowserComponent() override;
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+private:
+    // ListBoxModel
+    int getNumRows() override;
+    void paintListBoxItem(int row, juce::Graphics&, int width, int height, bool rowIsSelected) override;
+    void listBoxItemDoubleClicked(int row, const juce::MouseEvent&) override;
+    void returnKeyPressed(int lastRowSelected) override;
+    void selectedRowsChanged(int lastRowSelected) override;
+
+    // PresetLibrary::Listener
+    void presetIndexChanged() override;
+    void presetThumbnailsChanged() override;
+
+    void refresh(); // Re-runs the search (and curve ordering) against the current catalogue
+    void loadRow(int row);
+    void chooseFolder();
+    void saveCurrent();
+
+    JuceEQAudioProcessor& processor;
+    juce::SharedResourcePointer<PresetLibrary> library;
+
+    std::vector<int> rows; // Catalogue indices, in display order
+    juce::File selectedFile; // By file rather than index, which a rescan can change
+
+    juce::TextEditor searchBox;
+    juce::ToggleButton similarButton{ "Similar" };
+    juce::TextButton folderButton{ "Folder..." };
+    juce::TextButton saveButton{ "Save..." };
+    juce::Label statusLabel;
+    juce::ListBox list{ {}, this };
+
+    std::unique_ptr<juce::FileChooser> chooser;
+
+    static constexpr int rowHeight = PresetLibrary::thumbnailHeight + 6;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBrowserComponent)
+};
@@ -0,0 +1,683 @@
+#include "PresetLibrary.h"
+#include <string_view>
+
+using namespace EqConstants;
+
+namespace
+{
+    constexpr char indexMagic[4] = { 'J', 'E', 'Q', 'I' };
+    constexpr double curveSampleRate = 48000.0; // Curves are compared with each other, so one rate for all
+    constexpr float thumbnailRangeDb = 18.0f;
+
+    // The parameter vector - order of Record::params
+    const juce::StringArray& paramIds()
+    {
+        static const juce::StringArray ids = []
+            {
+                juce::StringArray list{ "inGain", "outGain", "hpfEnabled", "hpfFreq", "hpfSlope",
+                                        "lpfEnabled", "lpfFreq", "lpfSlope" };
+
+                for (int i = 1; i <= maxEqBands; ++i)
+                    for (auto* type : { "enabled", "freq", "gain", "q" })
+                        list.add(eqBandParamType(i, type));
+
+                list.addArray({ "eqMode", "geqLayout", "geqQ" });
+                for (auto layout : { GraphicEq::Layout::thirdOctave, GraphicEq::Layout::octave })
+                    for (int b = 0; b < GraphicEq::getNumBands(layout); ++b)
+                        list.add(GraphicEq::getParamId(layout, b));
+
+                jassert(list.size() == PresetLibrary::numParams);
+                return list;
+            }();
+        return ids;
+    }
+
+    // The parameter layout's defaults, for presets saved before a parameter existed
+    void setDefaultParams(float* params)
+    {
+        std::fill(params, params + PresetLibrary::numParams, 0.0f); // Graphic mode off and flat
+
+        const float defaults[] = { 0.0f, 0.0f, 1.0f, 20.0f, 0.0f, 1.0f, 20000.0f, 0.0f };
+        std::copy(std::begin(defaults), std::end(defaults), params);
+
+        for (int b = 0; b < maxEqBands; ++b)
+        {
+            float* band = params + 8 + 4 * b;
+            band[0] = b < 3 ? 1.0f : 0.0f;
+            band[1] = juce::jmap<float>((float)(b + 1), 1.0f, (float)maxEqBands, 100.0f, 5000.0f);
+            band[2] = 0.0f;
+            band[3] = 2.0f;
+        }
+    }
+
+    JuceEQAudioProcessor::ChainSnapshot snapshotFromParams(const float* params)
+    {
+        JuceEQAudioProcessor::ChainSnapshot snap;
+        snap.inGainDb = params[0];
+        snap.outGainDb = params[1];
+
+        snap.hpfEnabled = params[2] > 0.5f;
+        snap.hpfFreqHz = params[3];
+        snap.hpfIndex = (int)params[4];
+        snap.hpfStages = JuceEQAudioProcessor::numStagesForSlopeIndex(snap.hpfIndex);
+
+        snap.lpfEnabled = params[5] > 0.5f;
+        snap.lpfFreqHz = params[6];
+        snap.lpfIndex = (int)params[7];
+        snap.lpfStages = JuceEQAudioProcessor::numStagesForSlopeIndex(snap.lpfIndex);
+
+        for (int b = 0; b < maxEqBands; ++b)
+        {
+            const float* band = params + 8 + 4 * b;
+            snap.bands[b] = { band[0] > 0.5f, band[1], band[3], band[2] };
+        }
+
+        const float* graphic = params + 8 + 4 * maxEqBands;
+        snap.graphicMode = (int)graphic[0] == 1;
+        snap.graphicLayout = (int)graphic[1] == 1 ? GraphicEq::Layout::octave : GraphicEq::Layout::thirdOctave;
+        snap.graphicQMode = (int)graphic[2] == 1 ? GraphicEq::QMode::proportional : GraphicEq::QMode::constant;
+
+        const float* gains = graphic + 3 + (snap.graphicLayout == GraphicEq::Layout::octave ? GraphicEq::numThirdOctaveBands : 0);
+        std::copy(gains, gains + GraphicEq::getNumBands(snap.graphicLayout), snap.graphicGainsDb.begin());
+
+        return snap;
+    }
+
+    inline char lowerAscii(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+    }
+
+    inline bool isWordStart(const char* text, size_t i)
+    {
+        if (i == 0)
+            return true;
+
+        const char c = text[i - 1];
+        return c == ' ' || c == '_' || c == '-' || c == ',' || c == '.' || c == '(';
+    }
+
+    // How well 'word' (lower case) matches text: a substring scores highest, then the characters in order with
+    // bonuses for runs and word starts. -1 if it doesn't match at all.
+    int fuzzyScore(const char* text, size_t length, std::string_view word)
+    {
+        if (word.empty())
+            return 0;
+
+        for (size_t i = 0; i + word.size() <= length; ++i)
+        {
+            size_t n = 0;
+            while (n < word.size() && lowerAscii(text[i + n]) == word[n])
+                ++n;
+
+            if (n == word.size())
+                return 100 + 4 * (int)word.size() + (isWordStart(text, i) ? 20 : 0);
+        }
+
+        int score = 0;
+        size_t t = 0, lastMatch = std::string_view::npos;
+
+        for (const char q : word)
+        {
+            while (t < length && lowerAscii(text[t]) != q)
+                ++t;
+
+            if (t == length)
+                return -1;
+
+            score += 1 + (lastMatch != std::string_view::npos && t == lastMatch + 1 ? 3 : 0) + (isWordStart(text, t) ? 2 : 0);
+            lastMatch = t++;
+        }
+
+        return score;
+    }
+
+    juce::PropertiesFile::Options settingsOptions()
+    {
+        juce::PropertiesFile::Options options;
+        options.applicationName = "JuceEQ";
+        options.filenameSuffix = ".settings";
+        options.folderName = "JuceEQ";
+        options.osxLibrarySubFolder = "Application Support";
+        return options;
+    }
+}
+
+//==============================================================================
+bool PresetLibrary::Catalogue::open(const juce::File& file)
+{
+    close();
+
+    if (!file.existsAsFile())
+        return false;
+
+    mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*>(mapping->getData());
+    const auto size = (juce::uint64)mapping->getSize();
+
+    Header header;
+    if (data == nullptr || size < sizeof(Header))
+    {
+        close();
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(Header));
+
+    const bool valid = std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) == 0
+        && header.version == indexVersion
+        && header.numParams == (juce::uint32)numParams
+        && header.numCurvePoints == (juce::uint32)numCurvePoints
+        && header.recordBytes == (juce::uint32)sizeof(Record)
+        && sizeof(Header) + (juce::uint64)header.numEntries * sizeof(Record) <= header.stringsOffset
+        && header.stringsOffset + header.stringsBytes <= size;
+
+    if (!valid)
+    {
+        close();
+        return false;
+    }
+
+    records = reinterpret_cast<const Record*>(data + sizeof(Header)); // Mappings are page aligned
+    strings = data + header.stringsOffset;
+    stringsBytes = header.stringsBytes;
+    numEntries = (int)header.numEntries;
+    return true;
+}
+
+void PresetLibrary::Catalogue::close()
+{
+    mapping.reset();
+    records = nullptr;
+    strings = nullptr;
+    stringsBytes = 0;
+    numEntries = 0;
+}
+
+juce::String PresetLibrary::Catalogue::getString(juce::uint32 offset, juce::uint32 bytes) const
+{
+    if ((juce::uint64)offset + bytes > stringsBytes)
+        return {};
+
+    return juce::String::fromUTF8(strings + offset, (int)bytes);
+}
+
+//==============================================================================
+PresetLibrary::PresetLibrary()
+    : juce::Thread("JuceEQ preset scan"),
+      settings(settingsOptions()),
+      thumbnailPool(juce::ThreadPoolOptions{}.withThreadName("JuceEQ thumbnails")
+                                             .withNumberOfThreads(2)
+                                             .withDesiredThreadPriority(juce::Thread::Priority::background))
+{
+    const auto defaultFolder = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("JuceEQ Presets");
+    setFolder(juce::File(settings.getValue("presetFolder", defaultFolder.getFullPathName())));
+}
+
+PresetLibrary::~PresetLibrary()
+{
+    thumbnailPool.removeAllJobs(true, 2000);
+    stopThread(4000);
+    cancelPendingUpdate();
+}
+
+void PresetLibrary::setFolder(const juce::File& newFolder)
+{
+    resetScan();
+
+    folder = newFolder;
+    settings.setValue("presetFolder", folder.getFullPathName());
+
+    catalogue.open(getIndexFile());
+    ++generation;
+    thumbnails.clear();
+    thumbnailsRequested.clear();
+    thumbnailOrder.clear();
+    thumbnailPool.removeAllJobs(false, 0);
+
+    rescan();
+    listeners.call([](Listener& l) { l.presetIndexChanged(); });
+}
+
+void PresetLibrary::rescan()
+{
+    resetScan();
+
+    scanFolder = folder;
+    scanIndexFile = getIndexFile();
+    scanOutputFile = scanIndexFile.withFileExtension("new");
+    scanIndexFile.getParentDirectory().createDirectory();
+
+    scanning = true;
+    startThread(juce::Thread::Priority::background);
+}
+
+void PresetLibrary::resetScan()
+{
+    stopThread(4000);
+    scanFinished = false;
+    scanning = false;
+
+    if (scanOutputFile != juce::File())
+        scanOutputFile.deleteFile();
+}
+
+// One catalogue per folder, next to the settings file
+juce::File PresetLibrary::getIndexFile() const
+{
+    const auto name = juce::String::toHexString(folder.getFullPathName().hashCode64()) + ".jeqindex";
+    return settings.getFile().getSiblingFile("PresetIndex").getChildFile(name);
+}
+
+juce::String PresetLibrary::getName(int index) const
+{
+    const auto& r = catalogue.records[index];
+    return catalogue.getString(r.nameOffset, r.nameBytes);
+}
+
+juce::String PresetLibrary::getTags(int index) const
+{
+    const auto& r = catalogue.records[index];
+    return catalogue.getString(r.tagsOffset, r.tagsBytes);
+}
+
+juce::File PresetLibrary::getFile(int index) const
+{
+    const auto& r = catalogue.records[index];
+    return folder.getChildFile(catalogue.getString(r.pathOffset, r.pathBytes));
+}
+
+const float* PresetLibrary::getCurveDb(int index) const
+{
+    return catalogue.records[index].curveDb;
+}
+
+//==============================================================================
+std::vector<int> PresetLibrary::search(const juce::String& query) const
+{
+    std::vector<std::string> words;
+    for (const auto& word : juce::StringArray::fromTokens(query.toLowerCase(), " ,", {}))
+        if (word.isNotEmpty())
+            words.push_back(word.toStdString());
+
+    std::vector<int> result;
+    result.reserve((size_t)catalogue.numEntries);
+
+    if (words.empty())
+    {
+        for (int i = 0; i < catalogue.numEntries; ++i)
+            result.push_back(i);
+        return result;
+    }
+
+    std::vector<int> scores((size_t)catalogue.numEntries, -1);
+
+    // Straight off the mapped strings - no juce::String per entry
+    for (int i = 0; i < catalogue.numEntries; ++i)
+    {
+        const auto& r = catalogue.records[i];
+        if ((juce::uint64)r.nameOffset + r.nameBytes > catalogue.stringsBytes
+            || (juce::uint64)r.tagsOffset + r.tagsBytes > catalogue.stringsBytes)
+            continue;
+
+        int total = 0;
+        for (const auto& word : words)
+        {
+            const int score = juce::jmax(fuzzyScore(catalogue.strings + r.nameOffset, r.nameBytes, word),
+                                         fuzzyScore(catalogue.strings + r.tagsOffset, r.tagsBytes, word));
+            if (score < 0)
+            {
+                total = -1;
+                break;
+            }
+            total += score;
+        }
+
+        if (total >= 0)
+        {
+            scores[(size_t)i] = total;
+            result.push_back(i);
+        }
+    }
+
+    // Ties keep the catalogue's name order
+    std::stable_sort(result.begin(), result.end(), [&scores](int a, int b) { return scores[(size_t)a] > scores[(size_t)b]; });
+    return result;
+}
+
+std::vector<int> PresetLibrary::sortByCurveDistance(std::vector<int> candidates, const float* curveDb) const
+{
+    std::vector<float> distance((size_t)catalogue.numEntries, 0.0f);
+
+    for (const int i : candidates)
+    {
+        const float* curve = catalogue.records[i].curveDb;
+        float sum = 0.0f;
+        for (int p = 0; p < numCurvePoints; ++p)
+        {
+            const float d = curve[p] - curveDb[p];
+            sum += d * d;
+        }
+        distance[(size_t)i] = sum;
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+        [&distance](int a, int b) { return distance[(size_t)a] < distance[(size_t)b]; });
+    return candidates;
+}
+
+//==============================================================================
+juce::Image PresetLibrary::getThumbnail(int index)
+{
+    if (auto it = thumbnails.find(index); it != thumbnails.end())
+        return it->second;
+
+    if (index < 0 || index >= catalogue.numEntries || !thumbnailsRequested.insert(index).second)
+        return {};
+
+    std::array<float, numCurvePoints> curve;
+    std::copy_n(catalogue.records[index].curveDb, numCurvePoints, curve.begin());
+
+    thumbnailPool.addJob([this, curve, index, forGeneration = generation]()
+        {
+            auto image = renderThumbnail(curve);
+            {
+                const juce::ScopedLock sl(renderedLock);
+                rendered.push_back({ forGeneration, index, std::move(image) });
+            }
+            triggerAsyncUpdate();
+        });
+
+    return {};
+}
+
+// Software image, so it can be drawn off the message thread
+juce::Image PresetLibrary::renderThumbnail(const std::array<float, numCurvePoints>& curveDb)
+{
+    juce::Image image(juce::Image::ARGB, thumbnailWidth, thumbnailHeight, true, juce::SoftwareImageType());
+    juce::Graphics graphics(image);
+
+    const auto bounds = image.getBounds().toFloat();
+    graphics.setColour(juce::Colour(0xFF15181A)); // The graph's plot colours
+    graphics.fillRoundedRectangle(bounds, 3.0f);
+
+    auto dbToY = [&bounds](float db)
+        {
+            const float clamped = juce::jlimit(-thumbnailRangeDb, thumbnailRangeDb, db);
+            return juce::jmap(clamped, -thumbnailRangeDb, thumbnailRangeDb, bounds.getBottom() - 2.0f, bounds.getY() + 2.0f);
+        };
+
+    graphics.setColour(juce::Colour(0xFF262A2E));
+    graphics.drawHorizontalLine(juce::roundToInt(dbToY(0.0f)), bounds.getX(), bounds.getRight());
+
+    juce::Path curve;
+    for (int i = 0; i < numCurvePoints; ++i)
+    {
+        const float x = bounds.getX() + bounds.getWidth() * (float)i / (float)(numCurvePoints - 1);
+        if (i == 0)
+            curve.startNewSubPath(x, dbToY(curveDb[(size_t)i]));
+        else
+            curve.lineTo(x, dbToY(curveDb[(size_t)i]));
+    }
+
+    graphics.setColour(juce::Colours::white);
+    graphics.strokePath(curve, juce::PathStrokeType(1.2f));
+    return image;
+}
+
+//==============================================================================
+const std::vector<double>& PresetLibrary::getCurveFrequencies()
+{
+    static const std::vector<double> freqs = []
+        {
+            std::vector<double> f((size_t)numCurvePoints);
+            for (int i = 0; i < numCurvePoints; ++i)
+                f[(size_t)i] = 20.0 * std::pow(1000.0, (double)i / (double)(numCurvePoints - 1));
+            return f;
+        }();
+    return freqs;
+}
+
+std::array<float, PresetLibrary::numCurvePoints> PresetLibrary::getCurveDb(const JuceEQAudioProcessor& processor)
+{
+    std::vector<double> mags(getCurveFrequencies().size());
+    processor.getFrequencyResponse(getCurveFrequencies(), mags);
+
+    std::array<float, numCurvePoints> curve;
+    for (int i = 0; i < numCurvePoints; ++i)
+        curve[(size_t)i] = (float)juce::Decibels::gainToDecibels(mags[(size_t)i], -100.0);
+    return curve;
+}
+
+void PresetLibrary::computeCurve(const float* params, float* curveDb)
+{
+    std::vector<double> mags(getCurveFrequencies().size());
+    JuceEQAudioProcessor::getFrequencyResponse(snapshotFromParams(params), curveSampleRate, getCurveFrequencies(), mags);
+
+    for (int i = 0; i < numCurvePoints; ++i)
+        curveDb[i] = (float)juce::Decibels::gainToDecibels(mags[(size_t)i], -100.0);
+}
+
+//==============================================================================
+bool PresetLibrary::loadPreset(const juce::File& file, juce::AudioProcessorValueTreeState& apvts)
+{
+    auto xml = juce::XmlDocument::parse(file);
+    if (xml == nullptr || !xml->hasTagName(apvts.state.getType()))
+        return false;
+
+    // A preset is a curve - it leaves bypass as it was
+    auto* bypass = apvts.getParameter("bypass");
+    const float bypassValue = bypass != nullptr ? bypass->getValue() : 0.0f;
+
+    apvts.replaceState(juce::ValueTree::fromXml(*xml));
+
+    if (bypass != nullptr)
+        bypass->setValueNotifyingHost(bypassValue);
+    return true;
+}
+
+bool PresetLibrary::savePreset(const juce::File& file, juce::AudioProcessorValueTreeState& apvts)
+{
+    auto xml = apvts.copyState().createXml();
+    return xml != nullptr && xml->writeTo(file);
+}
+
+bool PresetLibrary::readPreset(const juce::File& file, const juce::String& relativePath, ScannedPreset& preset)
+{
+    auto xml = juce::XmlDocument::parse(file);
+    if (xml == nullptr || !xml->hasTagName("PARAMS")) // The APVTS state type
+        return false;
+
+    auto& record = preset.record;
+    setDefaultParams(record.params);
+
+    for (auto* param : xml->getChildWithTagNameIterator("PARAM"))
+    {
+        const int index = paramIds().indexOf(param->getStringAttribute("id"));
+        if (index >= 0)
+            record.params[index] = (float)param->getDoubleAttribute("value", record.params[index]);
+    }
+
+    computeCurve(record.params, record.curveDb);
+
+    // Tags: the file's own, then every folder between the library root and the file
+    juce::StringArray tags;
+    tags.addTokens(xml->getStringAttribute("tags").toLowerCase(), ",", {});
+    tags.addTokens(relativePath.upToLastOccurrenceOf("/", false, false).toLowerCase(), "/", {});
+    tags.trim();
+    tags.removeEmptyStrings();
+    tags.removeDuplicates(false);
+
+    preset.path = relativePath;
+    preset.name = file.getFileNameWithoutExtension();
+    preset.tags = tags.joinIntoString(",");
+    return true;
+}
+
+bool PresetLibrary::writeIndex(const juce::File& file, std::vector<ScannedPreset>& presets)
+{
+    juce::MemoryOutputStream strings;
+
+    auto addString = [&strings](const juce::String& text, juce::uint32& offset, juce::uint32& bytes)
+        {
+            offset = (juce::uint32)strings.getDataSize();
+            bytes = (juce::uint32)text.getNumBytesAsUTF8();
+            strings.write(text.toRawUTF8(), bytes);
+        };
+
+    for (auto& preset : presets)
+    {
+        addString(preset.path, preset.record.pathOffset, preset.record.pathBytes);
+        addString(preset.name, preset.record.nameOffset, preset.record.nameBytes);
+        addString(preset.tags, preset.record.tagsOffset, preset.record.tagsBytes);
+    }
+
+    Header header{};
+    std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = indexVersion;
+    header.numEntries = (juce::uint32)presets.size();
+    header.numParams = (juce::uint32)numParams;
+    header.numCurvePoints = (juce::uint32)numCurvePoints;
+    header.recordBytes = (juce::uint32)sizeof(Record);
+    header.stringsOffset = sizeof(Header) + presets.size() * sizeof(Record);
+    header.stringsBytes = strings.getDataSize();
+
+    file.deleteFile();
+    juce::FileOutputStream out(file);
+    if (!out.openedOk())
+        return false;
+
+    out.write(&header, sizeof(header));
+    for (const auto& preset : presets)
+        out.write(&preset.record, sizeof(Record));
+    out.write(strings.getData(), strings.getDataSize());
+    out.flush();
+
+    return out.getStatus().wasOk();
+}
+
+//==============================================================================
+// Background scan: stat everything, re-read only what changed, and only write a catalogue if something did
+void PresetLibrary::run()
+{
+    Catalogue previous;
+    previous.open(scanIndexFile);
+
+    std::unordered_map<juce::String, int> previousByPath;
+    for (int i = 0; i < previous.numEntries; ++i)
+        previousByPath[previous.getString(previous.records[i].pathOffset, previous.records[i].pathBytes)] = i;
+
+    std::vector<ScannedPreset> presets;
+    presets.reserve((size_t)previous.numEntries);
+    int numReused = 0;
+    bool changed = false;
+
+    if (scanFolder.isDirectory())
+    {
+        for (const auto& entry : juce::RangedDirectoryIterator(scanFolder, true, "*.xml", juce::File::findFiles))
+        {
+            if (threadShouldExit())
+                return;
+
+            const auto file = entry.getFile();
+            const auto path = file.getRelativePathFrom(scanFolder).replaceCharacter('\\', '/');
+            const auto modified = entry.getModificationTime().toMilliseconds();
+            const auto size = entry.getFileSize();
+
+            ScannedPreset preset;
+            const auto it = previousByPath.find(path);
+
+            if (it != previousByPath.end() && previous.records[it->second].modificationTime == modified
+                && previous.records[it->second].fileSize == size)
+            {
+                const auto& r = previous.records[it->second];
+                preset.record = r;
+                preset.path = path;
+                preset.name = previous.getString(r.nameOffset, r.nameBytes);
+                preset.tags = previous.getString(r.tagsOffset, r.tagsBytes);
+                ++numReused;
+            }
+            else if (readPreset(file, path, preset))
+            {
+                changed = true;
+            }
+            else
+            {
+                continue; // Some other XML file
+            }
+
+            preset.record.modificationTime = modified;
+            preset.record.fileSize = size;
+            presets.push_back(std::move(preset));
+        }
+    }
+
+    changed = changed || numReused != previous.numEntries; // Files removed (or changed into something else)
+    previous.close();
+
+    if (changed)
+    {
+        std::sort(presets.begin(), presets.end(),
+            [](const ScannedPreset& a, const ScannedPreset& b) { return a.name.compareNatural(b.name) < 0; });
+        scanWroteIndex = writeIndex(scanOutputFile, presets);
+    }
+    else
+    {
+        scanWroteIndex = false;
+    }
+
+    scanFinished = true;
+    triggerAsyncUpdate();
+}
+
+void PresetLibrary::handleAsyncUpdate()
+{
+    if (scanFinished.exchange(false))
+    {
+        scanning = false;
+
+        if (scanWroteIndex)
+        {
+            // Unmap first - Windows won't replace a mapped file
+            const auto indexFile = getIndexFile();
+            catalogue.close();
+            scanOutputFile.moveFileTo(indexFile);
+            catalogue.open(indexFile);
+
+            ++generation;
+            thumbnails.clear();
+            thumbnailsRequested.clear();
+            thumbnailOrder.clear();
+            thumbnailPool.removeAllJobs(false, 0);
+        }
+
+        listeners.call([](Listener& l) { l.presetIndexChanged(); });
+    }
+
+    std::vector<RenderedThumbnail> ready;
+    {
+        const juce::ScopedLock sl(renderedLock);
+        ready.swap(rendered);
+    }
+
+    bool anyNew = false;
+    for (auto& thumbnail : ready)
+    {
+        if (thumbnail.generation != generation)
+            continue;
+
+        thumbnails[thumbnail.index] = std::move(thumbnail.image);
+        thumbnailOrder.push_back(thumbnail.index);
+        anyNew = true;
+    }
+
+    while (thumbnailOrder.size() > maxThumbnails)
+    {
+        thumbnails.erase(thumbnailOrder.front());
+        thumbnailsRequested.erase(thumbnailOrder.front());
+        thumbnailOrder.pop_front();
+    }
+
+    if (anyNew)
+        listeners.call([](Listener& l) { l.presetThumbnailsChanged(); });
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "PluginProcessor.h"
+
+/**
+ * Indexes a folder of presets (the plugin's state XML, *.xml, searched recursively) into a binary catalogue that's
+ * memory-mapped for browsing: per preset its path, name, tags, parameter vector and response curve in dB.
+ * The catalogue lives in the user's app data folder and is mapped as soon as the folder is set, so opening the
+ * browser never parses preset files. A background rescan then only stats the folder and re-reads files whose size
+ * or date changed, and swaps the new catalogue in on the message thread.
+ * Thumbnails are rendered from the stored curves on background threads and cached.
+ * Tags come from a preset's "tags" attribute plus the names of the sub-folders it sits in.
+ * Shared by every editor in the process (use it through juce::SharedResourcePointer); message thread only.
+ */
+class PresetLibrary : private juce::Thread,
+                      private juce::AsyncUpdater
+{
+public:
+    static constexpr int numCurvePoints = 64; // Log spaced, 20 Hz - 20 kHz
+    static constexpr int numParams = 8 + 4 * EqConstants::maxEqBands + 3 + GraphicEq::numThirdOctaveBands + GraphicEq::numOctaveBands;
+    static constexpr int thumbnailWidth = 96;
+    static constexpr int thumbnailHeight = 36;
+
+    PresetLibrary();
+    ~PresetLibrary() override;
+
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void presetIndexChanged() = 0; // Entry indices from before are no longer valid
+        virtual void presetThumbnailsChanged() {}
+    };
+
+    void addListener(Listener* listener) { listeners.add(listener); }
+    void removeListener(Listener* listener) { listeners.remove(listener); }
+
+    // Maps the folder's catalogue (if there is one) and starts a background rescan. Remembered between sessions.
+    void setFolder(const juce::File& folder);
+    juce::File getFolder() const { return folder; }
+
+    void rescan();
+    bool isScanning() const { return scanning; }
+
+    // The mapped catalogue, sorted by name
+    int getNumEntries() const { return catalogue.numEntries; }
+    juce::String getName(int index) const;
+    juce::String getTags(int index) const; // Lower case, comma separated
+    juce::File getFile(int index) const;
+    const float* getCurveDb(int index) const; // numCurvePoints values
+
+    // Fuzzy match of every word in the query against the name or tags, best first; all entries for an empty query
+    std::vector<int> search(const juce::String& query) const;
+
+    // Entries (from 'candidates') ordered by RMS distance of their curve to curveDb, nearest first
+    std::vector<int> sortByCurveDistance(std::vector<int> candidates, const float* curveDb) const;
+
+    // Null until rendered - presetThumbnailsChanged is called once it's ready
+    juce::Image getThumbnail(int index);
+
+    // The frequencies of the stored curves, and the same curve for the processor's current settings
+    static const std::vector<double>& getCurveFrequencies();
+    static std::array<float, numCurvePoints> getCurveDb(const JuceEQAudioProcessor& processor);
+
+    static bool loadPreset(const juce::File& file, juce::AudioProcessorValueTreeState& apvts);
+    static bool savePreset(const juce::File& file, juce::AudioProcessorValueTreeState& apvts);
+
+private:
+    // Catalogue layout: Header, numEntries Records, then the UTF-8 string data the records point into
+    struct Header
+    {
+        char magic[4];
+        juce::uint32 version;
+        juce::uint32 numEntries;
+        juce::uint32 numParams;
+        juce::uint32 numCurvePoints;
+        juce::uint32 recordBytes;
+        juce::uint64 stringsOffset;
+        juce::uint64 stringsBytes;
+        juce::uint8 reserved[24];
+    };
+
+    struct Record
+    {
+        juce::int64 modificationTime; // ms since 1970, for rescans
+        juce::int64 fileSize;
+        juce::uint32 pathOffset, pathBytes; // Relative to the folder, '/' separated
+        juce::uint32 nameOffset, nameBytes;
+        juce::uint32 tagsOffset, tagsBytes;
+        float params[numParams];
+        float curveDb[numCurvePoints];
+    };
+
+    static_assert(sizeof(Header) == 64);
+    static_assert(std::is_trivially_copyable_v<Record>);
+    static constexpr juce::uint32 indexVersion = 2;
+
+    // A mapped catalogue file
+    struct Catalogue
+    {
+        bool open(const juce::File& file); // False (and empty) if it's missing or not the current layout
+        void close();
+        juce::String getString(juce::uint32 offset, juce::uint32 bytes) const;
+
+        std::unique_ptr<juce::MemoryMappedFile> mapping;
+        const Record* records = nullptr;
+        const char* strings = nullptr;
+        juce::uint64 stringsBytes = 0;
+        int numEntries = 0;
+    };
+
+    // A preset on its way into a new catalogue
+    struct ScannedPreset
+    {
+        Record record{};
+        juce::String path, name, tags;
+    };
+
+    static bool readPreset(const juce::File& file, const juce::String& relativePath, ScannedPreset& preset);
+    static void computeCurve(const float* params, float* curveDb);
+    static bool writeIndex(const juce::File& file, std::vector<ScannedPreset>& presets);
+    static juce::Image renderThumbnail(const std::array<float, numCurvePoints>& curveDb);
+
+    juce::File getIndexFile() const;
+    void resetScan(); // Stops a running scan and throws away anything it produced
+
+    void run() override; // The scan
+    void handleAsyncUpdate() override;
+
+    juce::PropertiesFile settings;
+    juce::File folder;
+
+    Catalogue catalogue; // The one being browsed
+    int generation = 0; // Bumped on every swap, so late thumbnails for old indices are dropped
+
+    // Scan hand-over - set before the thread starts, read once it's finished
+    juce::File scanFolder, scanIndexFile, scanOutputFile;
+    std::atomic<bool> scanFinished{ false }, scanWroteIndex{ false };
+    bool scanning = false;
+
+    // Thumbnails
+    juce::ThreadPool thumbnailPool;
+    std::unordered_map<int, juce::Image> thumbnails;
+    std::unordered_set<int> thumbnailsRequested;
+    std::deque<int> thumbnailOrder; // Oldest first, for eviction
+    static constexpr size_t maxThumbnails = 1024;
+
+    struct RenderedThumbnail
+    {
+        int generation, index;
+        juce::Image image;
+    };
+    juce::CriticalSection renderedLock;
+    std::vector<RenderedThumbnail> rendered;
+
+    juce::ListenerList<Listener> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetLibrary)
+};
@@ -0,0 +1,277 @@
+#include "SessionCapture.h"
+#include <bit>
+#include <cstring>
+
+namespace
+{
+    void writeString(juce::OutputStream& out, const juce::String& text)
+    {
+        const auto utf8 = text.toUTF8();
+        const auto bytes = (juce::uint32)text.getNumBytesAsUTF8();
+        out.write(&bytes, sizeof(bytes));
+        out.write(utf8.getAddress(), bytes);
+    }
+
+    bool readString(juce::InputStream& in, juce::String& text)
+    {
+        juce::uint32 bytes = 0;
+        if (in.read(&bytes, sizeof(bytes)) != (int)sizeof(bytes) || bytes > 4096)
+            return false;
+
+        juce::MemoryBlock utf8(bytes);
+        if (in.read(utf8.getData(), (int)bytes) != (int)bytes)
+            return false;
+
+        text = juce::String::fromUTF8((const char*)utf8.getData(), (int)bytes);
+        return true;
+    }
+}
+
+std::unique_ptr<SessionCapture> SessionCapture::createFromEnvironment(juce::AudioProcessorValueTreeState& apvts, const char* kernelName)
+{
+    const auto path = juce::SystemStats::getEnvironmentVariable("JUCEEQ_CAPTURE", {});
+    if (path.isEmpty())
+        return nullptr;
+
+    const auto folder = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+    if (!folder.createDirectory())
+        return nullptr;
+
+    const auto name = "JuceEQ-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S");
+    auto capture = std::make_unique<SessionCapture>(apvts, folder.getNonexistentChildFile(name, ".eqcapture", false), kernelName);
+    return capture->isOpen() ? std::move(capture) : nullptr;
+}
+
+SessionCapture::SessionCapture(juce::AudioProcessorValueTreeState& apvts, const juce::File& outputFile, const char* kernelName)
+    : file(outputFile)
+{
+    juce::StringArray ids;
+    for (auto* parameter : apvts.processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            ids.add(ranged->getParameterID());
+            values.push_back(apvts.getRawParameterValue(ranged->getParameterID()));
+        }
+    }
+
+    lastValues.resize(values.size());
+    changes.resize(values.size());
+
+    stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!stream->openedOk())
+    {
+        stream.reset();
+        return;
+    }
+
+    stream->truncate();
+    stream->write(&magic, sizeof(magic));
+    stream->write(&version, sizeof(version));
+    writeString(*stream, kernelName);
+
+    const auto numParameters = (juce::uint32)ids.size();
+    stream->write(&numParameters, sizeof(numParameters));
+    for (const auto& id : ids)
+        writeString(*stream, id);
+
+    stream->flush();
+
+    ring.calloc(ringBytes);
+    writer = std::make_unique<Writer>(*this);
+    writer->startThread(juce::Thread::Priority::low);
+}
+
+SessionCapture::~SessionCapture()
+{
+    if (writer != nullptr)
+        writer->stopThread(2000);
+
+    spill();
+}
+
+size_t SessionCapture::freeBytes() const noexcept
+{
+    return ringBytes - (size_t)(writeIndex.load(std::memory_order_relaxed) - readIndex.load(std::memory_order_acquire));
+}
+
+void SessionCapture::put(juce::uint64 position, const void* data, size_t bytes) noexcept
+{
+    const auto offset = (size_t)(position & (ringBytes - 1));
+    const auto first = juce::jmin(bytes, ringBytes - offset);
+
+    std::memcpy(ring + offset, data, first);
+    std::memcpy(ring.get(), (const char*)data + first, bytes - first);
+}
+
+void SessionCapture::recordPrepare(double sampleRate, int blockSize, int numChannels, int topologyMode, int engine, bool multirate,
+                                   bool blockFilters, bool bypassParameter)
+{
+    if (!isOpen())
+        return;
+
+    const Prepare prepare{ sampleRate, blockSize, numChannels, topologyMode, engine, multirate ? 1 : 0, bypassParameter ? 1 : 0,
+                           blockFilters ? 1 : 0, 0 };
+    const size_t valueBytes = values.size() * sizeof(float);
+    const RecordHeader header{ prepareRecord, (juce::uint32)(sizeof(Prepare) + valueBytes) };
+
+    // Not the audio thread, so this one waits for the writer rather than leave the blocks without a context
+    for (int waited = 0; freeBytes() < sizeof(header) + header.payloadBytes && waited < 2000; waited += 5)
+        juce::Thread::sleep(5);
+
+    if (freeBytes() < sizeof(header) + header.payloadBytes)
+    {
+        prepared = false; // Blocks are dropped until a prepare gets through
+        return;
+    }
+
+    for (size_t i = 0; i < values.size(); ++i)
+        lastValues[i] = values[i]->load();
+
+    auto position = writeIndex.load(std::memory_order_relaxed);
+    put(position, &header, sizeof(header));
+    put(position += sizeof(header), &prepare, sizeof(prepare));
+    put(position += sizeof(prepare), lastValues.data(), valueBytes);
+    writeIndex.store(position + valueBytes, std::memory_order_release);
+
+    prepared = true;
+}
+
+bool SessionCapture::beginBlock(const juce::AudioBuffer<float>& buffer, bool bypassed, int qualityTier) noexcept
+{
+    if (!isOpen() || !prepared)
+        return false;
+
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+
+    // Changed values, compared bit for bit - a change the replay misses is a replay that isn't exact
+    juce::uint32 numChanges = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        const float value = values[i]->load(std::memory_order_relaxed);
+        if (std::bit_cast<juce::uint32>(value) != std::bit_cast<juce::uint32>(lastValues[i]))
+            changes[numChanges++] = { (juce::uint32)i, value };
+    }
+
+    const size_t changeBytes = numChanges * sizeof(Change);
+    const size_t audioBytes = (size_t)numChannels * (size_t)numSamples * sizeof(float);
+    const RecordHeader header{ blockRecord, (juce::uint32)(sizeof(Block) + changeBytes + audioBytes) };
+    const size_t gapBytes = droppedBlocks > 0 ? sizeof(RecordHeader) + sizeof(Gap) : 0;
+
+    if (freeBytes() < gapBytes + sizeof(header) + header.payloadBytes)
+    {
+        ++droppedBlocks;
+        ++blockIndex;
+        return false;
+    }
+
+    auto position = writeIndex.load(std::memory_order_relaxed);
+
+    if (droppedBlocks > 0)
+    {
+        const RecordHeader gapHeader{ gapRecord, (juce::uint32)sizeof(Gap) };
+        const Gap gap{ droppedBlocks };
+        put(position, &gapHeader, sizeof(gapHeader));
+        put(position += sizeof(gapHeader), &gap, sizeof(gap));
+        position += sizeof(gap);
+        droppedBlocks = 0;
+    }
+
+    put(position, &header, sizeof(header));
+    position += sizeof(header);
+
+    // The Block itself goes in at endBlock, once the checksum is known
+    pendingRecord = position;
+    pendingBlock = { blockIndex++, 0, numChannels, numSamples, bypassed ? 1u : 0u, numChanges, qualityTier, 0 };
+    position += sizeof(Block);
+
+    put(position, changes.data(), changeBytes);
+    position += changeBytes;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        put(position, buffer.getReadPointer(ch), (size_t)numSamples * sizeof(float));
+        position += (juce::uint64)numSamples * sizeof(float);
+    }
+
+    pendingEnd = position;
+
+    for (juce::uint32 c = 0; c < numChanges; ++c)
+        lastValues[changes[c].parameter] = changes[c].value;
+
+    return true;
+}
+
+void SessionCapture::endBlock(const juce::AudioBuffer<float>& buffer) noexcept
+{
+    pendingBlock.outputChecksum = checksum(buffer, pendingBlock.numChannels, pendingBlock.numSamples);
+    put(pendingRecord, &pendingBlock, sizeof(Block));
+    writeIndex.store(pendingEnd, std::memory_order_release);
+}
+
+juce::uint64 SessionCapture::checksum(const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept
+{
+    juce::uint64 hash = 0xcbf29ce484222325ull;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* data = buffer.getReadPointer(ch);
+        for (int i = 0; i < numSamples; ++i)
+            hash = (hash ^ std::bit_cast<juce::uint32>(data[i])) * 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+bool SessionCapture::readHeader(juce::InputStream& in, Header& header)
+{
+    juce::uint32 fileMagic = 0, fileVersion = 0, numParameters = 0;
+    if (in.read(&fileMagic, sizeof(fileMagic)) != (int)sizeof(fileMagic) || fileMagic != magic
+        || in.read(&fileVersion, sizeof(fileVersion)) != (int)sizeof(fileVersion) || fileVersion != version
+        || !readString(in, header.kernelName)
+        || in.read(&numParameters, sizeof(numParameters)) != (int)sizeof(numParameters) || numParameters > 4096)
+        return false;
+
+    header.parameterIds.clear();
+    for (juce::uint32 i = 0; i < numParameters; ++i)
+    {
+        juce::String id;
+        if (!readString(in, id))
+            return false;
+        header.parameterIds.add(id);
+    }
+
+    return true;
+}
+
+// Writer thread (or the destructor, after it's gone) - whatever is published goes to the file
+void SessionCapture::spill()
+{
+    if (stream == nullptr)
+        return;
+
+    const auto w = writeIndex.load(std::memory_order_acquire);
+    const auto r = readIndex.load(std::memory_order_relaxed);
+    if (w == r)
+        return;
+
+    const auto offset = (size_t)(r & (ringBytes - 1));
+    const auto bytes = (size_t)(w - r);
+    const auto first = juce::jmin(bytes, ringBytes - offset);
+
+    stream->write(ring + offset, first);
+    stream->write(ring.get(), bytes - first);
+    stream->flush();
+
+    readIndex.store(w, std::memory_order_release);
+}
+
+void SessionCapture::Writer::run()
+{
+    while (!threadShouldExit())
+    {
+        capture.spill();
+        wait(20);
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * Opt-in recording of everything an instance's audio path depends on, so a field issue (a CPU spike or a glitch
+ * during one automation pass) can be replayed offline sample for sample with JuceEQReplay:
+ *  - every prepareToPlay: sample rate, block size, channels, topology mode, engine, multirate, whether the block
+ *    filters were used and all parameter values
+ *  - every block: its size, whether it was bypassed, the CPU governor's quality tier it ran at, the parameters that
+ *    changed since the last block (as the raw values the DSP reads), the input audio and a checksum of the output,
+ *    so the replay can prove it's exact
+ * The audio thread only copies into a preallocated ring - no locks or allocation. A background thread spills the
+ * ring to the file while the session runs, so a capture survives the host being killed. If the disk can't keep up,
+ * whole blocks are dropped and a gap record marks where; the replay can't be exact past one.
+ *
+ * On a customer's machine: set JUCEEQ_CAPTURE=/path/to/folder before starting the host. Each plugin instance writes
+ * its own JuceEQ-<date>-<time>.eqcapture there from construction until it's deleted. Stereo at 48 kHz is about
+ * 400 KB per second.
+ */
+class SessionCapture
+{
+public:
+    // Opens a capture in the JUCEEQ_CAPTURE folder - nullptr if it isn't set or the file can't be created
+    static std::unique_ptr<SessionCapture> createFromEnvironment(juce::AudioProcessorValueTreeState& apvts, const char* kernelName);
+
+    SessionCapture(juce::AudioProcessorValueTreeState& apvts, const juce::File& file, const char* kernelName);
+    ~SessionCapture(); // Spills what's left and closes the file
+
+    bool isOpen() const noexcept { return stream != nullptr; }
+    juce::File getFile() const { return file; }
+
+    // prepareToPlay, before it reads the parameters - waits for ring space rather than drop it
+    void recordPrepare(double sampleRate, int blockSize, int numChannels, int topologyMode, int engine, bool multirate,
+                       bool blockFilters, bool bypassParameter);
+
+    // Audio thread, around the processing: begin copies the input and parameter changes, end adds the output
+    // checksum and publishes the record. Returns false (call no endBlock) if the block was dropped.
+    bool beginBlock(const juce::AudioBuffer<float>& buffer, bool bypassed, int qualityTier) noexcept;
+    void endBlock(const juce::AudioBuffer<float>& buffer) noexcept;
+
+    // 64-bit FNV-1a over the samples' bit patterns, channel by channel
+    static juce::uint64 checksum(const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept;
+
+    // ----- File format -----
+    // Header: magic, version, the kernel variant name and the parameter IDs (index order for the records).
+    // Then records, each a RecordHeader and its payload. Little-endian, as the host writes it.
+    static constexpr juce::uint32 magic = 0x4351454a; // "JEQC"
+    static constexpr juce::uint32 version = 5;
+
+    enum RecordType : juce::uint32 { prepareRecord = 1, blockRecord = 2, gapRecord = 3 };
+
+    struct RecordHeader
+    {
+        juce::uint32 type, payloadBytes;
+    };
+
+    // Followed by one float per parameter
+    struct Prepare
+    {
+        double sampleRate;
+        juce::int32 blockSize, numChannels, topologyMode, engine, multirate, bypassParameter;
+        juce::int32 blockFilters, unused; // Whether they were used, as the prepare settled it
+    };
+
+    // Followed by numChanges Changes, then numChannels * numSamples floats, one channel after another
+    struct Block
+    {
+        juce::uint64 index, outputChecksum;
+        juce::int32 numChannels, numSamples;
+        juce::uint32 bypassed, numChanges;
+        juce::int32 qualityTier, unused; // unused keeps the record free of padding bytes
+    };
+
+    struct Change
+    {
+        juce::uint32 parameter;
+        float value;
+    };
+
+    struct Gap
+    {
+        juce::uint64 droppedBlocks;
+    };
+
+    struct Header
+    {
+        juce::String kernelName;
+        juce::StringArray parameterIds;
+    };
+
+    static bool readHeader(juce::InputStream& in, Header& header);
+
+private:
+    class Writer : public juce::Thread
+    {
+    public:
+        explicit Writer(SessionCapture& c) : juce::Thread("JuceEQ capture writer"), capture(c) {}
+        void run() override;
+
+    private:
+        SessionCapture& capture;
+    };
+
+    size_t freeBytes() const noexcept;
+    void put(juce::uint64 position, const void* data, size_t bytes) noexcept; // Wraps around the ring
+    void spill();
+
+    static constexpr size_t ringBytes = (size_t)32 << 20; // Power of two, ~80 s of stereo 48 kHz
+
+    juce::File file;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    juce::HeapBlock<char> ring;
+    std::atomic<juce::uint64> writeIndex{ 0 }, readIndex{ 0 }; // Bytes ever written / spilled
+
+    std::vector<std::atomic<float>*> values; // Raw parameter values, in header order
+    std::vector<float> lastValues; // As last recorded
+    std::vector<Change> changes; // Scratch for one block
+
+    // Audio thread only
+    juce::uint64 blockIndex = 0, droppedBlocks = 0;
+    juce::uint64 pendingRecord = 0; // Ring position of the Block begun but not ended
+    juce::uint64 pendingEnd = 0;
+    Block pendingBlock{};
+    bool prepared = false;
+
+    std::unique_ptr<Writer> writer;
+
+    JUCE_DECLARE_NON_COPYABLE(SessionCapture)
+};
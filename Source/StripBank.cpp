@@ -0,0 +1,256 @@
+#include "StripBank.h"
+#include <bit>
+#include <cmath>
+
+void StripBank::GainRamp::jumpTo(float value)
+{
+    current = target = value;
+    step = 0.0f;
+    remaining = 0;
+}
+
+// As SmoothedValue<float, Linear>::setTargetValue
+void StripBank::GainRamp::setTarget(float newTarget, int rampSamples)
+{
+    if (newTarget == target)
+        return;
+
+    if (rampSamples <= 0)
+    {
+        jumpTo(newTarget);
+        return;
+    }
+
+    target = newTarget;
+    remaining = rampSamples;
+    step = (target - current) / (float)remaining;
+}
+
+void StripBank::GainRamp::apply(const float* in, size_t inStride, float* out, size_t outStride, int numSamples)
+{
+    int i = 0;
+    for (; i < numSamples && remaining > 0; ++i)
+    {
+        current = --remaining == 0 ? target : current + step;
+        out[(size_t)i * outStride] = in[(size_t)i * inStride] * current;
+    }
+
+    if (current == 1.0f && in == out && inStride == outStride)
+        return;
+
+    const float g = current;
+    for (; i < numSamples; ++i)
+        out[(size_t)i * outStride] = in[(size_t)i * inStride] * g;
+}
+
+bool StripBank::prepare(double newSampleRate, int maxBlockSize, int newNumStrips)
+{
+    sampleRate = newSampleRate;
+    maxBlock = juce::jmax(1, maxBlockSize);
+    numStrips = juce::jmax(0, newNumStrips);
+    rampSamples = (int)std::floor(0.02 * sampleRate); // The processor's gain ramps
+
+    const int numGroups = (numStrips + lanesPerGroup - 1) / lanesPerGroup;
+
+    const bool allocated = arena.build([&](DspArena& a)
+        {
+            strips = a.take<Strip>((size_t)numStrips);
+            groups = a.take<Group>((size_t)numGroups);
+            interleaved = a.take<float>((size_t)maxBlock * lanesPerGroup);
+        });
+
+    if (!allocated)
+    {
+        numStrips = 0;
+        return false;
+    }
+
+    // Every lane passes through until its strip gets settings
+    for (auto& group : groups)
+        for (auto& section : group.sections)
+            std::fill(std::begin(section.m0), std::end(section.m0), 1.0f);
+
+    return true;
+}
+
+void StripBank::reset()
+{
+    for (auto& group : groups)
+        for (auto& state : group.states)
+            state = {};
+}
+
+// Designs in double as the processor's sections do, then into the lane's SVF slot
+void StripBank::setSlot(int strip, int slot, const FilterSection::Design* design)
+{
+    auto& group = groups[(size_t)(strip / lanesPerGroup)];
+    auto& section = group.sections[(size_t)slot];
+    const int lane = strip % lanesPerGroup;
+    const juce::uint32 bit = 1u << slot;
+    auto& active = strips[(size_t)strip].activeSlots;
+
+    if (design == nullptr)
+    {
+        section.g[lane] = section.gk[lane] = section.h[lane] = 0.0f;
+        section.m0[lane] = 1.0f;
+        section.m1[lane] = section.m2[lane] = 0.0f;
+        active &= ~bit;
+        return;
+    }
+
+    double c[6];
+    FilterSection::makeSvfCoefficients(*design, c);
+
+    const bool firstOrder = design->shape == FilterSection::Shape::firstOrderHighPass
+                            || design->shape == FilterSection::Shape::firstOrderLowPass;
+
+    if (firstOrder)
+    {
+        // The one-pole as the band integrator (see LaneSectionCoefficients)
+        section.g[lane] = 0.0f;
+        section.gk[lane] = 1.0f;
+        section.h[lane] = (float)c[0];
+        section.m0[lane] = (float)c[3];
+        section.m1[lane] = (float)c[5];
+        section.m2[lane] = 0.0f;
+        group.states[(size_t)slot].ic2[lane] = 0.0f; // Left over if the slot was second order
+    }
+    else
+    {
+        section.g[lane] = (float)c[0];
+        section.gk[lane] = (float)c[1];
+        section.h[lane] = (float)c[2];
+        section.m0[lane] = (float)c[3];
+        section.m1[lane] = (float)c[4];
+        section.m2[lane] = (float)c[5];
+    }
+
+    active |= bit;
+}
+
+void StripBank::updateGroupSlots(int group)
+{
+    const int first = group * lanesPerGroup;
+    const int last = juce::jmin(numStrips, first + lanesPerGroup);
+
+    juce::uint32 slots = 0;
+    for (int s = first; s < last; ++s)
+        slots |= strips[(size_t)s].activeSlots;
+
+    groups[(size_t)group].activeSlots = slots;
+}
+
+void StripBank::setSettings(int strip, const Settings& next)
+{
+    jassert(juce::isPositiveAndBelow(strip, numStrips));
+    auto& s = strips[(size_t)strip];
+    const auto& prev = s.settings;
+    const bool all = !s.configured;
+
+    if (all || next.hpfEnabled != prev.hpfEnabled || next.hpfStages != prev.hpfStages
+        || next.hpfIndex != prev.hpfIndex || next.hpfFreqHz != prev.hpfFreqHz)
+    {
+        const int stages = next.hpfEnabled ? juce::jlimit(1, maxCascadeStages, next.hpfStages) : 0;
+        const auto design = EqDesign::hpfDesign(next, sampleRate);
+        for (int k = 0; k < maxCascadeStages; ++k)
+            setSlot(strip, k, k < stages ? &design : nullptr);
+    }
+
+    for (int b = 0; b < EqConstants::maxEqBands; ++b)
+    {
+        const auto& band = next.bands[(size_t)b];
+        const auto& old = prev.bands[(size_t)b];
+
+        if (!all && band.enabled == old.enabled && band.freqHz == old.freqHz && band.q == old.q && band.gainDb == old.gainDb)
+            continue;
+
+        // A 0 dB peak is a wire
+        const auto design = EqDesign::peakDesign(band, sampleRate);
+        setSlot(strip, firstPeakSlot + b, band.enabled && design.gainDb != 0.0 ? &design : nullptr);
+    }
+
+    if (all || next.lpfEnabled != prev.lpfEnabled || next.lpfStages != prev.lpfStages
+        || next.lpfIndex != prev.lpfIndex || next.lpfFreqHz != prev.lpfFreqHz)
+    {
+        const int stages = next.lpfEnabled ? juce::jlimit(1, maxCascadeStages, next.lpfStages) : 0;
+        const auto design = EqDesign::lpfDesign(next, sampleRate);
+        for (int k = 0; k < maxCascadeStages; ++k)
+            setSlot(strip, firstLpfSlot + k, k < stages ? &design : nullptr);
+    }
+
+    const float inGain = juce::Decibels::decibelsToGain(next.inGainDb);
+    const float outGain = juce::Decibels::decibelsToGain(next.outGainDb);
+
+    if (all)
+    {
+        s.inGain.jumpTo(inGain);
+        s.outGain.jumpTo(outGain);
+    }
+    else
+    {
+        s.inGain.setTarget(inGain, rampSamples);
+        s.outGain.setTarget(outGain, rampSamples);
+    }
+
+    s.settings = next;
+    s.configured = true;
+    updateGroupSlots(strip / lanesPerGroup);
+}
+
+void StripBank::process(float* const* channels, int numSamples)
+{
+    processLayout({ channels, nullptr, 1 }, numSamples);
+}
+
+void StripBank::processInterleaved(float* data, int numSamples)
+{
+    processLayout({ nullptr, data, numStrips }, numSamples);
+}
+
+void StripBank::processLayout(const BufferLayout& buffers, int numSamples)
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    // Group by group, so one group's coefficients and states stay in cache for the whole block
+    for (int g = 0; g < (int)groups.size(); ++g)
+        for (int offset = 0; offset < numSamples; offset += maxBlock)
+            processGroup(g, buffers, offset, juce::jmin(maxBlock, numSamples - offset));
+}
+
+void StripBank::processGroup(int g, const BufferLayout& buffers, int offset, int numSamples)
+{
+    auto& group = groups[(size_t)g];
+    const int first = g * lanesPerGroup;
+    const int count = juce::jmin(lanesPerGroup, numStrips - first);
+
+    const size_t stride = buffers.stride();
+
+    // Nothing to filter - gains only, in place
+    if (group.activeSlots == 0)
+    {
+        for (int j = 0; j < count; ++j)
+        {
+            auto& strip = strips[(size_t)(first + j)];
+            float* data = buffers.at(first + j, offset);
+            strip.inGain.apply(data, stride, data, stride, numSamples);
+            strip.outGain.apply(data, stride, data, stride, numSamples);
+        }
+        return;
+    }
+
+    // Spare lanes of the last group carry whatever the previous group left, through pass-through sections,
+    // and are never written back
+    float* block = interleaved.data();
+    for (int j = 0; j < count; ++j)
+        strips[(size_t)(first + j)].inGain.apply(buffers.at(first + j, offset), stride, block + j, lanesPerGroup, numSamples);
+
+    const auto& kernels = DspKernels::get();
+    for (auto slots = group.activeSlots; slots != 0; slots &= slots - 1)
+    {
+        const auto slot = (size_t)std::countr_zero(slots);
+        kernels.laneSection(group.sections[slot], group.states[slot], block, numSamples);
+    }
+
+    for (int j = 0; j < count; ++j)
+        strips[(size_t)(first + j)].outGain.apply(block + j, lanesPerGroup, buffers.at(first + j, offset), stride, numSamples);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <span>
+#include "DspArena.h"
+#include "DspKernels.h"
+#include "EqDesign.h"
+
+/**
+ * The EQ for many independent mono strips at once - a console running the same EQ on 64-128 channels, each with
+ * its own settings - without an AudioProcessor (and its per-instance block overhead) per strip.
+ * Strips are packed 16 to a group, one per lane of DspKernels::laneSection, so a group's sections run as vector
+ * steps with different coefficients in every lane. Each strip is input gain -> HPF -> peaks -> LPF -> output gain,
+ * from the same ChainSettings values and the same designs as the processor; the graphic bank and the limiter
+ * aren't part of the bank, and their fields are ignored.
+ * Every section runs as the TPT SVF (first-order ones through the same recurrence), so curves match the
+ * processor's exactly but samples only to within float rounding. A section slot is skipped for a whole group
+ * when no strip in it uses it, and a group with none only gets its gains.
+ * Not thread-safe: set settings and process from the same thread, between blocks.
+ */
+class StripBank
+{
+public:
+    using Settings = EqDesign::ChainSettings;
+
+    static constexpr int lanesPerGroup = DspKernels::LaneSectionCoefficients::numLanes;
+    static constexpr int maxCascadeStages = 4; // EqDesign::numStagesForSlopeIndex()'s largest
+
+    // Sizes everything for up to maxBlockSize samples (longer blocks are split) and resets all strips to flat.
+    // False if the memory can't be allocated - the bank then has no strips.
+    bool prepare(double sampleRate, int maxBlockSize, int numStrips);
+    void reset(); // Filter states only
+
+    // The first call for a strip after prepare() jumps to its gains; later ones ramp them over 20 ms like the processor.
+    // Only the sections whose values changed are redesigned. A section that's switched off keeps its state, and picks
+    // up from it when switched back on, as the processor's sections do.
+    void setSettings(int strip, const Settings& settings);
+    const Settings& getSettings(int strip) const { return strips[(size_t)strip].settings; }
+
+    // In place, straight from the caller's buffers: one planar mono buffer per strip, or one buffer with the strips
+    // interleaved (strip s at data[i * getNumStrips() + s])
+    void process(float* const* channels, int numSamples);
+    void processInterleaved(float* data, int numSamples);
+
+    int getNumStrips() const { return numStrips; }
+    size_t getDspStateBytes() const { return arena.getBytes(); }
+
+private:
+    // Fixed slots per strip, in processing order: HPF stages, peaks, LPF stages
+    static constexpr int firstPeakSlot = maxCascadeStages;
+    static constexpr int firstLpfSlot = firstPeakSlot + EqConstants::maxEqBands;
+    static constexpr int numSlots = firstLpfSlot + maxCascadeStages;
+    static_assert(numSlots <= 32, "Slots are a 32-bit mask");
+
+    // SmoothedValue's linear ramp, kept trivially destructible for the arena
+    struct GainRamp
+    {
+        float current = 1.0f, target = 1.0f, step = 0.0f;
+        int remaining = 0;
+
+        void setTarget(float newTarget, int rampSamples);
+        void jumpTo(float value);
+        void apply(const float* in, size_t inStride, float* out, size_t outStride, int numSamples);
+    };
+
+    struct Strip
+    {
+        Settings settings;
+        GainRamp inGain, outGain;
+        juce::uint32 activeSlots = 0;
+        bool configured = false;
+    };
+
+    struct Group
+    {
+        std::array<DspKernels::LaneSectionCoefficients, numSlots> sections;
+        std::array<DspKernels::LaneSectionState, numSlots> states;
+        juce::uint32 activeSlots = 0; // Any lane's
+    };
+
+    // Where each strip's samples are - planar channels, or every numChannels-th sample of one buffer
+    struct BufferLayout
+    {
+        float* const* channels = nullptr;
+        float* interleaved = nullptr;
+        int numChannels = 1;
+
+        float* at(int strip, int offset) const
+        {
+            return channels != nullptr ? channels[strip] + offset : interleaved + (size_t)offset * (size_t)numChannels + (size_t)strip;
+        }
+
+        size_t stride() const { return channels != nullptr ? 1 : (size_t)numChannels; }
+    };
+
+    void setSlot(int strip, int slot, const FilterSection::Design* design); // nullptr passes through
+    void updateGroupSlots(int group);
+    void processLayout(const BufferLayout& buffers, int numSamples);
+    void processGroup(int group, const BufferLayout& buffers, int offset, int numSamples);
+
+    double sampleRate = 44100.0;
+    int maxBlock = 1;
+    int numStrips = 0;
+    int rampSamples = 0;
+
+    DspArena arena;
+    std::span<Strip> strips;
+    std::span<Group> groups;
+    std::span<float> interleaved; // One group's block, [sample][lane]
+};
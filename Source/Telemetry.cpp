@@ -0,0 +1,238 @@
+#include "Telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #define JUCEEQ_POSIX_SHARED_MEMORY 1
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#else
+ #define JUCEEQ_POSIX_SHARED_MEMORY 0
+#endif
+
+namespace
+{
+    juce::int32 currentProcessId()
+    {
+       #if JUCEEQ_POSIX_SHARED_MEMORY
+        return (juce::int32)getpid();
+       #else
+        return 0;
+       #endif
+    }
+
+    bool hasExpectedLayout(const Telemetry::Segment& segment)
+    {
+        const auto& header = segment.header;
+        return header.magic.load(std::memory_order_acquire) == Telemetry::magic
+            && header.version == Telemetry::version
+            && header.numSlots == (juce::uint32)Telemetry::numSlots
+            && header.slotBytes == (juce::uint32)sizeof(Telemetry::Slot);
+    }
+
+   #if JUCEEQ_POSIX_SHARED_MEMORY
+    Telemetry::Segment* openSegment(const juce::String& name, bool writable)
+    {
+        const int fd = shm_open(name.toRawUTF8(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd < 0)
+            return nullptr;
+
+        // A new segment is zero-filled; every process sizes it the same, so racing to create it is harmless
+        struct stat info;
+        const bool sized = fstat(fd, &info) == 0
+            && ((size_t)info.st_size >= sizeof(Telemetry::Segment)
+                || (writable && ftruncate(fd, (off_t)sizeof(Telemetry::Segment)) == 0));
+
+        void* address = sized ? mmap(nullptr, sizeof(Telemetry::Segment), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                                     MAP_SHARED, fd, 0)
+                              : MAP_FAILED;
+        close(fd);
+
+        if (address == MAP_FAILED)
+            return nullptr;
+
+        auto* segment = static_cast<Telemetry::Segment*>(address);
+        auto& header = segment->header;
+
+        // The first writer fills in the header; the others write the same values, so they can't disagree
+        if (writable && header.magic.load(std::memory_order_acquire) == 0)
+        {
+            header.version = Telemetry::version;
+            header.numSlots = (juce::uint32)Telemetry::numSlots;
+            header.slotBytes = (juce::uint32)sizeof(Telemetry::Slot);
+            header.ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+
+            juce::uint32 expected = 0;
+            header.magic.compare_exchange_strong(expected, Telemetry::magic, std::memory_order_release);
+        }
+
+        if (!hasExpectedLayout(*segment))
+        {
+            munmap(address, sizeof(Telemetry::Segment));
+            return nullptr;
+        }
+
+        return segment;
+    }
+   #endif
+}
+
+Telemetry::Segment* Telemetry::mapSegment(const juce::String& name, bool writable)
+{
+   #if JUCEEQ_POSIX_SHARED_MEMORY
+    static juce::CriticalSection lock;
+    static std::map<std::pair<juce::String, bool>, Segment*> mapped;
+
+    const juce::ScopedLock sl(lock);
+    auto& segment = mapped[{ name, writable }];
+    if (segment == nullptr)
+        segment = openSegment(name, writable);
+
+    return segment;
+   #else
+    juce::ignoreUnused(name, writable);
+    return nullptr;
+   #endif
+}
+
+bool Telemetry::isProcessAlive(juce::int32 pid)
+{
+   #if JUCEEQ_POSIX_SHARED_MEMORY
+    return pid > 0 && (kill((pid_t)pid, 0) == 0 || errno == EPERM);
+   #else
+    return pid > 0;
+   #endif
+}
+
+//==============================================================================
+std::unique_ptr<TelemetryPublisher> TelemetryPublisher::createFromEnvironment(const char* kernelName)
+{
+    const auto setting = juce::SystemStats::getEnvironmentVariable("JUCEEQ_TELEMETRY", {}).trim();
+    if (setting.isEmpty() || setting == "off")
+        return nullptr;
+
+    const auto name = setting == "on" ? juce::String(Telemetry::defaultSegmentName)
+                                      : (setting.startsWithChar('/') ? setting : "/" + setting);
+
+    auto* segment = Telemetry::mapSegment(name, true);
+    if (segment == nullptr)
+        return nullptr;
+
+    // A free slot, or one whose process has gone without freeing it (crashed or killed)
+    const auto pid = currentProcessId();
+    for (auto& slot : segment->slots)
+    {
+        auto owner = slot.owner.load(std::memory_order_relaxed);
+        const bool claimable = owner == 0 || (owner != pid && !Telemetry::isProcessAlive(owner));
+
+        if (claimable && slot.owner.compare_exchange_strong(owner, pid, std::memory_order_acq_rel))
+            return std::make_unique<TelemetryPublisher>(slot, kernelName);
+    }
+
+    return nullptr;
+}
+
+TelemetryPublisher::TelemetryPublisher(Telemetry::Slot& s, const char* kernelName)
+    : slot(s)
+{
+    static std::atomic<juce::uint32> instances{ 0 };
+
+    // A process that died mid-write leaves a sequence odd, which would keep readers out for good
+    for (auto* sequence : { &slot.identitySequence, &slot.blockSequence })
+        if ((sequence->load(std::memory_order_relaxed) & 1) != 0)
+            sequence->fetch_add(1, std::memory_order_relaxed);
+
+    microsecondsPerTick = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+
+    identity.pid = currentProcessId();
+    identity.instance = ++instances;
+    juce::String(kernelName).copyToUTF8(identity.kernel, sizeof(identity.kernel));
+
+    // Nothing from the slot's last owner shows through; touching the slot here also means the audio thread's
+    // first write doesn't page-fault
+    const Telemetry::Block empty{};
+    Telemetry::write(slot.blockSequence, slot.block, empty);
+
+    const juce::SpinLock::ScopedLockType sl(identityLock);
+    publishIdentity();
+}
+
+TelemetryPublisher::~TelemetryPublisher()
+{
+    slot.owner.store(0, std::memory_order_release);
+}
+
+void TelemetryPublisher::setPrepared(double newSampleRate, int blockSize, int numChannels)
+{
+    sampleRate = newSampleRate;
+    blocks = samples = 0;
+    minBlockSize = maxBlockSize = 0;
+    load = 0.0f;
+
+    const juce::SpinLock::ScopedLockType sl(identityLock);
+    identity.sampleRate = newSampleRate;
+    identity.preparedBlockSize = blockSize;
+    identity.numChannels = numChannels;
+    publishIdentity();
+}
+
+void TelemetryPublisher::setNames(const juce::String& host, const juce::String& track)
+{
+    const juce::SpinLock::ScopedLockType sl(identityLock);
+    host.copyToUTF8(identity.host, sizeof(identity.host));
+    track.copyToUTF8(identity.track, sizeof(identity.track));
+    publishIdentity();
+}
+
+void TelemetryPublisher::publishIdentity()
+{
+    Telemetry::write(slot.identitySequence, slot.identity, identity);
+}
+
+void TelemetryPublisher::beginBlock() noexcept
+{
+    std::fill(std::begin(stageTicks), std::end(stageTicks), (juce::int64)0);
+    blockStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+void TelemetryPublisher::addStageTime(Telemetry::Stage stage, juce::int64 startTicks) noexcept
+{
+    stageTicks[stage] += juce::Time::getHighResolutionTicks() - startTicks;
+}
+
+void TelemetryPublisher::endBlock(Telemetry::Block& block, int numSamples) noexcept
+{
+    const auto now = juce::Time::getHighResolutionTicks();
+    const double blockMicroseconds = (double)(now - blockStartTicks) * microsecondsPerTick;
+
+    if (numSamples > 0)
+    {
+        // Same smoothing as the governor's, so the two agree when it's on
+        const double blockSeconds = numSamples / sampleRate;
+        load += (float)((1.0 - std::exp(-blockSeconds / loadSmoothingSeconds)) * (blockMicroseconds * 1.0e-6 / blockSeconds - load));
+
+        minBlockSize = blocks == 0 ? numSamples : juce::jmin(minBlockSize, numSamples);
+        maxBlockSize = juce::jmax(maxBlockSize, numSamples);
+        ++blocks;
+        samples += (juce::uint64)numSamples;
+    }
+
+    block.ticks = now;
+    block.blocks = blocks;
+    block.samples = samples;
+    block.blockSize = numSamples;
+    block.minBlockSize = minBlockSize;
+    block.maxBlockSize = maxBlockSize;
+    block.blockMicroseconds = (float)blockMicroseconds;
+    block.load = load;
+
+    for (int stage = 0; stage < Telemetry::numStages; ++stage)
+        block.stageMicroseconds[stage] = (float)((double)stageTicks[stage] * microsecondsPerTick);
+
+    Telemetry::write(slot.blockSequence, slot.block, block);
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+/**
+ * Fixed layout of the JUCEEQ_TELEMETRY shared-memory segment, shared by the plugin (TelemetryPublisher) and
+ * readers (JuceEQTelemetry, or a dashboard's own reader - only this header is needed).
+ *
+ * The segment is a Header and numSlots Slots. Each instance owns one slot while it exists: `owner` holds its
+ * process ID (0 when free). A slot has two seqlocked records - Identity, written on prepare and when the host
+ * renames the track, and Block, written by the audio thread at the end of every block. A record's sequence is odd
+ * while it's being written; a reader copies the record and keeps the copy if the sequence was even and unchanged
+ * across it. Timestamps are juce::Time::getHighResolutionTicks(), a system-wide monotonic clock, so a reader can
+ * tell how long ago an instance last ran. Everything is native-endian and only read on the same machine.
+ */
+namespace Telemetry
+{
+    static constexpr juce::uint32 magic = 0x5451454a; // "JEQT"
+    static constexpr juce::uint32 version = 1;
+    static constexpr int numSlots = 256;
+    static constexpr const char* defaultSegmentName = "/juceeq-telemetry";
+
+    // Timed parts of processBlock; the rest of the block (gains, crossfades, snapshots) is blockMicroseconds minus these
+    enum Stage
+    {
+        filtersStage = 0,
+        multirateStage, // Halfband split and recombination
+        limiterStage,
+        numStages
+    };
+
+    enum StateFlags : juce::uint32
+    {
+        bypassedFlag = 1 << 0,
+        sleepingFlag = 1 << 1,
+        filtersEngagedFlag = 1 << 2, // Clear while the flat-curve fast path skips the filters
+        limiterFlag = 1 << 3,
+        multirateFlag = 1 << 4,
+        fixedPointFlag = 1 << 5,
+        graphicFlag = 1 << 6,
+        blockFiltersFlag = 1 << 7
+    };
+
+    struct Identity
+    {
+        juce::int32 pid;
+        juce::uint32 instance; // Per process, in creation order
+        double sampleRate;
+        juce::int32 preparedBlockSize, numChannels;
+        char host[32], track[64], kernel[16]; // Null-terminated UTF-8, truncated to fit
+    };
+
+    struct Block
+    {
+        juce::int64 ticks; // When the block finished
+        juce::uint64 blocks, samples; // Since prepare
+        juce::int32 blockSize, minBlockSize, maxBlockSize; // Last block; smallest and largest since prepare
+        juce::int32 latencySamples;
+        float inputPeak[2], outputPeak[2]; // Linear, last block, first two channels
+        float gainReductionDb;
+        float blockMicroseconds; // Whole processBlock
+        float stageMicroseconds[numStages];
+        float load; // blockMicroseconds against the block's duration, smoothed over about 100 ms
+        juce::int32 tier; // CpuGovernor::Tier
+        juce::uint32 state; // StateFlags
+        juce::uint32 parameterVersion; // Moves every time the filters are redesigned
+    };
+
+    struct alignas(64) Slot
+    {
+        std::atomic<juce::int32> owner;
+        std::atomic<juce::uint32> identitySequence;
+        Identity identity;
+        alignas(64) std::atomic<juce::uint32> blockSequence; // Own cache line - written every block
+        Block block;
+    };
+
+    struct Header
+    {
+        std::atomic<juce::uint32> magic; // Set last, once the rest is filled in
+        juce::uint32 version, numSlots, slotBytes;
+        juce::int64 ticksPerSecond;
+    };
+
+    struct Segment
+    {
+        Header header;
+        Slot slots[numSlots];
+    };
+
+    static_assert(std::atomic<juce::uint32>::is_always_lock_free && std::atomic<juce::int32>::is_always_lock_free,
+                  "Seqlocks in shared memory need lock-free atomics");
+    static_assert(std::is_trivially_copyable_v<Identity> && std::is_trivially_copyable_v<Block>);
+
+    // Single writer per record
+    template <typename Record>
+    void write(std::atomic<juce::uint32>& sequence, Record& shared, const Record& value) noexcept
+    {
+        const auto s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&shared, &value, sizeof(Record));
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // False if every attempt overlapped a write - try again later
+    template <typename Record>
+    bool read(const std::atomic<juce::uint32>& sequence, const Record& shared, Record& value) noexcept
+    {
+        for (int attempt = 0; attempt < 64; ++attempt)
+        {
+            const auto before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0)
+                continue;
+
+            std::memcpy(&value, &shared, sizeof(Record));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Maps the named segment (POSIX shm_open name, e.g. "/juceeq-telemetry") - nullptr if it doesn't exist, has
+    // another layout, or the platform has no POSIX shared memory. Writable mappings create it if needed. Mappings
+    // stay for the life of the process.
+    Segment* mapSegment(const juce::String& name, bool writable);
+
+    bool isProcessAlive(juce::int32 pid);
+}
+
+/**
+ * Opt-in telemetry for external monitoring dashboards: each instance publishes its meters, per-stage CPU time,
+ * block sizes, quality tier, state and parameter version into its own slot of the shared-memory segment described
+ * above, where any process on the machine can read them without talking to the host.
+ * The slot is claimed on construction and freed on destruction; slots left by crashed processes are reused. The audio
+ * thread only reads the clock and copies a record into memory that's already mapped - no syscalls, locks or
+ * allocation per block.
+ *
+ * Set JUCEEQ_TELEMETRY=on (or a segment name, e.g. /my-session) before starting the host, and run JuceEQTelemetry
+ * to list the instances.
+ */
+class TelemetryPublisher
+{
+public:
+    // Claims a slot in the JUCEEQ_TELEMETRY segment - nullptr if it isn't set, the segment can't be mapped or every
+    // slot is taken
+    static std::unique_ptr<TelemetryPublisher> createFromEnvironment(const char* kernelName);
+
+    TelemetryPublisher(Telemetry::Slot& slot, const char* kernelName);
+    ~TelemetryPublisher(); // Frees the slot
+
+    // prepareToPlay and the host's track properties - any thread but the audio thread
+    void setPrepared(double sampleRate, int blockSize, int numChannels);
+    void setNames(const juce::String& host, const juce::String& track);
+
+    // Audio thread, around the processing: begin starts the clock, end fills in the timing and block counters and
+    // publishes the rest of `block` as the processor filled it in
+    void beginBlock() noexcept;
+    void endBlock(Telemetry::Block& block, int numSamples) noexcept;
+
+    // Adds the time since startTicks to a stage of the current block (a stage can run more than once per block)
+    void addStageTime(Telemetry::Stage stage, juce::int64 startTicks) noexcept;
+
+    class StageScope
+    {
+    public:
+        StageScope(TelemetryPublisher* p, Telemetry::Stage s) noexcept
+            : publisher(p), stage(s), start(p != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~StageScope()
+        {
+            if (publisher != nullptr)
+                publisher->addStageTime(stage, start);
+        }
+
+    private:
+        TelemetryPublisher* publisher;
+        Telemetry::Stage stage;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(StageScope)
+    };
+
+private:
+    void publishIdentity(); // Under identityLock
+
+    static constexpr double loadSmoothingSeconds = 0.1;
+
+    Telemetry::Slot& slot;
+    double microsecondsPerTick = 1.0;
+
+    juce::SpinLock identityLock;
+    Telemetry::Identity identity{};
+
+    // Audio thread, and reset by setPrepared (never concurrent with it)
+    double sampleRate = 44100.0;
+    juce::int64 blockStartTicks = 0;
+    juce::int64 stageTicks[Telemetry::numStages]{};
+    juce::uint64 blocks = 0, samples = 0;
+    int minBlockSize = 0, maxBlockSize = 0;
+    float load = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE(TelemetryPublisher)
+};
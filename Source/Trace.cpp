@@ -0,0 +1,259 @@
+#include "Trace.h"
+
+namespace
+{
+    juce::String escaped(const char* text)
+    {
+        return juce::String(text).replace("\\", "\\\\").replace("\"", "\\\"");
+    }
+}
+
+EqTrace& EqTrace::getInstance()
+{
+    static EqTrace instance;
+    return instance;
+}
+
+EqTrace::~EqTrace()
+{
+    stop();
+}
+
+void EqTrace::start(const juce::File& outputFile)
+{
+    const juce::ScopedLock sl(controlLock);
+    stop();
+
+    outputFile.deleteFile();
+    stream = std::make_unique<juce::FileOutputStream>(outputFile);
+    if (!stream->openedOk())
+    {
+        stream.reset();
+        return;
+    }
+
+    // Only the reader's side of each ring is touched here - a record() can still be running from before the last
+    // stop(). The write index and the claim belong to the recording thread; what's left unread is skipped.
+    for (auto& ring : rings)
+    {
+        if (ring == nullptr)
+            ring = std::make_unique<ThreadRing>();
+
+        ring->readIndex.store(ring->writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+        ring->dropped.store(0);
+        ring->writtenName = nullptr;
+        ring->anyNameWritten = false;
+    }
+
+    // Chrome's JSON array format - the closing bracket is optional, so a trace cut short still loads
+    stream->writeText("[\n", false, false, nullptr);
+    firstEvent = true;
+    originTicks = juce::Time::getHighResolutionTicks();
+
+    session.fetch_add(1, std::memory_order_acq_rel);
+    active.store(true, std::memory_order_release);
+
+    writer = std::make_unique<Writer>(*this);
+    writer->startThread(juce::Thread::Priority::low);
+}
+
+void EqTrace::stop()
+{
+    const juce::ScopedLock sl(controlLock);
+
+    if (stream == nullptr)
+        return;
+
+    active.store(false, std::memory_order_release);
+
+    if (writer != nullptr)
+    {
+        writer->stopThread(2000);
+        writer.reset();
+    }
+
+    drain();
+
+    // Overflowed rings show up as instant events at the end of the timeline
+    const double endUs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - originTicks) * 1.0e6;
+    for (int i = 0; i < maxThreads; ++i)
+    {
+        const auto dropped = rings[(size_t)i]->dropped.load();
+        if (dropped > 0)
+            stream->writeText(",\n{\"name\":\"trace overflow\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":" + juce::String(i + 1)
+                + ",\"ts\":" + juce::String(endUs, 3) + ",\"args\":{\"dropped\":" + juce::String(dropped) + "}}", false, false, nullptr);
+    }
+
+    stream->writeText("\n]\n", false, false, nullptr);
+    stream->flush();
+    stream.reset();
+}
+
+void EqTrace::acquireFromEnvironment()
+{
+    const juce::ScopedLock sl(controlLock);
+
+    if (++environmentUsers != 1 || isActive())
+        return;
+
+    const auto path = juce::SystemStats::getEnvironmentVariable("JUCEEQ_TRACE", {});
+    if (path.isEmpty())
+        return;
+
+    start(juce::File::getCurrentWorkingDirectory().getChildFile(path));
+    startedFromEnvironment = isActive();
+}
+
+void EqTrace::releaseFromEnvironment()
+{
+    const juce::ScopedLock sl(controlLock);
+
+    if (--environmentUsers == 0 && startedFromEnvironment)
+    {
+        stop();
+        startedFromEnvironment = false;
+    }
+}
+
+// First event on a thread (per session) claims a ring - lock-free, no allocation. A thread takes its ring from the
+// last session back; other threads only take rings nobody claimed for a whole session, so a record() still finishing
+// from before a start() never shares its ring with a new owner.
+EqTrace::ThreadRing* EqTrace::ringForCurrentThread() noexcept
+{
+    thread_local ThreadRing* cachedRing = nullptr;
+    thread_local juce::uint32 cachedSession = 0;
+
+    const auto currentSession = session.load(std::memory_order_acquire);
+    if (cachedRing != nullptr && cachedSession == currentSession)
+        return cachedRing;
+
+    if (cachedRing != nullptr)
+    {
+        auto expected = cachedSession;
+        if (cachedRing->claimedSession.compare_exchange_strong(expected, currentSession, std::memory_order_acq_rel))
+        {
+            cachedSession = currentSession;
+            return cachedRing;
+        }
+    }
+
+    cachedRing = nullptr;
+    cachedSession = currentSession;
+
+    for (auto& ring : rings)
+    {
+        if (ring == nullptr)
+            continue;
+
+        auto claimed = ring->claimedSession.load(std::memory_order_acquire);
+        const bool idle = claimed == 0 || claimed + 1 < currentSession;
+        if (!idle || !ring->claimedSession.compare_exchange_strong(claimed, currentSession, std::memory_order_acq_rel))
+            continue;
+
+        ring->name.store(nullptr, std::memory_order_release);
+
+        if (auto* thread = juce::Thread::getCurrentThread())
+        {
+            thread->getThreadName().copyToUTF8(ring->juceThreadName, sizeof(ring->juceThreadName));
+            ring->name.store(ring->juceThreadName, std::memory_order_release);
+        }
+
+        cachedRing = ring.get();
+        break;
+    }
+
+    return cachedRing; // nullptr once every ring is taken - that thread just isn't traced
+}
+
+void EqTrace::record(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    if (!active.load(std::memory_order_acquire))
+        return;
+
+    auto* ring = ringForCurrentThread();
+    if (ring == nullptr)
+        return;
+
+    const auto w = ring->writeIndex.load(std::memory_order_relaxed);
+    if (w - ring->readIndex.load(std::memory_order_acquire) >= ThreadRing::capacity)
+    {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring->events[w & (ThreadRing::capacity - 1)] = { name, startTicks, endTicks };
+    ring->writeIndex.store(w + 1, std::memory_order_release);
+}
+
+void EqTrace::nameCurrentThread(const char* name) noexcept
+{
+    if (auto* ring = ringForCurrentThread())
+        if (ring->name.load(std::memory_order_relaxed) != name)
+            ring->name.store(name, std::memory_order_release);
+}
+
+// Writer thread (or stop(), after the writer has gone) - everything recorded so far goes to the file
+void EqTrace::drain()
+{
+    if (stream == nullptr)
+        return;
+
+    juce::MemoryOutputStream out;
+    auto separator = [this, &out]
+        {
+            out << (firstEvent ? "" : ",\n");
+            firstEvent = false;
+        };
+
+    for (int i = 0; i < maxThreads; ++i)
+    {
+        auto& ring = *rings[(size_t)i];
+        if (ring.claimedSession.load(std::memory_order_acquire) != session.load(std::memory_order_relaxed))
+            continue;
+
+        const int tid = i + 1;
+        const char* name = ring.name.load(std::memory_order_acquire);
+        if (!ring.anyNameWritten || name != ring.writtenName)
+        {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\""
+                << (name != nullptr ? escaped(name) : "Thread " + juce::String(tid)) << "\"}}";
+            ring.writtenName = name;
+            ring.anyNameWritten = true;
+        }
+
+        const auto w = ring.writeIndex.load(std::memory_order_acquire);
+        auto r = ring.readIndex.load(std::memory_order_relaxed);
+
+        for (; r != w; ++r)
+        {
+            const auto& e = ring.events[r & (ThreadRing::capacity - 1)];
+            if (e.start < originTicks)
+                continue; // From a record() that was still finishing when this session started
+
+            const double ts = juce::Time::highResolutionTicksToSeconds(e.start - originTicks) * 1.0e6;
+            const double dur = juce::Time::highResolutionTicksToSeconds(e.end - e.start) * 1.0e6;
+
+            separator();
+            out << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << juce::String(ts, 3) << ",\"dur\":" << juce::String(dur, 3) << "}";
+        }
+
+        ring.readIndex.store(w, std::memory_order_release);
+    }
+
+    if (out.getDataSize() > 0)
+    {
+        stream->write(out.getData(), out.getDataSize());
+        stream->flush();
+    }
+}
+
+void EqTrace::Writer::run()
+{
+    while (!threadShouldExit())
+    {
+        trace.drain();
+        wait(50);
+    }
+}
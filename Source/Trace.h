@@ -0,0 +1,120 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+#ifndef JUCEEQ_TRACING
+ #define JUCEEQ_TRACING 1
+#endif
+
+/**
+ * Opt-in timeline of the audio and UI threads, written as a Chrome JSON trace (chrome://tracing or ui.perfetto.dev).
+ * Each thread records into its own fixed-size ring - an event is two tick reads and a store, no locks or allocation.
+ * A background thread drains the rings and streams the events to disk while tracing runs, so a trace survives
+ * the host being killed. When tracing is off, a scope costs one relaxed atomic load.
+ *
+ * On a customer's machine: set JUCEEQ_TRACE=/path/to/trace.json before starting the host. The trace runs while
+ * any plugin instance exists. Build with JUCEEQ_TRACING=0 to compile the scopes out entirely.
+ */
+class EqTrace
+{
+public:
+    static EqTrace& getInstance();
+
+    void start(const juce::File& outputFile);
+    void stop(); // Drains what's left and closes the file
+    bool isActive() const noexcept { return active.load(std::memory_order_relaxed); }
+
+    // Processor instances call these - the first starts a JUCEEQ_TRACE session, the last one out stops it
+    void acquireFromEnvironment();
+    void releaseFromEnvironment();
+
+    // Names must outlive the trace (string literals) - only the pointer is stored
+    void record(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+    void nameCurrentThread(const char* name) noexcept;
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* eventName) noexcept
+            : name(eventName), start(EqTrace::getInstance().isActive() ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~Scope()
+        {
+            if (start != 0)
+                EqTrace::getInstance().record(name, start, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char* name;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    ~EqTrace();
+
+private:
+    EqTrace() = default;
+
+    struct Event
+    {
+        const char* name;
+        juce::int64 start, end;
+    };
+
+    // Single producer (the owning thread), single consumer (the writer). The indices only ever count up - start()
+    // moves the read index past what's left rather than resetting either.
+    struct ThreadRing
+    {
+        static constexpr juce::uint32 capacity = 8192; // Power of two
+        std::array<Event, capacity> events{};
+        std::atomic<juce::uint32> writeIndex{ 0 }, readIndex{ 0 };
+        std::atomic<juce::uint32> claimedSession{ 0 }; // Session the owning thread last claimed it in, 0 for never
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<juce::uint32> dropped{ 0 };
+        char juceThreadName[64]{}; // Copied at claim time for juce::Threads
+        const char* writtenName = nullptr; // Writer only - last name sent as metadata
+        bool anyNameWritten = false;
+    };
+
+    class Writer : public juce::Thread
+    {
+    public:
+        explicit Writer(EqTrace& t) : juce::Thread("JuceEQ trace writer"), trace(t) {}
+        void run() override;
+
+    private:
+        EqTrace& trace;
+    };
+
+    ThreadRing* ringForCurrentThread() noexcept;
+    void drain();
+
+    static constexpr int maxThreads = 32;
+    std::array<std::unique_ptr<ThreadRing>, maxThreads> rings; // Allocated on the first start(), kept after
+    std::atomic<bool> active{ false };
+    std::atomic<juce::uint32> session{ 0 };
+
+    juce::CriticalSection controlLock; // start/stop/acquire/release only - never taken by record()
+    std::unique_ptr<Writer> writer;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    juce::int64 originTicks = 0;
+    bool firstEvent = true;
+    int environmentUsers = 0;
+    bool startedFromEnvironment = false;
+
+    JUCE_DECLARE_NON_COPYABLE(EqTrace)
+};
+
+#if JUCEEQ_TRACING
+ #define EQ_TRACE_SCOPE(name) EqTrace::Scope JUCE_JOIN_MACRO(eqTraceScope_, __LINE__)(name)
+ #define EQ_TRACE_THREAD_NAME(name) if (EqTrace::getInstance().isActive()) EqTrace::getInstance().nameCurrentThread(name)
+#else
+ #define EQ_TRACE_SCOPE(name)
+ #define EQ_TRACE_THREAD_NAME(name)
+#endif
@@ -0,0 +1,87 @@
+#include "../Source/PluginProcessor.h"
+#include "../Source/AutoFit.h"
+#include <iostream>
+
+// JuceEQFit - fits the EQ to a target curve or reference file without opening the plugin
+//
+//  JuceEQFit <target.csv|reference.wav> [--bands=N] [--rate=Hz] [--hpf-slope=0..3] [--lpf-slope=0..3]
+//            [--no-hpf] [--no-lpf] [--starts=N] [--out=preset.xml]
+//
+// --out writes the plugin state (same XML as the processor's APVTS state) so it can be loaded as a preset.
+
+static void printUsage()
+{
+    std::cout << "Usage: JuceEQFit <target.csv|reference.wav> [--bands=N] [--rate=Hz] [--hpf-slope=0..3]\n"
+                 "                 [--lpf-slope=0..3] [--no-hpf] [--no-lpf] [--starts=N] [--out=preset.xml]\n";
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit; // APVTS needs a message manager
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() == 0 || args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    const auto targetFile = args[0].resolveAsFile();
+    const auto target = EqAutoFit::loadTarget(targetFile);
+    if (!target.isValid())
+    {
+        std::cerr << "Couldn't read a target curve from " << targetFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    EqAutoFit::Options options;
+    auto intOption = [&args](const juce::String& name, int fallback)
+        {
+            return args.containsOption(name) ? args.getValueForOption(name).getIntValue() : fallback;
+        };
+
+    options.numBands = intOption("--bands", options.numBands);
+    options.numStarts = intOption("--starts", options.numStarts);
+    options.hpfSlopeIndex = juce::jlimit(0, 3, intOption("--hpf-slope", options.hpfSlopeIndex));
+    options.lpfSlopeIndex = juce::jlimit(0, 3, intOption("--lpf-slope", options.lpfSlopeIndex));
+    options.fitHpf = !args.containsOption("--no-hpf");
+    options.fitLpf = !args.containsOption("--no-lpf");
+    if (args.containsOption("--rate"))
+        options.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+
+    const auto result = EqAutoFit::fit(target, options);
+
+    std::cout << "Fit: " << juce::String(result.rmsErrorDb, 2) << " dB RMS error, "
+              << result.iterations << " iterations, " << juce::String(result.elapsedMs, 1) << " ms\n";
+
+    if (result.hpfEnabled)
+        std::cout << "  HPF  " << juce::String(result.hpfFreqHz, 1) << " Hz\n";
+    if (result.lpfEnabled)
+        std::cout << "  LPF  " << juce::String(result.lpfFreqHz, 1) << " Hz\n";
+
+    for (int b = 0; b < EqConstants::maxEqBands; ++b)
+    {
+        const auto& band = result.bands[(size_t)b];
+        if (band.enabled)
+            std::cout << "  B" << (b + 1) << "   " << juce::String(band.freqHz, 1) << " Hz  "
+                      << juce::String(band.gainDb, 2) << " dB  Q " << juce::String(band.q, 2) << "\n";
+    }
+
+    if (args.containsOption("--out"))
+    {
+        JuceEQAudioProcessor processor;
+        EqAutoFit::applyToParameters(result, processor.apvts);
+
+        const auto outFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--out"));
+
+        if (auto xml = processor.apvts.copyState().createXml(); xml != nullptr && xml->writeTo(outFile))
+            std::cout << "Wrote " << outFile.getFullPathName() << "\n";
+        else
+        {
+            std::cerr << "Couldn't write preset\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
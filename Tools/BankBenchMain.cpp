@@ -0,0 +1,213 @@
+#include "../Source/PluginProcessor.h"
+#include "../Source/StripBank.h"
+#include <iostream>
+
+// JuceEQBankBench - a console's worth of mono strips: one StripBank against one processor per strip
+//
+//  JuceEQBankBench [--strips=N] [--rate=Hz] [--block=N] [--seconds=S] [--seed=N] [--isa=generic|avx2|avx512]
+//
+// Gives N strips (64 by default) random curves and gains, the same values to both, then runs the same noise through
+// N mono JuceEQAudioProcessor instances round-robin and through one StripBank. Reports time per block, real-time
+// strips per core and the speed-up. The last block's outputs are compared too. The bank runs every section as an
+// SVF and the processor mostly as direct form, so they agree to within float rounding, not bit for bit. Exits with
+// 1 if any strip is off by more than -60 dB.
+
+namespace
+{
+    constexpr double maxErrorDb = -60.0;
+
+    void setParam(juce::AudioProcessorValueTreeState& apvts, const juce::String& id, float value)
+    {
+        if (auto* p = apvts.getParameter(id))
+            p->setValueNotifyingHost(p->convertTo0to1(value));
+    }
+
+    float raw(juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
+    {
+        return apvts.getRawParameterValue(id)->load();
+    }
+
+    // A channel-strip curve - input trim, a cut at each end for some strips, a few bands - set on the processor and
+    // read back as the values its DSP uses, so the bank gets exactly the same numbers
+    JuceEQAudioProcessor::ChainSnapshot randomise(juce::AudioProcessorValueTreeState& apvts, juce::Random& rng)
+    {
+        setParam(apvts, "inGain", -6.0f + 12.0f * rng.nextFloat());
+        setParam(apvts, "outGain", -6.0f + 12.0f * rng.nextFloat());
+        setParam(apvts, "hpfEnabled", rng.nextInt(4) != 0 ? 1.0f : 0.0f);
+        setParam(apvts, "hpfFreq", 20.0f + 100.0f * rng.nextFloat());
+        setParam(apvts, "hpfSlope", (float)rng.nextInt(4));
+        setParam(apvts, "lpfEnabled", rng.nextBool() ? 1.0f : 0.0f);
+        setParam(apvts, "lpfFreq", 8000.0f + 10000.0f * rng.nextFloat());
+        setParam(apvts, "lpfSlope", (float)rng.nextInt(4));
+        setParam(apvts, "limiterEnabled", 0.0f);
+
+        const int numBands = 2 + rng.nextInt(5);
+        for (int i = 1; i <= EqConstants::maxEqBands; ++i)
+        {
+            setParam(apvts, eqBandParamType(i, "enabled"), i <= numBands ? 1.0f : 0.0f);
+            setParam(apvts, eqBandParamType(i, "freq"), 60.0f * std::pow(200.0f, rng.nextFloat()));
+            setParam(apvts, eqBandParamType(i, "gain"), -12.0f + 24.0f * rng.nextFloat());
+            setParam(apvts, eqBandParamType(i, "q"), 0.5f + 4.0f * rng.nextFloat());
+        }
+
+        JuceEQAudioProcessor::ChainSnapshot snap;
+        snap.inGainDb = raw(apvts, "inGain");
+        snap.outGainDb = raw(apvts, "outGain");
+        snap.hpfEnabled = raw(apvts, "hpfEnabled") > 0.5f;
+        snap.hpfFreqHz = raw(apvts, "hpfFreq");
+        snap.hpfIndex = (int)raw(apvts, "hpfSlope");
+        snap.hpfStages = JuceEQAudioProcessor::numStagesForSlopeIndex(snap.hpfIndex);
+        snap.lpfEnabled = raw(apvts, "lpfEnabled") > 0.5f;
+        snap.lpfFreqHz = raw(apvts, "lpfFreq");
+        snap.lpfIndex = (int)raw(apvts, "lpfSlope");
+        snap.lpfStages = JuceEQAudioProcessor::numStagesForSlopeIndex(snap.lpfIndex);
+
+        for (int i = 0; i < EqConstants::maxEqBands; ++i)
+        {
+            auto& band = snap.bands[(size_t)i];
+            band.enabled = raw(apvts, eqBandParamType(i + 1, "enabled")) > 0.5f;
+            band.freqHz = raw(apvts, eqBandParamType(i + 1, "freq"));
+            band.gainDb = raw(apvts, eqBandParamType(i + 1, "gain"));
+            band.q = raw(apvts, eqBandParamType(i + 1, "q"));
+        }
+
+        return snap;
+    }
+
+    // Error energy against the processor's output, relative to it
+    double errorDb(const float* test, const float* ref, int numSamples)
+    {
+        double signal = 0.0, noise = 0.0;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            signal += (double)ref[i] * ref[i];
+            const double e = (double)test[i] - ref[i];
+            noise += e * e;
+        }
+
+        if (noise <= 0.0) return -200.0;
+        return 10.0 * std::log10(noise / juce::jmax(signal, 1.0e-30));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit; // APVTS needs a message manager
+    juce::ArgumentList args(argc, argv);
+
+    auto option = [&args](const juce::String& name, double fallback)
+        {
+            return args.containsOption(name) ? args.getValueForOption(name).getDoubleValue() : fallback;
+        };
+
+    const int numStrips = juce::jmax(1, (int)option("--strips", 64));
+    const double sampleRate = option("--rate", 48000.0);
+    const int blockSize = juce::jmax(1, (int)option("--block", 128));
+    const double seconds = option("--seconds", 5.0);
+    juce::Random rng((juce::int64)option("--seed", 1));
+
+    if (args.containsOption("--isa") && !DspKernels::select(args.getValueForOption("--isa").toRawUTF8()))
+    {
+        std::cout << "--isa=" << args.getValueForOption("--isa") << " isn't available on this machine\n";
+        return 1;
+    }
+
+    std::cout << "JuceEQBankBench: " << numStrips << " mono strips, " << sampleRate << " Hz, " << blockSize
+              << "-sample blocks, " << DspKernels::get().name << " kernels\n";
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::mono());
+    layout.outputBuses.add(juce::AudioChannelSet::mono());
+
+    std::vector<std::unique_ptr<JuceEQAudioProcessor>> processors;
+    StripBank bank;
+    if (!bank.prepare(sampleRate, blockSize, numStrips))
+    {
+        std::cout << "Couldn't allocate " << numStrips << " strips\n";
+        return 1;
+    }
+
+    for (int s = 0; s < numStrips; ++s)
+    {
+        auto proc = std::make_unique<JuceEQAudioProcessor>();
+        proc->setBusesLayout(layout);
+        proc->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        bank.setSettings(s, randomise(proc->apvts, rng));
+        proc->prepareToPlay(sampleRate, blockSize);
+        processors.push_back(std::move(proc));
+    }
+
+    // Each strip gets its own stretch of the noise, and the same stretch in both runs
+    const int noiseLength = blockSize * 64;
+    juce::AudioBuffer<float> noise(1, noiseLength + numStrips * 97);
+    for (int i = 0; i < noise.getNumSamples(); ++i)
+        noise.setSample(0, i, 0.5f * (rng.nextFloat() * 2.0f - 1.0f));
+
+    auto input = [&](int strip, int block) { return noise.getReadPointer(0, strip * 97 + (block * blockSize) % noiseLength); };
+
+    const int numBlocks = juce::jmax(1, (int)(seconds * sampleRate / blockSize));
+    juce::AudioBuffer<float> processorOut(numStrips, blockSize), bankOut(numStrips, blockSize);
+    juce::MidiBuffer midi;
+
+    // One single-channel view per strip, made up front so the timed loop only processes
+    std::vector<std::unique_ptr<juce::AudioBuffer<float>>> views;
+    for (int s = 0; s < numStrips; ++s)
+        views.push_back(std::make_unique<juce::AudioBuffer<float>>(processorOut.getArrayOfWritePointers() + s, 1, blockSize));
+
+    auto t0 = juce::Time::getMillisecondCounterHiRes();
+    for (int b = 0; b < numBlocks; ++b)
+    {
+        for (int s = 0; s < numStrips; ++s)
+        {
+            std::copy_n(input(s, b), blockSize, processorOut.getWritePointer(s));
+            processors[(size_t)s]->processBlock(*views[(size_t)s], midi);
+        }
+    }
+    const auto processorSeconds = (juce::Time::getMillisecondCounterHiRes() - t0) * 0.001;
+
+    t0 = juce::Time::getMillisecondCounterHiRes();
+    for (int b = 0; b < numBlocks; ++b)
+    {
+        for (int s = 0; s < numStrips; ++s)
+            std::copy_n(input(s, b), blockSize, bankOut.getWritePointer(s));
+
+        bank.process(bankOut.getArrayOfWritePointers(), blockSize);
+    }
+    const auto bankSeconds = (juce::Time::getMillisecondCounterHiRes() - t0) * 0.001;
+
+    const double audioSeconds = (double)numBlocks * blockSize / sampleRate;
+    auto report = [&](const char* label, double processSeconds)
+        {
+            std::cout << "  " << label << juce::String(processSeconds * 1.0e6 / numBlocks, 1) << " us per block, "
+                      << juce::String((double)numStrips * audioSeconds / processSeconds, 0) << " real-time strips per core\n";
+        };
+
+    report("processors  ", processorSeconds);
+    report("bank        ", bankSeconds);
+    std::cout << "  speed-up    " << juce::String(processorSeconds / bankSeconds, 2) << "x (bank state "
+              << juce::String((double)bank.getDspStateBytes() / 1024.0, 1) << " KiB)\n";
+
+    // The gain ramps and start-up transients have long settled by the last block
+    double worstDb = -200.0;
+    int worstStrip = 0;
+    for (int s = 0; s < numStrips; ++s)
+    {
+        const double e = errorDb(bankOut.getReadPointer(s), processorOut.getReadPointer(s), blockSize);
+        if (e > worstDb)
+        {
+            worstDb = e;
+            worstStrip = s;
+        }
+    }
+
+    std::cout << "  accuracy    worst strip (" << worstStrip << ") " << juce::String(worstDb, 1)
+              << " dB error against the processor\n";
+
+    if (worstDb > maxErrorDb)
+    {
+        std::cout << "  FAILED: outputs differ by more than " << maxErrorDb << " dB\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,297 @@
+#include "../Source/PluginProcessor.h"
+#include <cerrno>
+#include <csignal>
+#include <iostream>
+
+#if JUCE_WINDOWS
+ #include <fcntl.h>
+ #include <io.h>
+#else
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#endif
+
+// JuceEQPipe - the EQ as a raw PCM filter, for ffmpeg/sox pipelines and streaming servers
+//
+//  JuceEQPipe --rate=Hz --channels=N [--format=f32|s16|s24] [--block=N] [--preset=preset.xml] [--socket=path]
+//
+// Reads interleaved little-endian PCM from stdin (or from a Unix domain socket it connects to) and writes the
+// processed stream in the same format to stdout. The preset is the plugin's state XML (as saved by the plugin or
+// JuceEQFit --out). Blocks are small (64 frames by default) and every buffer is allocated up front; a block goes
+// out as soon as it's full. Format conversion and (de)interleaving happen in one pass straight into the
+// processor's buffer. Any latency (limiter lookahead) is compensated: the first latency frames are dropped and
+// the tail is flushed at end of stream, so output lines up with input sample for sample.
+// Diagnostics go to stderr. e.g.
+//
+//  ffmpeg -i in.wav -f f32le -ac 2 -ar 48000 - | JuceEQPipe --rate=48000 --channels=2 --preset=vocal.xml |
+//      ffmpeg -f f32le -ac 2 -ar 48000 -i - out.wav
+
+namespace
+{
+    using NativeFloat = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+
+    enum class SampleFormat { f32, s16, s24 };
+
+    int bytesPerSample(SampleFormat format)
+    {
+        return format == SampleFormat::f32 ? 4 : format == SampleFormat::s16 ? 2 : 3;
+    }
+
+    // Raw PCM -> the processor's planar float buffer, converting and deinterleaving in one pass
+    template <typename Format>
+    void readInto(const char* bytes, juce::AudioBuffer<float>& buffer, int numFrames)
+    {
+        using Source = juce::AudioData::InterleavedSource<Format>;
+
+        juce::AudioData::deinterleaveSamples(
+            Source{ reinterpret_cast<typename Source::DataType>(bytes), buffer.getNumChannels() },
+            juce::AudioData::NonInterleavedDest<NativeFloat>{ buffer.getArrayOfWritePointers(), buffer.getNumChannels() },
+            numFrames);
+    }
+
+    template <typename Format>
+    void writeFrom(const juce::AudioBuffer<float>& buffer, int startFrame, char* bytes, int numFrames)
+    {
+        using Dest = juce::AudioData::InterleavedDest<Format>;
+
+        const float* channels[64];
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            channels[ch] = buffer.getReadPointer(ch, startFrame);
+
+        juce::AudioData::interleaveSamples(
+            juce::AudioData::NonInterleavedSource<NativeFloat>{ channels, buffer.getNumChannels() },
+            Dest{ reinterpret_cast<typename Dest::DataType>(bytes), buffer.getNumChannels() },
+            numFrames);
+    }
+
+    void decode(SampleFormat format, const char* bytes, juce::AudioBuffer<float>& buffer, int numFrames)
+    {
+        using namespace juce::AudioData;
+
+        switch (format)
+        {
+            case SampleFormat::s16: readInto<Format<Int16, LittleEndian>>(bytes, buffer, numFrames); break;
+            case SampleFormat::s24: readInto<Format<Int24, LittleEndian>>(bytes, buffer, numFrames); break;
+            case SampleFormat::f32:
+            default: readInto<Format<Float32, LittleEndian>>(bytes, buffer, numFrames); break;
+        }
+    }
+
+    void encode(SampleFormat format, const juce::AudioBuffer<float>& buffer, int startFrame, char* bytes, int numFrames)
+    {
+        using namespace juce::AudioData;
+
+        switch (format)
+        {
+            case SampleFormat::s16: writeFrom<Format<Int16, LittleEndian>>(buffer, startFrame, bytes, numFrames); break;
+            case SampleFormat::s24: writeFrom<Format<Int24, LittleEndian>>(buffer, startFrame, bytes, numFrames); break;
+            case SampleFormat::f32:
+            default: writeFrom<Format<Float32, LittleEndian>>(buffer, startFrame, bytes, numFrames); break;
+        }
+    }
+
+    // Fills 'bytes' unless the stream ends first - returns how many bytes arrived
+    size_t readFully(int fd, char* bytes, size_t size)
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+           #if JUCE_WINDOWS
+            const auto n = _read(fd, bytes + done, (unsigned int)(size - done));
+           #else
+            const auto n = ::read(fd, bytes + done, size - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+           #endif
+            if (n <= 0)
+                break;
+            done += (size_t)n;
+        }
+        return done;
+    }
+
+    bool writeFully(int fd, const char* bytes, size_t size)
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+           #if JUCE_WINDOWS
+            const auto n = _write(fd, bytes + done, (unsigned int)(size - done));
+           #else
+            const auto n = ::write(fd, bytes + done, size - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+           #endif
+            if (n <= 0)
+                return false;
+            done += (size_t)n;
+        }
+        return true;
+    }
+
+    int connectSocket(const juce::String& path)
+    {
+       #if JUCE_WINDOWS
+        juce::ignoreUnused(path);
+        std::cerr << "JuceEQPipe: --socket isn't supported on Windows\n";
+        return -1;
+       #else
+        sockaddr_un address{};
+        if (path.getNumBytesAsUTF8() >= sizeof(address.sun_path))
+        {
+            std::cerr << "JuceEQPipe: socket path too long\n";
+            return -1;
+        }
+
+        address.sun_family = AF_UNIX;
+        path.copyToUTF8(address.sun_path, sizeof(address.sun_path));
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, (const sockaddr*)&address, sizeof(address)) != 0)
+        {
+            std::cerr << "JuceEQPipe: can't connect to " << path << "\n";
+            if (fd >= 0)
+                ::close(fd);
+            return -1;
+        }
+        return fd;
+       #endif
+    }
+
+    int usage()
+    {
+        std::cerr << "Usage: JuceEQPipe --rate=Hz --channels=N [--format=f32|s16|s24] [--block=N]\n"
+                     "                  [--preset=preset.xml] [--socket=path]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit; // APVTS needs a message manager
+    juce::ArgumentList args(argc, argv);
+
+    if (!args.containsOption("--rate") || !args.containsOption("--channels"))
+        return usage();
+
+    const double sampleRate = args.getValueForOption("--rate").getDoubleValue();
+    const int numChannels = args.getValueForOption("--channels").getIntValue();
+    const int blockSize = args.containsOption("--block") ? args.getValueForOption("--block").getIntValue() : 64;
+    const auto formatName = args.containsOption("--format") ? args.getValueForOption("--format") : juce::String("f32");
+
+    if (sampleRate <= 0.0 || numChannels < 1 || numChannels > 64 || blockSize < 1)
+        return usage();
+
+    SampleFormat format;
+    if (formatName == "f32") format = SampleFormat::f32;
+    else if (formatName == "s16") format = SampleFormat::s16;
+    else if (formatName == "s24") format = SampleFormat::s24;
+    else return usage();
+
+    // Processor
+    JuceEQAudioProcessor processor;
+
+    if (args.containsOption("--preset"))
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--preset"));
+        auto xml = juce::XmlDocument::parse(file);
+        if (xml == nullptr || !xml->hasTagName(processor.apvts.state.getType()))
+        {
+            std::cerr << "JuceEQPipe: can't read preset " << file.getFullPathName() << "\n";
+            return 1;
+        }
+        processor.apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    }
+
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(channelSet);
+    layout.outputBuses.add(channelSet);
+
+    if (!processor.setBusesLayout(layout))
+    {
+        std::cerr << "JuceEQPipe: unsupported channel count\n";
+        return 1;
+    }
+
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize); // Reads the preset, so the latency is known from here
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    // Streams
+    int inFd = 0;
+    const int outFd = 1;
+
+   #if JUCE_WINDOWS
+    _setmode(0, _O_BINARY);
+    _setmode(1, _O_BINARY);
+   #else
+    std::signal(SIGPIPE, SIG_IGN); // A closed reader ends the loop through write() instead
+   #endif
+
+    if (args.containsOption("--socket"))
+    {
+        inFd = connectSocket(args.getValueForOption("--socket"));
+        if (inFd < 0)
+            return 1;
+    }
+
+    const size_t frameBytes = (size_t)numChannels * (size_t)bytesPerSample(format);
+    juce::HeapBlock<char> inBytes(frameBytes * (size_t)blockSize), outBytes(frameBytes * (size_t)blockSize);
+
+    int latencyToDrop = processor.getLatencySamples();
+    int tailToFlush = latencyToDrop;
+    bool ok = true;
+
+    std::cerr << "JuceEQPipe: " << numChannels << " ch, " << sampleRate << " Hz, " << formatName << ", "
+              << blockSize << "-frame blocks, " << latencyToDrop << " frames latency compensated\n";
+
+    auto emit = [&](int numFrames)
+        {
+            const int skip = juce::jmin(latencyToDrop, numFrames);
+            latencyToDrop -= skip;
+
+            if (skip == numFrames)
+                return true;
+
+            encode(format, buffer, skip, outBytes.get(), numFrames - skip);
+            return writeFully(outFd, outBytes.get(), (size_t)(numFrames - skip) * frameBytes);
+        };
+
+    for (;;)
+    {
+        const size_t got = readFully(inFd, inBytes.get(), frameBytes * (size_t)blockSize);
+        const int numFrames = (int)(got / frameBytes);
+
+        if (numFrames == 0)
+            break;
+
+        buffer.setSize(numChannels, numFrames, false, false, true); // Shrinks only for the final partial block
+        decode(format, inBytes.get(), buffer, numFrames);
+        processor.processBlock(buffer, midi);
+
+        if (!(ok = emit(numFrames)) || numFrames < blockSize)
+            break;
+    }
+
+    // Flush the latency tail with silence
+    while (ok && tailToFlush > 0)
+    {
+        const int numFrames = juce::jmin(blockSize, tailToFlush);
+        buffer.setSize(numChannels, numFrames, false, false, true);
+        buffer.clear();
+        processor.processBlock(buffer, midi);
+        ok = emit(numFrames);
+        tailToFlush -= numFrames;
+    }
+
+   #if !JUCE_WINDOWS
+    if (inFd != 0)
+        ::close(inFd);
+   #endif
+
+    return ok ? 0 : 1;
+}
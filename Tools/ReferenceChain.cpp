@@ -0,0 +1,179 @@
+#include "ReferenceChain.h"
+
+namespace
+{
+    constexpr float minFreq = 10.0f, maxFreq = 20000.0f; // EqConstants
+    constexpr float minQ = 0.10f, maxQ = 40.0f;
+    constexpr float minGainDb = -30.0f, maxGainDb = 30.0f;
+    constexpr double butterworthQ = 0.70710678118654752;
+
+    // Same clamp as EqDesign - the parameter range, then 0.49x the sample rate
+    double clampFreq(float freqHz, double sampleRate)
+    {
+        return juce::jmin((double)juce::jlimit(minFreq, maxFreq, freqHz), 0.49 * sampleRate);
+    }
+
+    // Same mapping as JuceEQAudioProcessor::numStagesForSlopeIndex
+    int numStages(int slopeIndex)
+    {
+        return slopeIndex <= 1 ? 1 : 1 << (slopeIndex - 1);
+    }
+}
+
+void ReferenceChain::prepare(double newSampleRate, int numChannels, FilterSection::TopologyMode mode)
+{
+    sampleRate = newSampleRate;
+    topologyMode = mode;
+    first = true;
+
+    hpf = lpf = Section{};
+    peaks.fill(Section{});
+    states.assign((size_t)numChannels, ChannelState{});
+
+    inGain = juce::SmoothedValue<double>();
+    outGain = juce::SmoothedValue<double>();
+    inGain.reset(sampleRate, 0.02);
+    outGain.reset(sampleRate, 0.02);
+}
+
+bool ReferenceChain::updateSection(Section& section, const FilterSection::Design& design)
+{
+    const auto topology = FilterSection::chooseTopology(design, topologyMode, section.topology);
+    const bool changed = topology != section.topology;
+
+    section.topology = topology;
+    section.firstOrder = design.shape == FilterSection::Shape::firstOrderHighPass
+        || design.shape == FilterSection::Shape::firstOrderLowPass;
+    FilterSection::makeDoubleCoefficients(design, section.df);
+    FilterSection::makeSvfCoefficients(design, section.svf);
+    return changed;
+}
+
+// Mirrors the processor's dirty tracking - a section is only rebuilt when its own parameters changed
+void ReferenceChain::updateSections(const Params& p)
+{
+    using Shape = FilterSection::Shape;
+
+    if (first || p.hpfEnabled != last.hpfEnabled || p.hpfFreqHz != last.hpfFreqHz || p.hpfSlopeIndex != last.hpfSlopeIndex)
+    {
+        const FilterSection::Design design{ p.hpfSlopeIndex == 0 ? Shape::firstOrderHighPass : Shape::highPass,
+            sampleRate, clampFreq(p.hpfFreqHz, sampleRate), butterworthQ, 0.0 };
+
+        if (updateSection(hpf, design))
+            for (auto& ch : states)
+                ch.hpf.fill(State{});
+    }
+
+    if (first || p.lpfEnabled != last.lpfEnabled || p.lpfFreqHz != last.lpfFreqHz || p.lpfSlopeIndex != last.lpfSlopeIndex)
+    {
+        const FilterSection::Design design{ p.lpfSlopeIndex == 0 ? Shape::firstOrderLowPass : Shape::lowPass,
+            sampleRate, clampFreq(p.lpfFreqHz, sampleRate), butterworthQ, 0.0 };
+
+        if (updateSection(lpf, design))
+            for (auto& ch : states)
+                ch.lpf.fill(State{});
+    }
+
+    for (int b = 0; b < maxBands; ++b)
+    {
+        const auto& band = p.bands[(size_t)b];
+        if ((!first && band == last.bands[(size_t)b]) || !band.enabled)
+            continue;
+
+        const FilterSection::Design design{ Shape::peak, sampleRate, clampFreq(band.freqHz, sampleRate),
+            (double)juce::jlimit(minQ, maxQ, band.q), (double)juce::jlimit(minGainDb, maxGainDb, band.gainDb) };
+
+        if (updateSection(peaks[(size_t)b], design))
+            for (auto& ch : states)
+                ch.peaks[(size_t)b] = State{};
+    }
+
+    last = p;
+    first = false;
+}
+
+void ReferenceChain::processSection(const Section& s, State& state, double* data, int numSamples)
+{
+    if (s.topology == FilterSection::Topology::directForm)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double x = data[i];
+            const double y = s.df[0] * x + state.s1;
+            state.s1 = s.df[1] * x - s.df[3] * y + state.s2;
+            state.s2 = s.df[2] * x - s.df[4] * y;
+            data[i] = y;
+        }
+        return;
+    }
+
+    const double g = s.svf[0], gk = s.svf[1], h = s.svf[2], m0 = s.svf[3], m1 = s.svf[4], m2 = s.svf[5];
+
+    if (s.firstOrder)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double x = data[i];
+            const double v = (x - state.s1) * g;
+            const double low = v + state.s1;
+            state.s1 = low + v;
+            data[i] = m0 * x + m2 * low;
+        }
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const double x = data[i];
+        const double band = state.s1 + h * (x - state.s2 - gk * state.s1);
+        const double low = state.s2 + g * band;
+        state.s1 = 2.0 * band - state.s1;
+        state.s2 = 2.0 * low - state.s2;
+        data[i] = m0 * x + m1 * band + m2 * low;
+    }
+}
+
+void ReferenceChain::process(const Params& p, double* const* channels, int numChannels, int numSamples)
+{
+    updateSections(p);
+    numChannels = juce::jmin(numChannels, (int)states.size());
+
+    // One gain ramp shared by every channel, as the processor does it
+    auto fillRamp = [numSamples](juce::SmoothedValue<double>& gain, float db, std::vector<double>& ramp)
+        {
+            gain.setTargetValue(juce::Decibels::decibelsToGain((double)db));
+            ramp.resize((size_t)numSamples);
+            for (auto& r : ramp)
+                r = gain.getNextValue();
+        };
+
+    fillRamp(inGain, p.inGainDb, inRamp);
+    fillRamp(outGain, p.outGainDb, outRamp);
+
+    const int hpfStages = numStages(p.hpfSlopeIndex);
+    const int lpfStages = numStages(p.lpfSlopeIndex);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        double* data = channels[ch];
+        auto& st = states[(size_t)ch];
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= inRamp[(size_t)i];
+
+        if (p.hpfEnabled)
+            for (int s = 0; s < hpfStages; ++s)
+                processSection(hpf, st.hpf[(size_t)s], data, numSamples);
+
+        for (int b = 0; b < maxBands; ++b)
+            if (p.bands[(size_t)b].enabled && p.bands[(size_t)b].gainDb != 0.0f)
+                processSection(peaks[(size_t)b], st.peaks[(size_t)b], data, numSamples);
+
+        if (p.lpfEnabled)
+            for (int s = 0; s < lpfStages; ++s)
+                processSection(lpf, st.lpf[(size_t)s], data, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= outRamp[(size_t)i];
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../Source/FilterSection.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <vector>
+
+/**
+ * Double-precision model of the processor's filter chain, for accuracy checks of the optimised float paths:
+ * input gain -> HPF stages -> peaks -> LPF stages -> output gain. Every section comes from the same designs the
+ * processor uses and runs in the same topology it picks (with the same state resets on a topology switch, and the
+ * same 0 dB peak skip), so whatever difference is left is float arithmetic.
+ * The limiter, bypass and flat-curve fades aren't modelled - harnesses keep those out of the way.
+ */
+class ReferenceChain
+{
+public:
+    static constexpr int maxStages = 4;
+    static constexpr int maxBands = 8;
+
+    struct Band
+    {
+        bool enabled = false;
+        float freqHz = 1000.0f, q = 1.0f, gainDb = 0.0f;
+
+        bool operator==(const Band&) const = default;
+    };
+
+    // Raw parameter values, as the processor snapshots them
+    struct Params
+    {
+        float inGainDb = 0.0f, outGainDb = 0.0f;
+        bool hpfEnabled = false, lpfEnabled = false;
+        float hpfFreqHz = 20.0f, lpfFreqHz = 20000.0f;
+        int hpfSlopeIndex = 0, lpfSlopeIndex = 0;
+        std::array<Band, maxBands> bands{};
+    };
+
+    void prepare(double sampleRate, int numChannels, FilterSection::TopologyMode mode);
+
+    // Applies 'params' at the start of the block, like the processor's per-block snapshot
+    void process(const Params& params, double* const* channels, int numChannels, int numSamples);
+
+private:
+    struct Section
+    {
+        FilterSection::Topology topology = FilterSection::Topology::directForm;
+        bool firstOrder = false;
+        double df[5]{ 1.0, 0.0, 0.0, 0.0, 0.0 };
+        double svf[6]{};
+    };
+
+    struct State
+    {
+        double s1 = 0.0, s2 = 0.0;
+    };
+
+    struct ChannelState
+    {
+        std::array<State, maxStages> hpf{}, lpf{};
+        std::array<State, maxBands> peaks{};
+    };
+
+    static void processSection(const Section& section, State& state, double* data, int numSamples);
+    bool updateSection(Section& section, const FilterSection::Design& design); // True if the topology changed
+    void updateSections(const Params& params);
+
+    double sampleRate = 44100.0;
+    FilterSection::TopologyMode topologyMode = FilterSection::TopologyMode::automatic;
+
+    Params last;
+    bool first = true;
+
+    Section hpf, lpf;
+    std::array<Section, maxBands> peaks{};
+    std::vector<ChannelState> states;
+
+    juce::SmoothedValue<double> inGain, outGain; // Same 20 ms linear ramps as the processor's gains
+    std::vector<double> inRamp, outRamp;
+};
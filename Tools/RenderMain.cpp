@@ -0,0 +1,392 @@
+#include "../Source/PluginProcessor.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+// JuceEQRender - renders one audio file through the EQ, split into chunks processed in parallel
+//
+//  JuceEQRender <in.wav|aiff|flac> <out.wav> [--preset=preset.xml] [--threads=N] [--chunks=N] [--block=N]
+//               [--tolerance=dB] [--skip-sequential]
+//
+// A long master is one sequential recurrence through processBlock, so it can't use more than one core as it
+// stands. Here the file is cut into chunks (one per thread by default) and each chunk gets its own processor,
+// started a pre-roll earlier than the chunk so the filter and limiter state has converged by its first sample;
+// the pre-roll output is thrown away and the chunks are stitched end to end. The pre-roll comes from the active
+// filters' decay time (getTailLengthSeconds - the summed decay of every section to -120 dB) plus the latency,
+// the limiter's release and the gain ramps.
+// Every seam is checked: the first stretch of the chunk is rendered again with twice the pre-roll and compared;
+// if they differ by more than the tolerance (-120 dBFS by default) the chunk is redone with the longer pre-roll
+// until they agree, or the pre-roll reaches back to the start of the file. The settings are static (the preset's),
+// as in a mastering bounce; latency is compensated, so the output lines up with the input sample for sample.
+// Then the file is rendered again sequentially, block by block like a host would, to report the speed-up and
+// the largest deviation between the two (--skip-sequential leaves that out). Exits with 1 if the deviation - or,
+// without the sequential pass, any seam check - is over the tolerance.
+// Both the input and the output are held in memory as float, about 23 MB per stereo minute at 48 kHz.
+
+namespace
+{
+    struct RenderSetup
+    {
+        const juce::XmlElement* preset = nullptr;
+        double sampleRate = 48000.0;
+        int numChannels = 2;
+        int blockSize = 1024;
+    };
+
+    std::unique_ptr<JuceEQAudioProcessor> createProcessor(const RenderSetup& setup)
+    {
+        auto processor = std::make_unique<JuceEQAudioProcessor>();
+
+        if (setup.preset != nullptr)
+            processor->apvts.replaceState(juce::ValueTree::fromXml(*setup.preset));
+
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(setup.numChannels);
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(channelSet);
+        layout.outputBuses.add(channelSet);
+
+        if (!processor->setBusesLayout(layout))
+            return nullptr;
+
+        processor->setRateAndBufferSizeDetails(setup.sampleRate, setup.blockSize);
+        return processor;
+    }
+
+    // Feeds file samples [start - preroll, end + latency) through a freshly prepared processor (zeros past the end
+    // of the file) and hands the output for file samples [start, end) to sink(fileSample, block, offset, n)
+    template <typename Sink>
+    void renderRange(JuceEQAudioProcessor& processor, const RenderSetup& setup, const juce::AudioBuffer<float>& input,
+                     int start, int end, int preroll, Sink&& sink)
+    {
+        processor.prepareToPlay(setup.sampleRate, setup.blockSize);
+
+        const int length = input.getNumSamples();
+        const int latency = processor.getLatencySamples();
+        const int first = juce::jmax(0, start - preroll);
+        const int total = end + latency - first;
+        const int keepFrom = start + latency - first; // First processed sample that belongs to the output
+
+        juce::AudioBuffer<float> block(setup.numChannels, setup.blockSize);
+        juce::MidiBuffer midi;
+
+        for (int pos = 0; pos < total; pos += setup.blockSize)
+        {
+            const int n = juce::jmin(setup.blockSize, total - pos);
+            const int available = juce::jlimit(0, n, length - (first + pos));
+
+            block.setSize(setup.numChannels, n, false, false, true);
+            for (int ch = 0; ch < setup.numChannels; ++ch)
+            {
+                if (available > 0)
+                    block.copyFrom(ch, 0, input, ch, first + pos, available);
+                if (available < n)
+                    block.clear(ch, available, n - available);
+            }
+
+            processor.processBlock(block, midi);
+
+            const int keepStart = juce::jmax(pos, keepFrom);
+            if (keepStart < pos + n)
+                sink(start + keepStart - keepFrom, block, keepStart - pos, pos + n - keepStart);
+        }
+    }
+
+    // Largest |a - b| between a processed block and the same file samples in `reference`
+    float maxDifference(const juce::AudioBuffer<float>& reference, int fileSample, const juce::AudioBuffer<float>& block,
+                        int offset, int n, int* worstSample = nullptr, int* worstChannel = nullptr)
+    {
+        float worst = 0.0f;
+
+        for (int ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            const float* a = reference.getReadPointer(ch, fileSample);
+            const float* b = block.getReadPointer(ch, offset);
+
+            for (int i = 0; i < n; ++i)
+            {
+                const float d = std::abs(a[i] - b[i]);
+                if (d > worst)
+                {
+                    worst = d;
+                    if (worstSample != nullptr) *worstSample = fileSample + i;
+                    if (worstChannel != nullptr) *worstChannel = ch;
+                }
+            }
+        }
+
+        return worst;
+    }
+
+    // Settling time of everything in the chain that carries state from one block to the next
+    int estimatePreroll(JuceEQAudioProcessor& processor, const RenderSetup& setup)
+    {
+        processor.prepareToPlay(setup.sampleRate, setup.blockSize); // Reads the preset and works out the tail
+
+        double seconds = processor.getTailLengthSeconds() + 0.03; // Filters, then the gain ramp and crossfades
+        if (processor.apvts.getRawParameterValue("limiterEnabled")->load() > 0.5f)
+        {
+            // Release is a one-pole ease back up - 14 time constants takes it to -120 dB
+            seconds += 14.0 * 0.001 * (double)processor.apvts.getRawParameterValue("limiterRelease")->load();
+        }
+
+        return processor.getLatencySamples() + setup.blockSize + (int)std::ceil(seconds * setup.sampleRate);
+    }
+
+    double toDb(float linear)
+    {
+        return 20.0 * std::log10(juce::jmax((double)linear, 1.0e-30));
+    }
+
+    juce::String formatDb(float linear)
+    {
+        return linear == 0.0f ? juce::String("exact (0)") : juce::String(toDb(linear), 1) + " dBFS";
+    }
+
+    juce::String formatTime(double seconds)
+    {
+        const int whole = (int)seconds;
+        return juce::String::formatted("%d:%02d:%06.3f", whole / 3600, (whole / 60) % 60, seconds - (double)(whole - whole % 60));
+    }
+
+    struct Chunk
+    {
+        int start = 0, end = 0, preroll = 0;
+        float seamError = 0.0f; // Against a render with twice the pre-roll
+        int rerenders = 0;
+    };
+
+    int usage()
+    {
+        std::cerr << "Usage: JuceEQRender <in.wav|aiff|flac> <out.wav> [--preset=preset.xml] [--threads=N] [--chunks=N]\n"
+                     "                    [--block=N] [--tolerance=dB] [--skip-sequential]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit; // APVTS needs a message manager
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() < 2 || args[0].isOption() || args[1].isOption())
+        return usage();
+
+    const auto inFile = args[0].resolveAsFile();
+    const auto outFile = args[1].resolveAsFile();
+    const int numThreads = args.containsOption("--threads") ? juce::jmax(1, args.getValueForOption("--threads").getIntValue())
+                                                            : juce::jmax(1, juce::SystemStats::getNumCpus());
+    const float tolerance = (float)juce::Decibels::decibelsToGain(args.containsOption("--tolerance")
+                                                                      ? args.getValueForOption("--tolerance").getDoubleValue() : -120.0);
+    const bool sequential = !args.containsOption("--skip-sequential");
+
+    CpuGovernor::setSessionPolicy({}); // Full quality, like any offline bounce
+
+    // Input
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(inFile));
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+    {
+        std::cerr << "JuceEQRender: can't read " << inFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    if (reader->lengthInSamples > (juce::int64)std::numeric_limits<int>::max() - (juce::int64)(60 * reader->sampleRate))
+    {
+        std::cerr << "JuceEQRender: " << inFile.getFileName() << " is too long to hold in one buffer\n";
+        return 1;
+    }
+
+    RenderSetup setup;
+    setup.sampleRate = reader->sampleRate;
+    setup.numChannels = (int)reader->numChannels;
+    setup.blockSize = args.containsOption("--block") ? juce::jmax(16, args.getValueForOption("--block").getIntValue()) : 1024;
+
+    const int length = (int)reader->lengthInSamples;
+    juce::AudioBuffer<float> input(setup.numChannels, length);
+    reader->read(&input, 0, length, 0, true, true);
+
+    std::unique_ptr<juce::XmlElement> preset;
+    if (args.containsOption("--preset"))
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--preset"));
+        preset = juce::XmlDocument::parse(file);
+        if (preset == nullptr || !preset->hasTagName(JuceEQAudioProcessor().apvts.state.getType()))
+        {
+            std::cerr << "JuceEQRender: can't read preset " << file.getFullPathName() << "\n";
+            return 1;
+        }
+        setup.preset = preset.get();
+    }
+
+    auto probe = createProcessor(setup);
+    if (probe == nullptr)
+    {
+        std::cerr << "JuceEQRender: unsupported channel count " << setup.numChannels << "\n";
+        return 1;
+    }
+
+    const int basePreroll = estimatePreroll(*probe, setup);
+    const int latency = probe->getLatencySamples();
+
+    // Chunks - no shorter than a few pre-rolls, or warming up would cost more than the chunk
+    const int numChunks = juce::jlimit(1, juce::jmax(1, length / (4 * basePreroll)),
+                                       args.containsOption("--chunks") ? args.getValueForOption("--chunks").getIntValue() : numThreads);
+    std::vector<Chunk> chunks((size_t)numChunks);
+    for (int c = 0; c < numChunks; ++c)
+    {
+        chunks[(size_t)c].start = (int)((juce::int64)length * c / numChunks);
+        chunks[(size_t)c].end = (int)((juce::int64)length * (c + 1) / numChunks);
+    }
+
+    std::cout << "JuceEQRender: " << inFile.getFileName() << ", " << setup.numChannels << " ch, " << setup.sampleRate
+              << " Hz, " << formatTime(length / setup.sampleRate) << " (" << length << " samples), latency " << latency << "\n"
+              << "  pre-roll " << juce::String(basePreroll / setup.sampleRate, 3) << " s (" << basePreroll << " samples), tail "
+              << juce::String(probe->getTailLengthSeconds(), 3) << " s\n";
+
+    // Processors are created (and destroyed) here, on the message thread; the workers only prepare and process
+    std::vector<std::unique_ptr<JuceEQAudioProcessor>> processors;
+    for (int c = 0; c < numChunks; ++c)
+        processors.push_back(createProcessor(setup));
+
+    juce::AudioBuffer<float> output(setup.numChannels, length);
+
+    // Chunked render, each seam verified against twice the pre-roll
+    const double chunkedStart = juce::Time::getMillisecondCounterHiRes();
+    std::atomic<int> nextChunk{ 0 };
+
+    auto worker = [&]()
+        {
+            for (int c = nextChunk++; c < numChunks; c = nextChunk++)
+            {
+                auto& chunk = chunks[(size_t)c];
+                auto& processor = *processors[(size_t)c];
+                chunk.preroll = basePreroll;
+
+                for (;;)
+                {
+                    renderRange(processor, setup, input, chunk.start, chunk.end, chunk.preroll,
+                        [&output](int fileSample, const juce::AudioBuffer<float>& block, int offset, int n)
+                            {
+                                for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                                    output.copyFrom(ch, fileSample, block, ch, offset, n);
+                            });
+
+                    // From the start of the file there's nothing to converge - it's the sequential render
+                    if (chunk.start - chunk.preroll <= 0)
+                    {
+                        chunk.seamError = 0.0f;
+                        break;
+                    }
+
+                    const int checkEnd = juce::jmin(chunk.end, chunk.start + chunk.preroll);
+                    chunk.seamError = 0.0f;
+                    renderRange(processor, setup, input, chunk.start, checkEnd, 2 * chunk.preroll,
+                        [&output, &chunk](int fileSample, const juce::AudioBuffer<float>& block, int offset, int n)
+                            {
+                                chunk.seamError = juce::jmax(chunk.seamError, maxDifference(output, fileSample, block, offset, n));
+                            });
+
+                    if (chunk.seamError <= tolerance)
+                        break;
+
+                    chunk.preroll *= 2;
+                    ++chunk.rerenders;
+                }
+            }
+        };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < juce::jmin(numThreads, numChunks); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
+
+    const double chunkedSeconds = (juce::Time::getMillisecondCounterHiRes() - chunkedStart) * 0.001;
+
+    float worstSeam = 0.0f;
+    int worstSeamChunk = 0, rerenders = 0;
+    for (int c = 0; c < numChunks; ++c)
+    {
+        rerenders += chunks[(size_t)c].rerenders;
+        if (chunks[(size_t)c].seamError > worstSeam)
+        {
+            worstSeam = chunks[(size_t)c].seamError;
+            worstSeamChunk = c;
+        }
+    }
+
+    std::cout << "  chunked: " << numChunks << " chunks on " << juce::jmin(numThreads, numChunks) << " threads, "
+              << juce::String(chunkedSeconds, 2) << " s (" << juce::String(length / setup.sampleRate / chunkedSeconds, 1)
+              << "x real time)\n"
+              << "  seam check: worst " << formatDb(worstSeam) << (worstSeam > 0.0f ? " (chunk " + juce::String(worstSeamChunk) + ")" : juce::String())
+              << ", " << rerenders << " re-render(s) with a longer pre-roll\n";
+
+    processors.clear();
+    bool ok = worstSeam <= tolerance;
+
+    // Sequential reference - one processor, start to end, compared against the stitched output as it goes
+    if (sequential)
+    {
+        auto processor = createProcessor(setup);
+        float deviation = 0.0f;
+        int worstSample = 0, worstChannel = 0;
+
+        const double sequentialStart = juce::Time::getMillisecondCounterHiRes();
+        renderRange(*processor, setup, input, 0, length, 0,
+            [&](int fileSample, const juce::AudioBuffer<float>& block, int offset, int n)
+                {
+                    int sample = 0, channel = 0;
+                    const float d = maxDifference(output, fileSample, block, offset, n, &sample, &channel);
+                    if (d > deviation)
+                    {
+                        deviation = d;
+                        worstSample = sample;
+                        worstChannel = channel;
+                    }
+                });
+        const double sequentialSeconds = (juce::Time::getMillisecondCounterHiRes() - sequentialStart) * 0.001;
+
+        std::cout << "  sequential: " << juce::String(sequentialSeconds, 2) << " s, speed-up "
+                  << juce::String(sequentialSeconds / chunkedSeconds, 2) << "x\n"
+                  << "  max deviation from sequential: " << formatDb(deviation);
+        if (deviation > 0.0f)
+            std::cout << " at " << formatTime(worstSample / setup.sampleRate) << " (sample " << worstSample << ", ch " << worstChannel << ")";
+        std::cout << "\n";
+
+        ok = deviation <= tolerance;
+    }
+
+    // Output - same bit depth as the input (as near as WAV has)
+    const int bits = reader->usesFloatingPointData || reader->bitsPerSample > 24 ? 32 : reader->bitsPerSample > 16 ? 24 : 16;
+    outFile.deleteFile();
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::FileOutputStream> stream(outFile.createOutputStream());
+    std::unique_ptr<juce::AudioFormatWriter> writer(stream != nullptr
+        ? wav.createWriterFor(stream.get(), setup.sampleRate, (unsigned int)setup.numChannels, bits, {}, 0)
+        : nullptr);
+
+    if (writer == nullptr)
+    {
+        std::cerr << "JuceEQRender: can't write " << outFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    stream.release(); // The writer owns it now
+    if (!writer->writeFromAudioSampleBuffer(output, 0, length))
+    {
+        std::cerr << "JuceEQRender: writing " << outFile.getFullPathName() << " failed\n";
+        return 1;
+    }
+
+    std::cout << "  -> " << outFile.getFullPathName() << "\n";
+
+    if (!ok)
+        std::cerr << "JuceEQRender: deviation over the " << juce::String(toDb(tolerance), 1) << " dBFS tolerance\n";
+
+    return ok ? 0 : 1;
+}
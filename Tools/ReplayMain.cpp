@@ -0,0 +1,256 @@
+#include "../Source/PluginProcessor.h"
+#include <algorithm>
+#include <iostream>
+
+// JuceEQReplay - runs a JUCEEQ_CAPTURE session back through the processor, offline and bit for bit
+//
+//  JuceEQReplay <capture.eqcapture> [--repeat=N] [--isa=generic|avx2|avx512] [--trace=trace.json]
+//
+// Rebuilds the session from the capture (see SessionCapture.h): the same prepareToPlay calls, the same blocks with
+// the same input at the same CPU governor tiers, and each parameter change landing before the block it was first
+// seen in. Parameters are written
+// as the raw values the DSP read, so nothing goes through a normalise/denormalise round trip. Every block's output
+// is checked against the captured checksum, which proves the replay matches the field session; past a gap
+// (blocks dropped during capture) the state differs, so checking stops there.
+// Reports per-block processing time against the block's real-time budget, so the spike shows up at the block
+// it happened. --repeat runs the session N times (a fresh processor each pass) to give a profiler enough samples;
+// --trace records the replay with the tracing mode (see Trace.h). The capture's kernel variant is used unless
+// --isa overrides it - checksums only match with the same variant.
+// Exits with 1 on a checksum mismatch or an unreadable capture.
+
+namespace
+{
+    struct Timing
+    {
+        juce::uint64 index;
+        double microseconds, budgetMicroseconds;
+    };
+
+    struct PassResult
+    {
+        juce::uint64 blocks = 0, mismatches = 0, firstMismatch = 0, droppedBlocks = 0;
+        double audioSeconds = 0.0, processSeconds = 0.0;
+        bool gap = false, ok = true;
+        std::vector<Timing> timings;
+    };
+
+    template <typename T>
+    bool readStruct(juce::InputStream& in, T& value)
+    {
+        return in.read(&value, sizeof(T)) == (int)sizeof(T);
+    }
+
+    PassResult replay(juce::FileInputStream& in, juce::int64 recordsStart, int numParameters,
+                      const juce::StringArray& parameterIds)
+    {
+        PassResult result;
+        JuceEQAudioProcessor processor;
+        juce::MidiBuffer midi;
+
+        // Capture index -> the raw value the processor reads (nullptr for parameters this build doesn't have)
+        std::vector<std::atomic<float>*> values;
+        for (const auto& id : parameterIds)
+            values.push_back(processor.apvts.getRawParameterValue(id));
+
+        juce::AudioBuffer<float> buffer;
+        std::vector<float> initialValues((size_t)numParameters);
+        std::vector<SessionCapture::Change> changes;
+        bool prepared = false;
+
+        in.setPosition(recordsStart);
+
+        SessionCapture::RecordHeader header{};
+        while (readStruct(in, header))
+        {
+            const auto recordEnd = in.getPosition() + (juce::int64)header.payloadBytes;
+
+            if (header.type == SessionCapture::prepareRecord)
+            {
+                SessionCapture::Prepare prepare{};
+                if (!readStruct(in, prepare) || in.read(initialValues.data(), numParameters * (int)sizeof(float)) != numParameters * (int)sizeof(float))
+                    break;
+
+                const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(prepare.numChannels);
+                juce::AudioProcessor::BusesLayout layout;
+                layout.inputBuses.add(channelSet);
+                layout.outputBuses.add(channelSet);
+
+                if (!processor.setBusesLayout(layout))
+                {
+                    std::cerr << "JuceEQReplay: unsupported channel count " << prepare.numChannels << "\n";
+                    result.ok = false;
+                    return result;
+                }
+
+                for (int i = 0; i < numParameters; ++i)
+                    if (values[(size_t)i] != nullptr)
+                        values[(size_t)i]->store(initialValues[(size_t)i]);
+
+                // prepareToPlay reads the bypass parameter itself rather than its raw value - a bool round-trips exactly
+                if (auto* bypass = processor.getBypassParameter())
+                    bypass->setValueNotifyingHost(prepare.bypassParameter != 0 ? 1.0f : 0.0f);
+
+                processor.setFilterTopologyMode((FilterSection::TopologyMode)prepare.topologyMode);
+                processor.setEngine((JuceEQAudioProcessor::Engine)prepare.engine);
+                processor.setMultirateEnabled(prepare.multirate != 0);
+                processor.setBlockFilters(prepare.blockFilters != 0 ? JuceEQAudioProcessor::BlockFilters::on
+                                                                    : JuceEQAudioProcessor::BlockFilters::off);
+                processor.setRateAndBufferSizeDetails(prepare.sampleRate, prepare.blockSize);
+                processor.prepareToPlay(prepare.sampleRate, prepare.blockSize);
+                prepared = true;
+            }
+            else if (header.type == SessionCapture::blockRecord && prepared)
+            {
+                SessionCapture::Block block{};
+                if (!readStruct(in, block) || block.numChannels < 1 || block.numSamples < 0)
+                    break;
+
+                changes.resize(block.numChanges);
+                const int changeBytes = (int)(block.numChanges * sizeof(SessionCapture::Change));
+                if (in.read(changes.data(), changeBytes) != changeBytes)
+                    break;
+
+                for (const auto& change : changes)
+                    if (change.parameter < values.size() && values[change.parameter] != nullptr)
+                        values[change.parameter]->store(change.value);
+
+                buffer.setSize(block.numChannels, block.numSamples, false, false, true);
+                bool complete = true;
+                for (int ch = 0; ch < block.numChannels && complete; ++ch)
+                {
+                    const int bytes = block.numSamples * (int)sizeof(float);
+                    complete = in.read(buffer.getWritePointer(ch), bytes) == bytes;
+                }
+                if (!complete)
+                    break;
+
+                processor.setQualityTier(block.qualityTier);
+
+                const auto start = juce::Time::getHighResolutionTicks();
+                if (block.bypassed != 0)
+                    processor.processBlockBypassed(buffer, midi);
+                else
+                    processor.processBlock(buffer, midi);
+                const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                const double sampleRate = processor.getSampleRate();
+                result.processSeconds += seconds;
+                result.audioSeconds += block.numSamples / sampleRate;
+                result.timings.push_back({ block.index, seconds * 1.0e6, block.numSamples / sampleRate * 1.0e6 });
+                ++result.blocks;
+
+                if (!result.gap && SessionCapture::checksum(buffer, block.numChannels, block.numSamples) != block.outputChecksum)
+                {
+                    if (result.mismatches++ == 0)
+                        result.firstMismatch = block.index;
+                }
+            }
+            else if (header.type == SessionCapture::gapRecord)
+            {
+                SessionCapture::Gap gap{};
+                if (readStruct(in, gap))
+                    result.droppedBlocks += gap.droppedBlocks;
+                result.gap = true;
+            }
+
+            in.setPosition(recordEnd);
+        }
+
+        return result;
+    }
+
+    int usage()
+    {
+        std::cerr << "Usage: JuceEQReplay <capture.eqcapture> [--repeat=N] [--isa=generic|avx2|avx512] [--trace=trace.json]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit; // APVTS needs a message manager
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() < 1 || args[0].isOption())
+        return usage();
+
+    const auto file = args[0].resolveAsFile();
+    const int repeat = juce::jmax(1, args.containsOption("--repeat") ? args.getValueForOption("--repeat").getIntValue() : 1);
+
+    juce::FileInputStream in(file);
+    SessionCapture::Header header;
+    if (!in.openedOk() || !SessionCapture::readHeader(in, header))
+    {
+        std::cerr << "JuceEQReplay: " << file.getFullPathName() << " isn't a capture this build can read\n";
+        return 1;
+    }
+
+    // Same kernel variant as the capture, or the checksums can't match
+    const auto isa = args.containsOption("--isa") ? args.getValueForOption("--isa") : header.kernelName;
+    if (!DspKernels::select(isa.toRawUTF8()))
+    {
+        std::cerr << "JuceEQReplay: --isa=" << isa << " isn't available on this machine";
+        if (!args.containsOption("--isa"))
+            std::cerr << " (the capture used it) - pass --isa to replay with another variant";
+        std::cerr << "\n";
+        return 1;
+    }
+
+    if (args.containsOption("--trace"))
+        EqTrace::getInstance().start(juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--trace")));
+
+    std::cout << "JuceEQReplay " << file.getFileName() << ", " << header.parameterIds.size() << " parameters, "
+              << DspKernels::get().name << " kernels (captured with " << header.kernelName << ")\n";
+
+    // The governor's policy stays off - left on, it would pick tiers from this machine's timing. Each block runs at
+    // the tier it was captured at instead.
+    CpuGovernor::setSessionPolicy({});
+
+    const auto recordsStart = in.getPosition();
+    bool ok = true;
+
+    for (int pass = 0; pass < repeat && ok; ++pass)
+    {
+        auto result = replay(in, recordsStart, header.parameterIds.size(), header.parameterIds);
+        ok = result.ok && result.mismatches == 0;
+
+        if (pass > 0 && ok)
+            continue; // Passes are identical - the first one's report covers them
+
+        std::cout << "  " << result.blocks << " blocks, " << juce::String(result.audioSeconds, 2) << " s of audio in "
+                  << juce::String(result.processSeconds * 1000.0, 1) << " ms ("
+                  << juce::String(result.audioSeconds / juce::jmax(1.0e-9, result.processSeconds), 0) << "x real time)\n";
+
+        if (!result.timings.empty())
+        {
+            // Worst blocks by share of their real-time budget
+            auto byLoad = result.timings;
+            std::sort(byLoad.begin(), byLoad.end(), [](const Timing& a, const Timing& b)
+                {
+                    return a.microseconds / a.budgetMicroseconds > b.microseconds / b.budgetMicroseconds;
+                });
+
+            std::vector<double> micros;
+            for (const auto& t : result.timings)
+                micros.push_back(t.microseconds);
+            std::sort(micros.begin(), micros.end());
+
+            std::cout << "  per block: median " << juce::String(micros[micros.size() / 2], 1) << " us, 99th percentile "
+                      << juce::String(micros[micros.size() * 99 / 100], 1) << " us\n";
+
+            for (size_t i = 0; i < juce::jmin((size_t)5, byLoad.size()); ++i)
+                std::cout << "  block " << (juce::int64)byLoad[i].index << ": " << juce::String(byLoad[i].microseconds, 1) << " us, "
+                          << juce::String(100.0 * byLoad[i].microseconds / byLoad[i].budgetMicroseconds, 2) << "% of its budget\n";
+        }
+
+        if (result.gap)
+            std::cout << "  " << (juce::int64)result.droppedBlocks << " block(s) were dropped during capture - outputs not checked past the first gap\n";
+
+        std::cout << (result.mismatches == 0 ? "  output matches the capture\n"
+                                             : "  OUTPUT DIFFERS from block " + juce::String((juce::int64)result.firstMismatch) + " ("
+                                                   + juce::String((juce::int64)result.mismatches) + " blocks)\n");
+    }
+
+    EqTrace::getInstance().stop();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * Catches the audio thread allocating, locking or blocking. The global operator new/delete are replaced on every
+ * platform; on Linux (glibc) malloc and friends, pthread mutex/rwlock/condition waits, semaphore waits, sleeps,
+ * read/write and sched_yield are interposed as well (see RtCheckHooks.cpp). Calls only count on a thread that's
+ * inside a Scope; each one is counted and the first few print what was called with a stack trace.
+ */
+namespace RtCheck
+{
+    // Marks the calling thread as the audio thread for its lifetime
+    struct Scope
+    {
+        Scope();
+        ~Scope();
+
+    private:
+        bool wasInScope;
+    };
+
+    int getViolationCount();
+    void setReportLimit(int maxStackTraces);
+
+    // What's being watched on this platform, for the tool's banner
+    const char* getCoverage();
+
+    // Calls each hooked function inside a Scope and checks it was caught, so a broken interposition can't pass
+    // silently. Prints what was missed; the violation count is left at zero afterwards.
+    bool selfTest();
+}
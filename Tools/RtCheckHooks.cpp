@@ -0,0 +1,498 @@
+#include "RtCheck.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__) && defined(__GLIBC__)
+ #define RTCHECK_INTERPOSE 1
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <semaphore.h>
+ #include <time.h>
+ #include <unistd.h>
+#else
+ #define RTCHECK_INTERPOSE 0
+#endif
+
+#if defined(_WIN32)
+ #include <malloc.h>
+#endif
+
+// Nothing in here may allocate, lock or print while it's deciding whether a call is a violation - only the report
+// itself does, with inHook set so its own calls don't count.
+
+namespace
+{
+    thread_local bool inScope = false;
+    thread_local bool inHook = false;
+
+    std::atomic<int> violations{ 0 };
+    std::atomic<int> reportLimit{ 20 };
+    std::atomic<bool> quiet{ false };
+
+    void* volatile sink = nullptr; // Keeps the self-test's allocations from being optimised away
+}
+
+//==============================================================================
+// The real functions
+#if RTCHECK_INTERPOSE
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+
+namespace
+{
+    // Resolved before main (and on first use, in case a library gets there first)
+    struct RealFunctions
+    {
+        int (*mutexLock)(pthread_mutex_t*) = nullptr;
+        int (*rwlockRdlock)(pthread_rwlock_t*) = nullptr;
+        int (*rwlockWrlock)(pthread_rwlock_t*) = nullptr;
+        int (*condWait)(pthread_cond_t*, pthread_mutex_t*) = nullptr;
+        int (*condTimedwait)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*) = nullptr;
+        int (*semWait)(sem_t*) = nullptr;
+        int (*semTimedwait)(sem_t*, const struct timespec*) = nullptr;
+        int (*nanosleep)(const struct timespec*, struct timespec*) = nullptr;
+        int (*clockNanosleep)(clockid_t, int, const struct timespec*, struct timespec*) = nullptr;
+        int (*usleep)(useconds_t) = nullptr;
+        ssize_t (*read)(int, void*, size_t) = nullptr;
+        ssize_t (*write)(int, const void*, size_t) = nullptr;
+        int (*schedYield)() = nullptr;
+    } real;
+
+    template <typename Fn>
+    Fn resolve(Fn& fn, const char* name, const char* version = nullptr)
+    {
+        if (fn == nullptr)
+        {
+            // The condition variable functions have an old compat version that plain dlsym can hand back
+            if (version != nullptr)
+                fn = (Fn)dlvsym(RTLD_NEXT, name, version);
+
+            if (fn == nullptr)
+                fn = (Fn)dlsym(RTLD_NEXT, name);
+
+            if (fn == nullptr)
+                std::abort();
+        }
+        return fn;
+    }
+
+    #define RTCHECK_REAL(member, name) resolve(real.member, name)
+
+    [[maybe_unused]] const bool resolvedAtStartup = []
+        {
+            RTCHECK_REAL(mutexLock, "pthread_mutex_lock");
+            RTCHECK_REAL(rwlockRdlock, "pthread_rwlock_rdlock");
+            RTCHECK_REAL(rwlockWrlock, "pthread_rwlock_wrlock");
+            resolve(real.condWait, "pthread_cond_wait", "GLIBC_2.3.2");
+            resolve(real.condTimedwait, "pthread_cond_timedwait", "GLIBC_2.3.2");
+            RTCHECK_REAL(semWait, "sem_wait");
+            RTCHECK_REAL(semTimedwait, "sem_timedwait");
+            RTCHECK_REAL(nanosleep, "nanosleep");
+            RTCHECK_REAL(clockNanosleep, "clock_nanosleep");
+            RTCHECK_REAL(usleep, "usleep");
+            RTCHECK_REAL(read, "read");
+            RTCHECK_REAL(write, "write");
+            RTCHECK_REAL(schedYield, "sched_yield");
+
+            // backtrace() loads libgcc's unwinder (allocating) the first time - get that out of the way now
+            void* frames[4];
+            backtrace(frames, 4);
+            return true;
+        }();
+
+    void* rawAlloc(size_t size) { return __libc_malloc(size); }
+    void* rawAlignedAlloc(size_t size, size_t alignment) { return __libc_memalign(alignment, size); }
+    void rawFree(void* ptr) { __libc_free(ptr); }
+    void rawAlignedFree(void* ptr) { __libc_free(ptr); }
+}
+#else
+namespace
+{
+    void* rawAlloc(size_t size) { return std::malloc(size); }
+    void rawFree(void* ptr) { std::free(ptr); }
+
+   #if defined(_WIN32)
+    void* rawAlignedAlloc(size_t size, size_t alignment) { return _aligned_malloc(size, alignment); }
+    void rawAlignedFree(void* ptr) { _aligned_free(ptr); }
+   #else
+    void* rawAlignedAlloc(size_t size, size_t alignment)
+    {
+        void* ptr = nullptr;
+        return posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) == 0 ? ptr : nullptr;
+    }
+    void rawAlignedFree(void* ptr) { std::free(ptr); }
+   #endif
+}
+#endif
+
+//==============================================================================
+namespace
+{
+    void writeError(const char* text)
+    {
+       #if RTCHECK_INTERPOSE
+        resolve(real.write, "write")(2, text, std::strlen(text));
+       #else
+        std::fputs(text, stderr);
+       #endif
+    }
+
+    void report(const char* kind)
+    {
+        writeError("RtCheck: audio thread called ");
+        writeError(kind);
+        writeError("\n");
+
+       #if RTCHECK_INTERPOSE
+        void* frames[48];
+        const int numFrames = backtrace(frames, 48);
+        backtrace_symbols_fd(frames + 2, numFrames - 2, 2); // Skips report() and violation()
+        writeError("\n");
+       #endif
+    }
+
+    void violation(const char* kind)
+    {
+        if (!inScope || inHook)
+            return;
+
+        inHook = true;
+        const int count = violations.fetch_add(1) + 1;
+
+        if (!quiet.load())
+        {
+            if (count <= reportLimit.load())
+                report(kind);
+            else if (count == reportLimit.load() + 1)
+                writeError("RtCheck: further stack traces suppressed\n");
+        }
+
+        inHook = false;
+    }
+}
+
+//==============================================================================
+RtCheck::Scope::Scope() : wasInScope(inScope)
+{
+    inScope = true;
+}
+
+RtCheck::Scope::~Scope()
+{
+    inScope = wasInScope;
+}
+
+int RtCheck::getViolationCount()
+{
+    return violations.load();
+}
+
+void RtCheck::setReportLimit(int maxStackTraces)
+{
+    reportLimit.store(maxStackTraces);
+}
+
+const char* RtCheck::getCoverage()
+{
+   #if RTCHECK_INTERPOSE
+    return "operator new/delete, malloc/calloc/realloc/free, aligned allocs, pthread mutex/rwlock/condition waits, "
+           "semaphore waits, sleeps, read/write, sched_yield";
+   #else
+    return "operator new/delete only (malloc, locks and system calls are only interposed on Linux)";
+   #endif
+}
+
+bool RtCheck::selfTest()
+{
+    quiet.store(true);
+    int missed = 0;
+
+    auto expect = [&missed](const char* name, auto&& call)
+        {
+            const int before = violations.load();
+            {
+                Scope scope;
+                call();
+            }
+
+            if (violations.load() == before)
+            {
+                std::fprintf(stderr, "RtCheck: self-test - %s isn't being caught\n", name);
+                ++missed;
+            }
+        };
+
+    expect("operator new", [] { sink = ::operator new(16); });
+    expect("operator delete", [] { ::operator delete(sink); });
+    expect("aligned operator new", [] { sink = ::operator new(16, std::align_val_t(64)); });
+    expect("aligned operator delete", [] { ::operator delete(sink, std::align_val_t(64)); });
+
+   #if RTCHECK_INTERPOSE
+    expect("malloc", [] { sink = std::malloc(16); });
+    expect("free", [] { std::free(sink); });
+    expect("calloc", [] { sink = std::calloc(4, 4); });
+    expect("realloc", [] { sink = std::realloc(sink, 64); });
+    std::free(sink);
+
+    expect("pthread_mutex_lock", []
+        {
+            pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+            pthread_mutex_lock(&mutex);
+            pthread_mutex_unlock(&mutex);
+        });
+
+    expect("nanosleep", []
+        {
+            const struct timespec zero{ 0, 0 };
+            nanosleep(&zero, nullptr);
+        });
+
+    expect("write", [] { ::write(2, "", 0); });
+    expect("sched_yield", [] { sched_yield(); });
+   #endif
+
+    violations.store(0);
+    quiet.store(false);
+    return missed == 0;
+}
+
+//==============================================================================
+// Replacements for the global allocation functions
+void* operator new(std::size_t size)
+{
+    violation("operator new");
+    if (auto* ptr = rawAlloc(size != 0 ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    violation("operator new[]");
+    if (auto* ptr = rawAlloc(size != 0 ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    violation("operator new");
+    return rawAlloc(size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    violation("operator new[]");
+    return rawAlloc(size != 0 ? size : 1);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    violation("operator new (aligned)");
+    if (auto* ptr = rawAlignedAlloc(size != 0 ? size : 1, (size_t)alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    violation("operator new[] (aligned)");
+    if (auto* ptr = rawAlignedAlloc(size != 0 ? size : 1, (size_t)alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    violation("operator new (aligned)");
+    return rawAlignedAlloc(size != 0 ? size : 1, (size_t)alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    violation("operator new[] (aligned)");
+    return rawAlignedAlloc(size != 0 ? size : 1, (size_t)alignment);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        violation("operator delete");
+    rawFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        violation("operator delete[]");
+    rawFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { operator delete[](ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { operator delete[](ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    if (ptr != nullptr)
+        violation("operator delete (aligned)");
+    rawAlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    if (ptr != nullptr)
+        violation("operator delete[] (aligned)");
+    rawAlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept { operator delete(ptr, alignment); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept { operator delete[](ptr, alignment); }
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept { operator delete(ptr, alignment); }
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept { operator delete[](ptr, alignment); }
+
+//==============================================================================
+// Linux: the C allocator, locks and blocking calls, forwarded to glibc
+#if RTCHECK_INTERPOSE
+extern "C"
+{
+    void* malloc(size_t size) __THROW
+    {
+        violation("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) __THROW
+    {
+        violation("calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size) __THROW
+    {
+        violation("realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr) __THROW
+    {
+        if (ptr != nullptr)
+            violation("free");
+        __libc_free(ptr);
+    }
+
+    void* memalign(size_t alignment, size_t size) __THROW
+    {
+        violation("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) __THROW
+    {
+        violation("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** ptr, size_t alignment, size_t size) __THROW
+    {
+        violation("posix_memalign");
+
+        if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        *ptr = __libc_memalign(alignment, size);
+        return *ptr != nullptr ? 0 : ENOMEM;
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) __THROWNL
+    {
+        violation("pthread_mutex_lock");
+        return RTCHECK_REAL(mutexLock, "pthread_mutex_lock")(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock) __THROWNL
+    {
+        violation("pthread_rwlock_rdlock");
+        return RTCHECK_REAL(rwlockRdlock, "pthread_rwlock_rdlock")(lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock) __THROWNL
+    {
+        violation("pthread_rwlock_wrlock");
+        return RTCHECK_REAL(rwlockWrlock, "pthread_rwlock_wrlock")(lock);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+    {
+        violation("pthread_cond_wait");
+        return resolve(real.condWait, "pthread_cond_wait", "GLIBC_2.3.2")(cond, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        violation("pthread_cond_timedwait");
+        return resolve(real.condTimedwait, "pthread_cond_timedwait", "GLIBC_2.3.2")(cond, mutex, time);
+    }
+
+    int sem_wait(sem_t* sem)
+    {
+        violation("sem_wait");
+        return RTCHECK_REAL(semWait, "sem_wait")(sem);
+    }
+
+    int sem_timedwait(sem_t* sem, const struct timespec* time)
+    {
+        violation("sem_timedwait");
+        return RTCHECK_REAL(semTimedwait, "sem_timedwait")(sem, time);
+    }
+
+    int nanosleep(const struct timespec* duration, struct timespec* remaining)
+    {
+        violation("nanosleep");
+        return RTCHECK_REAL(nanosleep, "nanosleep")(duration, remaining);
+    }
+
+    int clock_nanosleep(clockid_t clock, int flags, const struct timespec* duration, struct timespec* remaining)
+    {
+        violation("clock_nanosleep");
+        return RTCHECK_REAL(clockNanosleep, "clock_nanosleep")(clock, flags, duration, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        violation("usleep");
+        return RTCHECK_REAL(usleep, "usleep")(microseconds);
+    }
+
+    ssize_t read(int fd, void* bytes, size_t size)
+    {
+        violation("read");
+        return RTCHECK_REAL(read, "read")(fd, bytes, size);
+    }
+
+    ssize_t write(int fd, const void* bytes, size_t size)
+    {
+        violation("write");
+        return RTCHECK_REAL(write, "write")(fd, bytes, size);
+    }
+
+    int sched_yield() __THROW
+    {
+        violation("sched_yield");
+        return RTCHECK_REAL(schedYield, "sched_yield")();
+    }
+}
+#endif
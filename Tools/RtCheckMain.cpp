@@ -0,0 +1,196 @@
+#include "../Source/PluginProcessor.h"
+#include "RtCheck.h"
+#include <iostream>
+
+// JuceEQRtCheck - fails if the audio thread allocates, locks or blocks
+//
+//  JuceEQRtCheck [--seed=N] [--rounds=N] [--blocks=N]
+//
+// Runs processBlock inside an RtCheck::Scope (see RtCheck.h) over randomised rounds. Each round re-prepares the
+// processor at a new sample rate, channel layout, topology mode, worker pool setting and CPU governor policy (off,
+// or stepping down through every tier the settings make effective), sometimes straight after a state load, then runs blocks of random length (including oversize ones, which the processor splits) over noise
+// and stretches of silence. Between blocks - outside the scope, as a host's message thread would - it automates
+// random parameters, toggles the limiter and bypass, loads saved states and switches to processBlockBypassed.
+// Every violation prints what was called and a stack trace. Exits with 1 if there were any, or if the self-test
+// shows the hooks aren't catching anything.
+
+namespace
+{
+    constexpr int numStates = 8;
+
+    void setParam(juce::AudioProcessorValueTreeState& apvts, const juce::String& id, float value)
+    {
+        if (auto* p = apvts.getParameter(id))
+            p->setValueNotifyingHost(p->convertTo0to1(value));
+    }
+
+    void randomiseAll(juce::AudioProcessor& proc, juce::Random& rng)
+    {
+        for (auto* p : proc.getParameters())
+            p->setValueNotifyingHost(rng.nextFloat());
+    }
+
+    // Saved states from processors with random settings (bypass off, so the chain actually runs)
+    std::vector<juce::MemoryBlock> makeStates(juce::Random& rng)
+    {
+        std::vector<juce::MemoryBlock> states((size_t)numStates);
+        for (auto& state : states)
+        {
+            JuceEQAudioProcessor source;
+            randomiseAll(source, rng);
+            setParam(source.apvts, "bypass", 0.0f);
+            source.getStateInformation(state);
+        }
+        return states;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit; // APVTS needs a message manager
+    juce::ArgumentList args(argc, argv);
+
+    auto option = [&args](const juce::String& name, int fallback)
+        {
+            return args.containsOption(name) ? args.getValueForOption(name).getIntValue() : fallback;
+        };
+
+    const int seed = option("--seed", 1);
+    const int numRounds = juce::jmax(1, option("--rounds", 40));
+    const int blocksPerRound = juce::jmax(1, option("--blocks", 500));
+    juce::Random rng(seed);
+
+    std::cout << "JuceEQRtCheck: seed " << seed << ", " << numRounds << " rounds of " << blocksPerRound << " blocks\n"
+              << "  watching " << RtCheck::getCoverage() << "\n";
+
+    if (!RtCheck::selfTest())
+    {
+        std::cout << "  FAIL  the hooks aren't working on this build\n";
+        return 1;
+    }
+
+    const double sampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    // 16 and up go through the worker pool when it's on; past 32 channels juce::AudioBuffer allocates its channel
+    // list, so a view of the host's buffer made on the audio thread shows up here
+    const int channelCounts[] = { 1, 2, 6, 16, 48, 64 };
+    constexpr int maxBlockSize = 2048;
+
+    const auto states = makeStates(rng);
+
+    JuceEQAudioProcessor proc;
+    juce::AudioBuffer<float> buffer(64, maxBlockSize * 3);
+    juce::MidiBuffer midi;
+    juce::int64 totalBlocks = 0;
+
+    for (int round = 0; round < numRounds; ++round)
+    {
+        // Everything a host does around prepareToPlay happens outside the scope
+        const double sampleRate = sampleRates[rng.nextInt((int)std::size(sampleRates))];
+        const int numChannels = channelCounts[rng.nextInt((int)std::size(channelCounts))];
+        const int blockSize = 32 << rng.nextInt(7); // 32 .. 2048
+        const auto topology = (FilterSection::TopologyMode)rng.nextInt(3);
+
+        JuceEQAudioProcessor::WorkerPoolOptions poolOptions;
+        poolOptions.enabled = rng.nextBool();
+
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(channelSet);
+        layout.outputBuses.add(channelSet);
+
+        // The governor off, or stepping all the way down within a few blocks (and so changing tiers mid-round, as the
+        // limiter toggles and automation make tiers effective or not)
+        CpuGovernor::Policy governorPolicy;
+        governorPolicy.enabled = rng.nextBool();
+        governorPolicy.stepDownLoad = governorPolicy.stepUpLoad = 0.0;
+        governorPolicy.stepDownSeconds = 0.01;
+        CpuGovernor::setSessionPolicy(governorPolicy);
+
+        proc.releaseResources();
+        proc.setBusesLayout(layout);
+        proc.setWorkerPoolOptions(poolOptions);
+        proc.setFilterTopologyMode(topology);
+
+        if (rng.nextBool())
+        {
+            const auto& state = states[(size_t)rng.nextInt(numStates)];
+            proc.setStateInformation(state.getData(), (int)state.getSize());
+        }
+
+        proc.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        proc.prepareToPlay(sampleRate, blockSize);
+
+        const int violationsBefore = RtCheck::getViolationCount();
+        int silentBlocks = 0;
+        bool useBypassedCall = false;
+
+        for (int b = 0; b < blocksPerRound; ++b, ++totalBlocks)
+        {
+            // Host-side changes between blocks
+            const int event = rng.nextInt(32);
+            if (event < 8)
+            {
+                auto& params = proc.getParameters();
+                params[rng.nextInt(params.size())]->setValueNotifyingHost(rng.nextFloat());
+            }
+            else if (event == 8)
+            {
+                setParam(proc.apvts, "limiterEnabled", rng.nextBool() ? 1.0f : 0.0f);
+            }
+            else if (event == 9)
+            {
+                setParam(proc.apvts, "bypass", rng.nextInt(4) == 0 ? 1.0f : 0.0f);
+            }
+            else if (event == 10)
+            {
+                const auto& state = states[(size_t)rng.nextInt(numStates)];
+                proc.setStateInformation(state.getData(), (int)state.getSize());
+            }
+            else if (event == 11)
+            {
+                useBypassedCall = rng.nextInt(4) == 0; // Hosts that bypass from outside the plugin
+            }
+            else if (event == 12 && silentBlocks == 0)
+            {
+                silentBlocks = 20 + rng.nextInt(200); // Long enough for the tail to run out and the chain to sleep
+            }
+
+            // Mostly up to the prepared size, sometimes up to 3x over it
+            const int numSamples = rng.nextInt(8) == 0 ? blockSize + 1 + rng.nextInt(blockSize * 2)
+                                                       : 1 + rng.nextInt(blockSize);
+            buffer.setSize(numChannels, numSamples, false, false, true);
+
+            if (silentBlocks > 0)
+            {
+                buffer.clear();
+                --silentBlocks;
+            }
+            else
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                {
+                    auto* data = buffer.getWritePointer(ch);
+                    for (int i = 0; i < numSamples; ++i)
+                        data[i] = 0.5f * (rng.nextFloat() * 2.0f - 1.0f);
+                }
+            }
+
+            RtCheck::Scope audioThread;
+            if (useBypassedCall)
+                proc.processBlockBypassed(buffer, midi);
+            else
+                proc.processBlock(buffer, midi);
+        }
+
+        const int found = RtCheck::getViolationCount() - violationsBefore;
+        if (found > 0)
+            std::cout << "  round " << round << ": " << found << " violations at " << sampleRate << " Hz, "
+                      << numChannels << " ch, " << blockSize << "-sample blocks, topology " << (int)topology
+                      << (poolOptions.enabled ? ", worker pool" : "") << "\n";
+    }
+
+    const int violations = RtCheck::getViolationCount();
+    std::cout << "  " << (violations == 0 ? "PASS" : "FAIL") << "  " << totalBlocks << " blocks, "
+              << violations << " audio-thread violations\n";
+    return violations == 0 ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#include "../Source/PluginProcessor.h"
+#include <cstdio>
+#include <iostream>
+
+#if JUCE_LINUX || JUCE_BSD
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+ #include <psapi.h>
+#endif
+
+// JuceEQStress - instance density: memory and throughput of many processors in one process
+//
+//  JuceEQStress [--instances=N] [--rate=Hz] [--block=N] [--channels=N] [--seconds=S] [--seed=N] [--pool]
+//               [--isa=generic|avx2|avx512]
+//
+// Creates N processors, gives each a random curve (a third with the limiter on), prepares them and runs them
+// round-robin on noise, the way a host with N inserts would. Channel worker pools stay off unless --pool is
+// given - a host running hundreds of instances already spreads them over its cores. Reports resident memory per instance after each
+// stage, the size of each instance's DSP arena, and aggregate throughput as real-time instances per core.
+
+namespace
+{
+    // Resident set size of this process, or 0 where it can't be read
+    size_t residentBytes()
+    {
+       #if JUCE_LINUX || JUCE_BSD
+        long pages = 0, resident = 0;
+        if (auto* f = std::fopen("/proc/self/statm", "r"))
+        {
+            if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2)
+                resident = 0;
+            std::fclose(f);
+        }
+        return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+       #elif JUCE_MAC
+        mach_task_basic_info info{};
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+            return 0;
+        return (size_t)info.resident_size;
+       #elif JUCE_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0;
+        return (size_t)counters.WorkingSetSize;
+       #else
+        return 0;
+       #endif
+    }
+
+    juce::String kib(double bytes)
+    {
+        return juce::String(bytes / 1024.0, 1) + " KiB";
+    }
+
+    void setParam(juce::AudioProcessorValueTreeState& apvts, const juce::String& id, float value)
+    {
+        if (auto* p = apvts.getParameter(id))
+            p->setValueNotifyingHost(p->convertTo0to1(value));
+    }
+
+    // A plausible mixing curve - a few bands, cuts at both ends
+    void randomise(juce::AudioProcessorValueTreeState& apvts, juce::Random& rng, bool limiter)
+    {
+        setParam(apvts, "hpfEnabled", 1.0f);
+        setParam(apvts, "hpfFreq", 20.0f + 100.0f * rng.nextFloat());
+        setParam(apvts, "hpfSlope", (float)rng.nextInt(4));
+        setParam(apvts, "lpfEnabled", rng.nextBool() ? 1.0f : 0.0f);
+        setParam(apvts, "lpfFreq", 8000.0f + 10000.0f * rng.nextFloat());
+        setParam(apvts, "lpfSlope", (float)rng.nextInt(4));
+
+        for (int i = 1; i <= EqConstants::maxEqBands; ++i)
+        {
+            setParam(apvts, eqBandParamType(i, "enabled"), i <= 5 ? 1.0f : 0.0f);
+            setParam(apvts, eqBandParamType(i, "freq"), 60.0f * std::pow(200.0f, rng.nextFloat()));
+            setParam(apvts, eqBandParamType(i, "gain"), -12.0f + 24.0f * rng.nextFloat());
+            setParam(apvts, eqBandParamType(i, "q"), 0.5f + 4.0f * rng.nextFloat());
+        }
+
+        setParam(apvts, "limiterEnabled", limiter ? 1.0f : 0.0f);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit; // APVTS needs a message manager
+    juce::ArgumentList args(argc, argv);
+
+    auto option = [&args](const juce::String& name, double fallback)
+        {
+            return args.containsOption(name) ? args.getValueForOption(name).getDoubleValue() : fallback;
+        };
+
+    const int numInstances = juce::jmax(1, (int)option("--instances", 400));
+    const double sampleRate = option("--rate", 48000.0);
+    const int blockSize = juce::jmax(1, (int)option("--block", 256));
+    const int numChannels = juce::jlimit(1, 64, (int)option("--channels", 2));
+    const double seconds = option("--seconds", 5.0);
+    const bool usePool = args.containsOption("--pool");
+    juce::Random rng((juce::int64)option("--seed", 1));
+
+    if (args.containsOption("--isa") && !DspKernels::select(args.getValueForOption("--isa").toRawUTF8()))
+    {
+        std::cout << "--isa=" << args.getValueForOption("--isa") << " isn't available on this machine\n";
+        return 1;
+    }
+
+    std::cout << "JuceEQStress: " << numInstances << " instances, " << numChannels << " ch, "
+              << sampleRate << " Hz, " << blockSize << "-sample blocks, " << DspKernels::get().name << " kernels\n";
+
+    const auto rssStart = (double)residentBytes();
+    auto perInstance = [&](size_t rss) { return kib(((double)rss - rssStart) / (double)numInstances); };
+
+    // Create
+    std::vector<std::unique_ptr<JuceEQAudioProcessor>> instances;
+    instances.reserve((size_t)numInstances);
+
+    auto t0 = juce::Time::getMillisecondCounterHiRes();
+    for (int i = 0; i < numInstances; ++i)
+        instances.push_back(std::make_unique<JuceEQAudioProcessor>());
+    const auto createMs = juce::Time::getMillisecondCounterHiRes() - t0;
+    std::cout << "  created    " << perInstance(residentBytes()) << " / instance  (" << juce::String(createMs, 1) << " ms)\n";
+
+    // Prepare
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(channelSet);
+    layout.outputBuses.add(channelSet);
+
+    t0 = juce::Time::getMillisecondCounterHiRes();
+    size_t arenaBytes = 0;
+    for (int i = 0; i < numInstances; ++i)
+    {
+        auto& proc = *instances[(size_t)i];
+        proc.setBusesLayout(layout);
+
+        JuceEQAudioProcessor::WorkerPoolOptions poolOptions;
+        poolOptions.enabled = usePool;
+        proc.setWorkerPoolOptions(poolOptions);
+
+        proc.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        randomise(proc.apvts, rng, i % 3 == 0);
+        proc.prepareToPlay(sampleRate, blockSize);
+        arenaBytes += proc.getDspStateBytes();
+    }
+    const auto prepareMs = juce::Time::getMillisecondCounterHiRes() - t0;
+    std::cout << "  prepared   " << perInstance(residentBytes()) << " / instance  (" << juce::String(prepareMs, 1)
+              << " ms, DSP arena " << kib((double)arenaBytes / (double)numInstances) << ")\n";
+
+    // Process - every instance gets the same noise, one block at a time across all of them
+    const int numBlocks = juce::jmax(1, (int)(seconds * sampleRate / blockSize));
+    juce::AudioBuffer<float> noise(numChannels, blockSize * 16), buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < noise.getNumSamples(); ++i)
+            noise.setSample(ch, i, 0.5f * (rng.nextFloat() * 2.0f - 1.0f));
+
+    t0 = juce::Time::getMillisecondCounterHiRes();
+    for (int b = 0; b < numBlocks; ++b)
+    {
+        const int offset = (b % 16) * blockSize;
+        for (auto& proc : instances)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.copyFrom(ch, 0, noise, ch, offset, blockSize);
+            proc->processBlock(buffer, midi);
+        }
+    }
+    const auto processSeconds = (juce::Time::getMillisecondCounterHiRes() - t0) * 0.001;
+    std::cout << "  processed  " << perInstance(residentBytes()) << " / instance\n";
+
+    const double audioSeconds = (double)numBlocks * blockSize / sampleRate;
+    const double realtimeInstances = (double)numInstances * audioSeconds / processSeconds;
+    const double nsPerSample = processSeconds * 1.0e9 / ((double)numInstances * numBlocks * blockSize * numChannels);
+
+    std::cout << "  throughput " << juce::String(realtimeInstances, 1) << " real-time instances per core, "
+              << juce::String(nsPerSample, 2) << " ns per sample per channel\n";
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include "../Source/Telemetry.h"
+#include "../Source/CpuGovernor.h"
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+// JuceEQTelemetry - lists the JuceEQ instances publishing to a JUCEEQ_TELEMETRY segment
+//
+//  JuceEQTelemetry [--segment=name] [--watch[=seconds]] [--json] [--all]
+//
+// Maps the segment read-only (see Telemetry.h) and prints one line per live instance: process and instance,
+// host and track, prepared rate/channels/block size, the smallest and largest block seen, CPU load and the time
+// spent in the filters, multirate split and limiter on the last block, quality tier, state, parameter version,
+// input/output peaks, limiter gain reduction and how long ago the last block finished. An instance whose process
+// has gone without freeing its slot (a crash) is left out unless --all is given. Nothing is written to the
+// segment, so it's safe to run against a live session as often as you like.
+// --watch redraws every N seconds (1 by default) until interrupted; --json prints the same fields as JSON instead.
+// Exits with 1 if the segment doesn't exist yet (no instance has published to it) or has another layout.
+
+namespace
+{
+    struct Instance
+    {
+        juce::int32 owner;
+        bool alive;
+        Telemetry::Identity identity;
+        Telemetry::Block block;
+    };
+
+    std::vector<Instance> readInstances(const Telemetry::Segment& segment, bool includeStale)
+    {
+        std::vector<Instance> instances;
+
+        for (const auto& slot : segment.slots)
+        {
+            Instance instance{};
+            instance.owner = slot.owner.load(std::memory_order_acquire);
+            if (instance.owner == 0)
+                continue;
+
+            instance.alive = Telemetry::isProcessAlive(instance.owner);
+            if (!instance.alive && !includeStale)
+                continue;
+
+            // A slot being written on every pass for 64 tries (or claimed mid-read) is skipped until the next listing
+            if (Telemetry::read(slot.identitySequence, slot.identity, instance.identity)
+                && Telemetry::read(slot.blockSequence, slot.block, instance.block))
+                instances.push_back(instance);
+        }
+
+        return instances;
+    }
+
+    juce::String toString(const char* text, size_t size)
+    {
+        return juce::String::fromUTF8(text, (int)strnlen(text, size));
+    }
+
+    double toDb(float linear)
+    {
+        return linear > 0.0f ? 20.0 * std::log10((double)linear) : -std::numeric_limits<double>::infinity();
+    }
+
+    juce::String formatDb(float linear)
+    {
+        const auto db = toDb(linear);
+        return std::isinf(db) ? juce::String("-inf") : juce::String(db, 1);
+    }
+
+    double ageSeconds(const Telemetry::Block& block, juce::int64 ticksPerSecond)
+    {
+        if (block.ticks == 0)
+            return -1.0; // Not run since it was created
+
+        return (double)(juce::Time::getHighResolutionTicks() - block.ticks) / (double)ticksPerSecond;
+    }
+
+    juce::String describeState(const Instance& instance, double age)
+    {
+        const auto state = instance.block.state;
+        juce::StringArray words;
+
+        if (!instance.alive) words.add("dead");
+        else if (age < 0.0) words.add("unprepared");
+        else if (age > 2.0) words.add("idle");
+
+        if ((state & Telemetry::bypassedFlag) != 0) words.add("bypassed");
+        else if ((state & Telemetry::sleepingFlag) != 0) words.add("sleeping");
+        else if ((state & Telemetry::filtersEngagedFlag) == 0) words.add("flat");
+
+        if ((state & Telemetry::graphicFlag) != 0) words.add("graphic");
+        if ((state & Telemetry::limiterFlag) != 0) words.add("limiter");
+        if ((state & Telemetry::multirateFlag) != 0) words.add("multirate");
+        if ((state & Telemetry::fixedPointFlag) != 0) words.add("fixed");
+        if ((state & Telemetry::blockFiltersFlag) != 0) words.add("block");
+
+        return words.joinIntoString(",");
+    }
+
+    juce::var toVar(const Instance& instance, juce::int64 ticksPerSecond)
+    {
+        const auto& id = instance.identity;
+        const auto& b = instance.block;
+        const auto age = ageSeconds(b, ticksPerSecond);
+
+        juce::DynamicObject::Ptr result = new juce::DynamicObject();
+        result->setProperty("pid", id.pid);
+        result->setProperty("instance", (int)id.instance);
+        result->setProperty("alive", instance.alive);
+        result->setProperty("host", toString(id.host, sizeof(id.host)));
+        result->setProperty("track", toString(id.track, sizeof(id.track)));
+        result->setProperty("kernel", toString(id.kernel, sizeof(id.kernel)));
+        result->setProperty("sampleRate", id.sampleRate);
+        result->setProperty("numChannels", id.numChannels);
+        result->setProperty("preparedBlockSize", id.preparedBlockSize);
+        result->setProperty("blocks", (juce::int64)b.blocks);
+        result->setProperty("samples", (juce::int64)b.samples);
+        result->setProperty("blockSize", b.blockSize);
+        result->setProperty("minBlockSize", b.minBlockSize);
+        result->setProperty("maxBlockSize", b.maxBlockSize);
+        result->setProperty("latencySamples", b.latencySamples);
+        result->setProperty("load", (double)b.load);
+        result->setProperty("blockMicroseconds", (double)b.blockMicroseconds);
+        result->setProperty("filtersMicroseconds", (double)b.stageMicroseconds[Telemetry::filtersStage]);
+        result->setProperty("multirateMicroseconds", (double)b.stageMicroseconds[Telemetry::multirateStage]);
+        result->setProperty("limiterMicroseconds", (double)b.stageMicroseconds[Telemetry::limiterStage]);
+        result->setProperty("tier", CpuGovernor::getTierName(b.tier));
+        result->setProperty("state", describeState(instance, age));
+        result->setProperty("parameterVersion", (juce::int64)b.parameterVersion);
+        result->setProperty("gainReductionDb", (double)b.gainReductionDb);
+        result->setProperty("ageSeconds", age);
+
+        juce::Array<juce::var> inputPeakDb, outputPeakDb;
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            // JSON has no infinity - silence is null
+            inputPeakDb.add(b.inputPeak[ch] > 0.0f ? juce::var(toDb(b.inputPeak[ch])) : juce::var());
+            outputPeakDb.add(b.outputPeak[ch] > 0.0f ? juce::var(toDb(b.outputPeak[ch])) : juce::var());
+        }
+        result->setProperty("inputPeakDb", inputPeakDb);
+        result->setProperty("outputPeakDb", outputPeakDb);
+
+        return juce::var(result.get());
+    }
+
+    void printTable(const std::vector<Instance>& instances, juce::int64 ticksPerSecond)
+    {
+        std::cout << juce::String::formatted("%-13s %-28s %8s %3s %-14s %6s %8s %8s %8s %8s %-16s %6s %-13s %-13s %6s %6s  %s\n",
+                                             "PID/INST", "HOST / TRACK", "RATE", "CH", "BLOCK", "LOAD", "BLOCKus",
+                                             "FILTus", "SPLITus", "LIMus", "TIER", "VER", "IN dB", "OUT dB", "GR dB",
+                                             "AGE s", "STATE");
+
+        for (const auto& instance : instances)
+        {
+            const auto& id = instance.identity;
+            const auto& b = instance.block;
+            const auto age = ageSeconds(b, ticksPerSecond);
+
+            auto names = toString(id.host, sizeof(id.host));
+            const auto track = toString(id.track, sizeof(id.track));
+            if (track.isNotEmpty())
+                names << " / " << track;
+
+            std::cout << juce::String::formatted("%-13s %-28s %8.0f %3d %-14s %5.1f%% %8.1f %8.1f %8.1f %8.1f %-16s %6u %-13s %-13s %6.1f %6s  %s\n",
+                                                 (juce::String(id.pid) + "/" + juce::String(id.instance)).toRawUTF8(),
+                                                 names.substring(0, 28).toRawUTF8(),
+                                                 id.sampleRate, id.numChannels,
+                                                 (juce::String(b.blockSize) + " (" + juce::String(b.minBlockSize) + "-"
+                                                      + juce::String(b.maxBlockSize) + ")").toRawUTF8(),
+                                                 100.0 * b.load, b.blockMicroseconds,
+                                                 b.stageMicroseconds[Telemetry::filtersStage],
+                                                 b.stageMicroseconds[Telemetry::multirateStage],
+                                                 b.stageMicroseconds[Telemetry::limiterStage],
+                                                 CpuGovernor::getTierName(b.tier), (unsigned)b.parameterVersion,
+                                                 (formatDb(b.inputPeak[0]) + " " + formatDb(b.inputPeak[1])).toRawUTF8(),
+                                                 (formatDb(b.outputPeak[0]) + " " + formatDb(b.outputPeak[1])).toRawUTF8(),
+                                                 b.gainReductionDb,
+                                                 (age < 0.0 ? juce::String("-") : juce::String(age, 1)).toRawUTF8(),
+                                                 describeState(instance, age).toRawUTF8());
+        }
+
+        std::cout << instances.size() << " instance(s)\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    auto segmentName = args.containsOption("--segment") ? args.getValueForOption("--segment")
+                                                        : juce::String(Telemetry::defaultSegmentName);
+    if (!segmentName.startsWithChar('/'))
+        segmentName = "/" + segmentName;
+
+    const bool json = args.containsOption("--json");
+    const bool includeStale = args.containsOption("--all");
+    const bool watch = args.containsOption("--watch");
+    const double interval = juce::jmax(0.1, watch && args.getValueForOption("--watch").isNotEmpty()
+                                                ? args.getValueForOption("--watch").getDoubleValue() : 1.0);
+
+    const auto* segment = Telemetry::mapSegment(segmentName, false);
+    if (segment == nullptr)
+    {
+        std::cerr << "JuceEQTelemetry: no telemetry segment " << segmentName
+                  << " (no instance has published to it with JUCEEQ_TELEMETRY set, or it's from another version)\n";
+        return 1;
+    }
+
+    const auto ticksPerSecond = segment->header.ticksPerSecond;
+
+    for (;;)
+    {
+        const auto instances = readInstances(*segment, includeStale);
+
+        if (watch && !json)
+            std::cout << "\x1b[2J\x1b[H" << segmentName << " - " << juce::Time::getCurrentTime().toString(false, true) << "\n";
+
+        if (json)
+        {
+            juce::Array<juce::var> list;
+            for (const auto& instance : instances)
+                list.add(toVar(instance, ticksPerSecond));
+
+            std::cout << juce::JSON::toString(list, watch) << "\n"; // One line per listing when watching
+        }
+        else
+        {
+            printTable(instances, ticksPerSecond);
+        }
+
+        std::cout.flush();
+        if (!watch)
+            return 0;
+
+        juce::Thread::sleep(juce::roundToInt(interval * 1000.0));
+    }
+}
@@ -0,0 +1,8 @@
+#include "../Source/PluginProcessor.h"
+
+// Headless tools link the processor without the custom editor sources.
+// Fall back to JUCE's generic editor should anything ask for one.
+juce::AudioProcessorEditor* createEQEditor(JuceEQAudioProcessor& p)
+{
+    return new juce::GenericAudioProcessorEditor(p);
+}
@@ -0,0 +1,149 @@
+#include "../Source/FilterSection.h"
+#include <iostream>
+#include <vector>
+
+// JuceEQTopologyBench - accuracy against CPU cost for the float section topologies
+//
+//  JuceEQTopologyBench [--seconds=N] [--isa=generic|avx2|avx512]
+//
+// Each design filters the same white noise in float (direct form, SVF, and the automatic topology run through the
+// block state-space kernel) and in double direct form, the reference. Accuracy is the float output's SNR against the
+// reference, which folds coefficient rounding and state noise together. Cost is ns per sample, single channel, 512-sample blocks, with the DSP kernel
+// variant the CPU picks (or the one --isa forces).
+
+namespace
+{
+    constexpr int blockSize = 512;
+
+    struct Case
+    {
+        const char* label;
+        FilterSection::Design design;
+    };
+
+    // What running the whole chain in double would cost
+    void processDouble(const double (&c)[5], double (&z)[2], const float* in, double* out, int numSamples)
+    {
+        double z1 = z[0], z2 = z[1];
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double x = in[i];
+            const double y = c[0] * x + z1;
+            z1 = c[1] * x - c[3] * y + z2;
+            z2 = c[2] * x - c[4] * y;
+            out[i] = y;
+        }
+
+        z[0] = z1;
+        z[1] = z2;
+    }
+
+    double snrDb(const std::vector<float>& test, const std::vector<double>& ref)
+    {
+        double signal = 0.0, noise = 0.0;
+        for (size_t i = 0; i < ref.size(); ++i)
+        {
+            signal += ref[i] * ref[i];
+            const double e = (double)test[i] - ref[i];
+            noise += e * e;
+        }
+
+        if (noise <= 0.0) return 200.0;
+        return 10.0 * std::log10(signal / noise);
+    }
+
+    template <typename Fn>
+    double nsPerSample(int numSamples, Fn&& processBlock)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int pos = 0; pos + blockSize <= numSamples; pos += blockSize)
+            processBlock(pos);
+        const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / (double)numSamples;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    const double seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 4.0;
+
+    if (args.containsOption("--isa") && !DspKernels::select(args.getValueForOption("--isa").toRawUTF8()))
+    {
+        std::cout << "--isa=" << args.getValueForOption("--isa") << " isn't available on this machine\n";
+        return 1;
+    }
+
+    using Shape = FilterSection::Shape;
+    std::vector<Case> cases;
+
+    for (double rate : { 48000.0, 96000.0, 192000.0 })
+    {
+        cases.push_back({ "peak  +12 dB Q 0.7", { Shape::peak, rate, 10.0, 0.7, 12.0 } });
+        cases.push_back({ "peak  +12 dB Q 0.7", { Shape::peak, rate, 100.0, 0.7, 12.0 } });
+        cases.push_back({ "peak  -18 dB Q 40 ", { Shape::peak, rate, 10.0, 40.0, -18.0 } });
+        cases.push_back({ "peak  -18 dB Q 40 ", { Shape::peak, rate, 100.0, 40.0, -18.0 } });
+        cases.push_back({ "peak  -18 dB Q 40 ", { Shape::peak, rate, 1000.0, 40.0, -18.0 } });
+        cases.push_back({ "peak  +6 dB Q 2   ", { Shape::peak, rate, 5000.0, 2.0, 6.0 } });
+        cases.push_back({ "HPF 12 dB/oct     ", { Shape::highPass, rate, 10.0, 0.70710678, 0.0 } });
+        cases.push_back({ "HPF 12 dB/oct     ", { Shape::highPass, rate, 80.0, 0.70710678, 0.0 } });
+        cases.push_back({ "HPF 6 dB/oct      ", { Shape::firstOrderHighPass, rate, 10.0, 0.70710678, 0.0 } });
+        cases.push_back({ "LPF 12 dB/oct     ", { Shape::lowPass, rate, 20000.0, 0.70710678, 0.0 } });
+    }
+
+    juce::Random random(1234);
+    std::cout << "kernels: " << DspKernels::get().name << "\n";
+    std::cout << "design               rate    freq Hz |  SNR dB: DF    SVF   auto  block |  ns/sample: DF   SVF block   double\n";
+
+    for (const auto& c : cases)
+    {
+        const int numSamples = juce::jmax(blockSize, (int)(seconds * c.design.sampleRate) / blockSize * blockSize);
+
+        std::vector<float> input((size_t)numSamples);
+        for (auto& x : input)
+            x = random.nextFloat() - 0.5f;
+
+        std::vector<double> reference((size_t)numSamples);
+        double dc[5];
+        FilterSection::makeDoubleCoefficients(c.design, dc);
+        double state[2] = { 0.0, 0.0 };
+        processDouble(dc, state, input.data(), reference.data(), numSamples);
+
+        auto runFloat = [&](FilterSection::Topology topology, double& ns, bool block = false)
+            {
+                const auto coeffs = FilterSection::makeCoefficients(c.design, topology, block);
+                FilterSection section;
+                std::vector<float> out(input);
+                ns = nsPerSample(numSamples, [&](int pos) { section.process(coeffs, out.data() + pos, blockSize); });
+                return snrDb(out, reference);
+            };
+
+        double nsDf = 0.0, nsSvf = 0.0;
+        const double snrDf = runFloat(FilterSection::Topology::directForm, nsDf);
+        const double snrSvf = runFloat(FilterSection::Topology::svf, nsSvf);
+
+        const auto chosen = FilterSection::chooseTopology(c.design, FilterSection::TopologyMode::automatic,
+            FilterSection::Topology::directForm);
+        const double snrAuto = chosen == FilterSection::Topology::svf ? snrSvf : snrDf;
+
+        double nsBlock = 0.0;
+        const double snrBlock = runFloat(chosen, nsBlock, true);
+
+        std::vector<double> scratch((size_t)blockSize);
+        double timingState[2] = { 0.0, 0.0 };
+        const double nsDouble = nsPerSample(numSamples, [&](int pos)
+            {
+                processDouble(dc, timingState, input.data() + pos, scratch.data(), blockSize);
+            });
+
+        std::cout << c.label << "  " << juce::String(c.design.sampleRate / 1000.0, 0).paddedLeft(' ', 3) << "k  "
+                  << juce::String(c.design.freqHz, 0).paddedLeft(' ', 7) << " | "
+                  << juce::String(snrDf, 1).paddedLeft(' ', 14) << juce::String(snrSvf, 1).paddedLeft(' ', 7)
+                  << juce::String(snrAuto, 1).paddedLeft(' ', 7) << juce::String(snrBlock, 1).paddedLeft(' ', 7) << " | "
+                  << juce::String(nsDf, 2).paddedLeft(' ', 14) << juce::String(nsSvf, 2).paddedLeft(' ', 6)
+                  << juce::String(nsBlock, 2).paddedLeft(' ', 6)
+                  << juce::String(nsDouble, 2).paddedLeft(' ', 8) << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,342 @@
+#include "../Source/PluginProcessor.h"
+#include "../Source/PluginEditor.h"
+#include "../Source/EqGraphComponent.h"
+#include "../Source/BandControlsComponent.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// JuceEQUiBench - offscreen rendering benchmark for the editor
+//
+//  JuceEQUiBench [--frames=N] [--seed=N] [--out=results.json]
+//
+// Builds JuceEQAudioProcessorEditor, EqGraphComponent and BandControlsComponent against a prepared processor without
+// putting anything on screen, so it runs on machines without a display. Each one is painted into an offscreen
+// juce::Image at three sizes and scale factors 1, 1.5 and 2, N frames each (60 by default), with the bands, filters,
+// limiter and EQ mode randomised before every frame. The first frame of each case warms the font and glyph caches
+// and isn't counted.
+// Writes JSON (to stdout, or --out): construction time of each component, per-frame paint time for every case and
+// the graph's rebuildResponse time - mean, median, 95th percentile and max in ms - and allocations per call.
+// Allocations are counted at malloc/calloc/realloc on Linux (glibc), which operator new goes through, and at operator
+// new elsewhere. Compare runs from the same machine; the absolute numbers depend on it.
+
+//==============================================================================
+// Allocation counting - only while a measurement is running on this thread
+namespace
+{
+    thread_local bool counting = false;
+    std::atomic<juce::int64> allocations{ 0 };
+
+    void noteAllocation()
+    {
+        if (counting)
+            allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#if defined(__linux__) && defined(__GLIBC__)
+// operator new goes through malloc here, so these catch both
+static constexpr const char* countedCalls = "malloc, calloc, realloc";
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+
+    void* malloc(size_t size)
+    {
+        noteAllocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        noteAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        noteAllocation();
+        return __libc_realloc(ptr, size);
+    }
+}
+#else
+static constexpr const char* countedCalls = "operator new";
+
+void* operator new(size_t size)
+{
+    noteAllocation();
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
+//==============================================================================
+namespace
+{
+    struct Samples
+    {
+        std::vector<double> ms;
+        juce::int64 allocations = 0;
+
+        juce::var toVar() const
+        {
+            juce::DynamicObject::Ptr result = new juce::DynamicObject();
+            if (ms.empty())
+                return juce::var(result.get());
+
+            auto sorted = ms;
+            std::sort(sorted.begin(), sorted.end());
+
+            double sum = 0.0;
+            for (double t : sorted)
+                sum += t;
+
+            const auto at = [&sorted](double fraction) { return sorted[(size_t)(fraction * (double)(sorted.size() - 1) + 0.5)]; };
+
+            result->setProperty("calls", (int)sorted.size());
+            result->setProperty("meanMs", sum / (double)sorted.size());
+            result->setProperty("medianMs", at(0.5));
+            result->setProperty("p95Ms", at(0.95));
+            result->setProperty("maxMs", sorted.back());
+            result->setProperty("allocationsPerCall", (double)allocations / (double)sorted.size());
+            return juce::var(result.get());
+        }
+    };
+
+    // Times one call and counts what it allocates
+    template <typename Function>
+    void measure(Samples& samples, Function&& function)
+    {
+        const auto allocationsBefore = allocations.load();
+        counting = true;
+        const double start = juce::Time::getMillisecondCounterHiRes();
+
+        function();
+
+        const double end = juce::Time::getMillisecondCounterHiRes();
+        counting = false;
+
+        samples.ms.push_back(end - start);
+        samples.allocations += allocations.load() - allocationsBefore;
+    }
+
+    void setParam(juce::AudioProcessorValueTreeState& apvts, const juce::String& id, float value)
+    {
+        if (auto* p = apvts.getParameter(id))
+            p->setValueNotifyingHost(p->convertTo0to1(value));
+    }
+
+    float logUniform(juce::Random& rng, float lo, float hi)
+    {
+        return lo * std::pow(hi / lo, rng.nextFloat());
+    }
+
+    // A new curve - mostly parametric with a few sharp bands (the graph adds points around each peak), sometimes
+    // the graphic EQ
+    void randomise(juce::AudioProcessorValueTreeState& apvts, juce::Random& rng)
+    {
+        setParam(apvts, "hpfEnabled", rng.nextBool() ? 1.0f : 0.0f);
+        setParam(apvts, "hpfFreq", logUniform(rng, 20.0f, 300.0f));
+        setParam(apvts, "hpfSlope", (float)rng.nextInt(4));
+        setParam(apvts, "lpfEnabled", rng.nextBool() ? 1.0f : 0.0f);
+        setParam(apvts, "lpfFreq", logUniform(rng, 4000.0f, 20000.0f));
+        setParam(apvts, "lpfSlope", (float)rng.nextInt(4));
+        setParam(apvts, "limiterEnabled", rng.nextBool() ? 1.0f : 0.0f);
+
+        for (int i = 1; i <= EqConstants::maxEqBands; ++i)
+        {
+            setParam(apvts, eqBandParamType(i, "enabled"), rng.nextInt(3) != 0 ? 1.0f : 0.0f);
+            setParam(apvts, eqBandParamType(i, "freq"), logUniform(rng, 30.0f, 16000.0f));
+            setParam(apvts, eqBandParamType(i, "q"), logUniform(rng, 0.3f, 20.0f));
+            setParam(apvts, eqBandParamType(i, "gain"), -18.0f + 36.0f * rng.nextFloat());
+        }
+
+        const bool graphic = rng.nextInt(4) == 0;
+        setParam(apvts, "eqMode", graphic ? 1.0f : 0.0f);
+
+        if (graphic)
+        {
+            const auto layout = rng.nextBool() ? GraphicEq::Layout::octave : GraphicEq::Layout::thirdOctave;
+            setParam(apvts, "geqLayout", layout == GraphicEq::Layout::octave ? 1.0f : 0.0f);
+
+            for (int b = 0; b < GraphicEq::getNumBands(layout); ++b)
+                setParam(apvts, GraphicEq::getParamId(layout, b), GraphicEq::maxGainDb * (rng.nextFloat() * 2.0f - 1.0f));
+        }
+    }
+
+    // The editor's own graph only rebuilds on a vblank, which never comes offscreen
+    void rebuildGraphs(juce::Component& component)
+    {
+        if (auto* graph = dynamic_cast<EqGraphComponent*>(&component))
+            graph->rebuildNow();
+
+        for (auto* child : component.getChildren())
+            rebuildGraphs(*child);
+    }
+
+    struct PaintCase
+    {
+        const char* component;
+        juce::Component* target;
+        int width, height;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    auto option = [&args](const juce::String& name, int fallback)
+        {
+            return args.containsOption(name) ? args.getValueForOption(name).getIntValue() : fallback;
+        };
+
+    const int frames = juce::jmax(1, option("--frames", 60));
+    const int seed = option("--seed", 1);
+    constexpr double sampleRate = 48000.0;
+    constexpr int constructions = 10;
+    const float scales[] = { 1.0f, 1.5f, 2.0f };
+    juce::Random rng(seed);
+
+    JuceEQAudioProcessor proc;
+    proc.setRateAndBufferSizeDetails(sampleRate, 512);
+    proc.prepareToPlay(sampleRate, 512);
+
+    // Construction - the first of each is counted too, as a user opening the editor sees it
+    Samples editorConstruction, graphConstruction, bandsConstruction;
+    for (int i = 0; i < constructions; ++i)
+    {
+        std::unique_ptr<juce::AudioProcessorEditor> editor;
+        measure(editorConstruction, [&] { editor.reset(proc.createEditor()); });
+        editor.reset();
+
+        std::unique_ptr<EqGraphComponent> graph;
+        measure(graphConstruction, [&] { graph = std::make_unique<EqGraphComponent>(proc); });
+        graph.reset();
+
+        std::unique_ptr<BandControlsComponent> bands;
+        measure(bandsConstruction, [&] { bands = std::make_unique<BandControlsComponent>(proc); });
+    }
+
+    std::unique_ptr<juce::AudioProcessorEditor> editor(proc.createEditor());
+    EqGraphComponent graph(proc);
+    BandControlsComponent bands(proc);
+    const int bandsHeight = BandControlsComponent::preferredHeight();
+
+    const PaintCase cases[] = {
+        { "editor", editor.get(), 1000, 640 },
+        { "editor", editor.get(), 1250, 760 },
+        { "editor", editor.get(), 1920, 1080 },
+        { "graph", &graph, 600, 300 },
+        { "graph", &graph, 1100, 460 },
+        { "graph", &graph, 1800, 780 },
+        { "bandControls", &bands, 1000, bandsHeight },
+        { "bandControls", &bands, 1250, bandsHeight },
+        { "bandControls", &bands, 1920, bandsHeight },
+    };
+
+    Samples rebuild;
+    juce::Array<juce::var> paintResults;
+
+    for (const auto& c : cases)
+    {
+        c.target->setSize(c.width, c.height);
+
+        for (float scale : scales)
+        {
+            juce::Image image(juce::Image::ARGB, juce::roundToInt((float)c.width * scale),
+                              juce::roundToInt((float)c.height * scale), true);
+            Samples paint;
+
+            for (int frame = 0; frame <= frames; ++frame)
+            {
+                randomise(proc.apvts, rng);
+
+                if (c.target == &graph)
+                {
+                    if (frame > 0)
+                        measure(rebuild, [&] { graph.rebuildNow(); });
+                    else
+                        graph.rebuildNow();
+                }
+                else
+                {
+                    rebuildGraphs(*c.target);
+                }
+
+                auto render = [&]
+                    {
+                        juce::Graphics g(image);
+                        g.addTransform(juce::AffineTransform::scale(scale));
+                        c.target->paintEntireComponent(g, true);
+                    };
+
+                if (frame > 0)
+                    measure(paint, render);
+                else
+                    render();
+            }
+
+            auto result = paint.toVar();
+            if (auto* object = result.getDynamicObject())
+            {
+                object->setProperty("component", c.component);
+                object->setProperty("width", c.width);
+                object->setProperty("height", c.height);
+                object->setProperty("scale", (double)scale);
+            }
+            paintResults.add(result);
+        }
+    }
+
+    juce::DynamicObject::Ptr construction = new juce::DynamicObject();
+    construction->setProperty("editor", editorConstruction.toVar());
+    construction->setProperty("graph", graphConstruction.toVar());
+    construction->setProperty("bandControls", bandsConstruction.toVar());
+
+    juce::DynamicObject::Ptr report = new juce::DynamicObject();
+    report->setProperty("tool", "JuceEQUiBench");
+    report->setProperty("seed", seed);
+    report->setProperty("framesPerCase", frames);
+    report->setProperty("allocationsCounted", countedCalls);
+    report->setProperty("construction", juce::var(construction.get()));
+    report->setProperty("rebuildResponse", rebuild.toVar());
+    report->setProperty("paint", paintResults);
+
+    const auto json = juce::JSON::toString(juce::var(report.get()));
+
+    if (args.containsOption("--out"))
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--out"));
+        if (!file.replaceWithText(json))
+        {
+            std::cerr << "JuceEQUiBench: couldn't write " << file.getFullPathName() << "\n";
+            return 1;
+        }
+
+        std::cout << "JuceEQUiBench: " << paintResults.size() << " cases of " << frames << " frames -> "
+                  << file.getFullPathName() << "\n";
+        return 0;
+    }
+
+    std::cout << json << "\n";
+    return 0;
+}